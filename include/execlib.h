@@ -41,6 +41,9 @@
  * Included Files
  ***************************************************************************/
 
+#include <stdbool.h>
+#include <stdio.h>
+
 #include "pas_machine.h"
 
 /***************************************************************************
@@ -51,14 +54,49 @@
 
 typedef void *EXEC_HANDLE_t;
 
+/* Opaque handle that represents a loaded program image.  One image may be
+ * shared by many instances of the run-time.
+ */
+
+typedef void *EXEC_IMAGE_t;
+
+/* The reason that libexec_Run() returned */
+
+enum runReason_e
+{
+  eRUN_BUDGET = 0,     /* The instruction budget was used up */
+  eRUN_EXIT,           /* The program terminated normally */
+  eRUN_ERROR,          /* Execution stopped on a run-time error */
+  eRUN_BLOCKED         /* A read found no input on a non-blocking file */
+};
+
+typedef enum runReason_e runReason_t;
+
 /***************************************************************************
  * Public Function Prototypes
  ***************************************************************************/
 
+EXEC_IMAGE_t  libexec_LoadImage(const char *filename);
+void          libexec_ReleaseImage(EXEC_IMAGE_t image);
+EXEC_HANDLE_t libexec_Instantiate(EXEC_IMAGE_t image, pasSize_t strSize,
+                                  pasSize_t stkSize, pasSize_t hpSize);
 EXEC_HANDLE_t libexec_Load(const char *filename, pasSize_t strSize,
                            pasSize_t stkSize, pasSize_t hpSize);
 void libexec_Release(EXEC_HANDLE_t handle);
+void libexec_SetStdio(EXEC_HANDLE_t handle, FILE *input, FILE *output);
+void libexec_SetFileMapping(EXEC_HANDLE_t handle, bool enable);
 void libexec_RunLoop(EXEC_HANDLE_t handle);
+int  libexec_Run(EXEC_HANDLE_t handle, uint32_t maxInstructions,
+                 runReason_t *reason);
+int  libexec_GetExitCode(EXEC_HANDLE_t handle);
+uint64_t libexec_GetInstructionCount(EXEC_HANDLE_t handle);
+int  libexec_GetVerifyResult(EXEC_HANDLE_t handle, pasSize_t *pc);
 void libexec_DebugLoop(EXEC_HANDLE_t handle);
+int  libexec_EnableProfile(EXEC_HANDLE_t handle);
+void libexec_ProfileReport(EXEC_HANDLE_t handle, FILE *report);
+int  libexec_EnableSampling(EXEC_HANDLE_t handle, uint32_t interval);
+void libexec_SampleReport(EXEC_HANDLE_t handle, FILE *report);
+int  libexec_EnableHeapProfile(EXEC_HANDLE_t handle);
+void libexec_HeapProfileReport(EXEC_HANDLE_t handle, FILE *report);
 
 #endif /* _EXECLIB_H */
@@ -204,6 +204,7 @@
  * eBADFILETYPE         .pex file is not a regular file
  * eSPAWANFAILED        posix_spawnp() failed
  * eWAITFAILED          waitpid() failed
+ * eWOULDBLOCK          No input is available on a non-blocking file
  *
  **********************************************************************/
 
@@ -381,5 +382,6 @@
 #define eBADFILETYPE     ((uint16_t) 0xc0)
 #define eSPAWANFAILED    ((uint16_t) 0xc1)
 #define eWAITFAILED      ((uint16_t) 0xc2)
+#define eWOULDBLOCK      ((uint16_t) 0xc3)
 
 #endif /* __PAS_ERRCODES_H */
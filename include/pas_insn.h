@@ -56,6 +56,8 @@ void insn_GenerateDataOperation(enum pcode_e opcode, int32_t data);
 void insn_GenerateDataSize(uint32_t dwDataSize);
 void insn_GenerateFpOperation(uint8_t fpOpcode);
 void insn_GenerateSetOperation(uint8_t setOpcode);
+void insn_PatchSetOperation(uint32_t progOffset, uint8_t setOpcode);
+void insn_GenerateSetBitOperation(enum pcode_e opcode, uint8_t setSize);
 void insn_GenerateIoOperation(uint16_t ioOpcode);
 void insn_StringLibraryCall(uint16_t libOpcode);
 void insn_OsInterfaceCall(uint16_t libOpcode);
@@ -84,6 +86,7 @@ void insn_ResetTmpOpCodeWrite(poffProgHandle_t progHandle);
 
 /* INSN-specific disassembler */
 
+const char *insn_GetOpCodeName(uint8_t opcode);
 void insn_DisassemblePCode(FILE* lfile, opType_t *pop);
 void insn_DisassembleLongOpCode(FILE* lfile, opType_t *pop);
 
@@ -54,7 +54,7 @@
 
 #define FNAME_SIZE          40           /* Max size file name */
 #define LINE_SIZE           256          /* Max size of input line buffer */
-#define MAX_OPEN_FILES      8            /* Max number of open file */
+#define MAX_OPEN_FILES      8            /* Initial size of the file table */
 
 /* Target P-Machine Data Storage Sizes.  Currently assumes 16-bit machine */
 
@@ -98,9 +98,19 @@
 #define sREAL_SIZE          8
 #define sPTR_SIZE           sINT_SIZE
 
+/* A set is a bit-string with one bit for each member of its base type.
+ * Its size grows in units of sSET_SIZE bytes (64 members) up to
+ * sSET_MAXSIZE bytes (256 members).
+ */
+
 #define sSET_SIZE           8
 #define sSET_WORDS         (sSET_SIZE / sINT_SIZE)
-#define sSET_MAXELEM       (8 * sSET_SIZE)
+#define sSET_MAXSIZE        32
+#define sSET_MAXWORDS      (sSET_MAXSIZE / sINT_SIZE)
+#define sSET_MAXELEM       (8 * sSET_MAXSIZE)
+
+#define SET_ALLOCSIZE(n)   ((((n) + 8 * sSET_SIZE - 1) / (8 * sSET_SIZE)) * \
+                            sSET_SIZE)
 
 /* Pascal string variables consist of:
  *
@@ -115,6 +115,10 @@ enum pcode_e
 
   opFLOAT,  opSETOP, opOSOP,
 
+  /* Set bit operations: arg = set size in bytes */
+
+  opSETIN, opSETINCL, opSETEXCL,
+
   /* Program control:  arg = unsigned label (One stack argument) */
 
   opJEQUZ, opJNEQZ,
@@ -79,4 +79,20 @@
 
 #define MAX_SETOP        (0x0f) /* Number of set operations */
 
+/* The SETOP sub-function carries both the set operation (bits 0-3) and the
+ * size of the set operands in units of sSET_SIZE bytes, less one (bits
+ * 4-5).  A set of up to 64 members has a size code of zero, so code that
+ * uses only those sets is unchanged.
+ */
+
+#define SETOP_MASK       (0x0f)
+#define SETOP_SIZE_SHIFT (4)
+#define SETOP_SIZE_MASK  (0x30)
+
+#define SETOP_ENCODE(op, size) \
+  ((op) | ((((size) / sSET_SIZE) - 1) << SETOP_SIZE_SHIFT))
+#define SETOP_OPCODE(subfunc) ((subfunc) & SETOP_MASK)
+#define SETOP_SETSIZE(subfunc) \
+  (((((subfunc) & SETOP_SIZE_MASK) >> SETOP_SIZE_SHIFT) + 1) * sSET_SIZE)
+
 #endif /* __PAS_SETOPS_H */
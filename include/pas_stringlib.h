@@ -391,6 +391,51 @@
 
 #define lbVAL           (0x001a)
 
-#define MAX_LBOP        (0x001b)
+/* Concatenate a list of strings and characters into a new string.  This is
+ * generated for a chain of concatenations like 'a + b + c' so that the
+ * result is built in a single string buffer.
+ *
+ *   function strcatn(s1, s2, ..., sn : string or char) : string;
+ *
+ * ON INPUT
+ *   TOS(0) = Number of operands, n (1 through MAX_STRCATN)
+ *   TOS(1) = Operand types:  Bit i is set if operand i (0 = s1) is a
+ *            character
+ *   TOS(2) = The last operand, sn.  A character is one word; a string is
+ *            three words (allocation size on top, then pointer to the
+ *            string data, then length)
+ *   ...    = The preceding operands, down to s1
+ * ON RETURN:
+ *   TOS(0) = Allocation size of the new string
+ *   TOS(1) = Pointer to the new string
+ *   TOS(2) = Length of the new string
+ */
+
+#define lbSTRCATN       (0x001b)
+
+#define MAX_STRCATN     (16)
+
+/* Convert a string to a real value
+ *
+ *   procedure val(const s : string; VAR v : real; VAR code : word);
+ *
+ * Description:
+ * This is the form of val() used when V is a Real.  Leading spaces are
+ * skipped.  On success Code is set to zero;  otherwise V is not modified
+ * and Code is set to the index of the first character in S that is not
+ * part of a decimal real number.
+ *
+ * ON INPUT
+ *   TOS(0) = address of Code
+ *   TOS(1) = address of v
+ *   TOS(2) = Source string buffer size
+ *   TOS(3) = Pointer to source string buffer
+ *   TOS(4) = Length of source string
+ * ON RETURN: actual parameters released
+ */
+
+#define lbVALREAL       (0x001c)
+
+#define MAX_LBOP        (0x001d)
 
 #endif /* __PAS_STRINGLIB_H */
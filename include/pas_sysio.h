@@ -110,7 +110,10 @@
 #define xREWINDDIR         (0x002a)  /* Read the next directory entry */
 #define xCLOSEDIR          (0x002b)  /* Terminate the directory read */
 
-#define MAX_XOP            (0x002c)
+#define xBLOCKREAD         (0x002c)  /* Read records from a typed file */
+#define xBLOCKWRITE        (0x002d)  /* Write records to a typed file */
+
+#define MAX_XOP            (0x002e)
 
 /* File attribute characters.  Default:  Non-hidden, regular files. */
 
@@ -78,6 +78,10 @@ char    *pbasename(char *path);
 int16_t  signExtend8(uint8_t arg8);
 int32_t  signExtend16(uint16_t arg16);
 
+/* Numeric conversion helpers */
+
+double   pstrtod(const char *str, char **endptr);
+
 /* Endian-ness helpers */
 
 uint16_t poffSwap16(uint16_t val);
@@ -61,6 +61,7 @@ typedef void *poffHandle_t;
 typedef void *poffProgHandle_t;
 typedef void *poffSymHandle_t;
 typedef void *poffRelocHandle_t;
+typedef void *poffMapHandle_t;
 
 /* This is a externally visible form of a symbol table entry that is
  * not entangled in the POFF internal string table logic.
@@ -199,6 +200,8 @@ int32_t      poffFindString(poffHandle_t handle, const char *string);
 uint32_t     poffAddString(poffHandle_t handle, const char *string);
 uint32_t     poffAddFileName(poffHandle_t handle, const char *name);
 void         poffAddProgByte(poffHandle_t handle, uint8_t progByte);
+void         poffSetProgByte(poffHandle_t handle, uint32_t offset,
+               uint8_t progByte);
 #if 0 /* not used */
 uint32_t     poffAddRoDataByte(poffHandle_t handle, uint8_t dataByte);
 #endif
@@ -243,6 +246,20 @@ int          poffProgSeek(poffHandle_t handle, uint32_t offset);
 uint32_t     poffGetProgSize(poffHandle_t handle);
 void         poffReleaseProgData(poffHandle_t handle);
 
+/* Functions to map the loadable sections of a POFF file for execution
+ * without copying them.
+ */
+
+uint16_t     poffMapFile(const char *fileName, poffMapHandle_t *handle);
+void         poffUnmapFile(poffMapHandle_t handle);
+uint8_t      poffMapGetFileType(poffMapHandle_t handle);
+uint8_t      poffMapGetArchitecture(poffMapHandle_t handle);
+uint32_t     poffMapGetEntryPoint(poffMapHandle_t handle);
+uint32_t     poffMapGetProgramData(poffMapHandle_t handle,
+               const uint8_t **progData);
+uint32_t     poffMapGetRoData(poffMapHandle_t handle,
+               const uint8_t **roData);
+
 /* Functions used to manage modifications to a POFF file using a
  * temporary container for the new program data.
  */
@@ -111,9 +111,9 @@
  * xx11 0011  ---        OSOP osop      PUSH nn        ---
  * xx11 0100  ---        PUSHB n        INDS nn        ---
  * xx11 0101  ---        UPUSHB n       INCS nn        ---
- * xx11 0110  ---        ---            LIB libop      ---
- * xx11 0111  UMUL       ---            SYSIO sysop    ---
- * xx11 1000  UDIV       ---            LAX uoffs      LASX loff,offs
+ * xx11 0110  ---        SETIN n        LIB libop      ---
+ * xx11 0111  UMUL       SETINCL n      SYSIO sysop    ---
+ * xx11 1000  UDIV       SETEXCL n      LAX uoffs      LASX loff,offs
  * xx11 1001  UMOD       ---            ---            ---
  * xx11 1010  ULT        ---            JULT  ilbl     ---
  * xx11 1011  UGTE       ---            JUGTE ilbl     ---
@@ -270,7 +270,19 @@
 #define oPUSHB  (o8|0x34)
 #define oUPUSHB (o8|0x35)
 
-/* (o8|0x36)-(o8|0x3f) -- unassigned */
+/* Set bit operations:  arg8 = set size in bytes.  The zero-based member is
+ * tested in, added to, or removed from the set variable at a stack address.
+ *
+ *   SETIN:   TOS(0) = set address, TOS(1) = member; pushes a boolean
+ *   SETINCL: TOS(0) = member, TOS(1) = set address
+ *   SETEXCL: TOS(0) = member, TOS(1) = set address
+ */
+
+#define oSETIN   (o8|0x36)
+#define oSETINCL (o8|0x37)
+#define oSETEXCL (o8|0x38)
+
+/* (o8|0x39)-(o8|0x3f) -- unassigned */
 
 /** OPCODES WITH SINGLE 16-BIT ARGUMENT (arg16) *****************************/
 
@@ -42,8 +42,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "pas_machine.h"
+#include "pofflib.h"
 
 /**********************************************************************************
  * Pre-processor Definitions
@@ -73,6 +75,14 @@
 #define INPUT_FILE_NUMBER   0
 #define OUTPUT_FILE_NUMBER  1
 
+/* The file table can grow to this many entries */
+
+#define MAX_FILE_NUMBER     1024
+
+/* Size of the printf format string built by libexec_GetFormat() */
+
+#define FORMAT_SIZE         20
+
 /* Remove the value from the top of the stack */
 
 #define POP(st, dest) \
@@ -130,6 +140,61 @@
     (st)->sp -= BPERI*(n); \
   } while (0)
 
+/* Size of frame info at the beginning of each frame:
+ *
+ *        |  Base Address  | + 5 * BPERI
+ *        +----------------+
+ *        |  Nesting Level | + 4 * BPERI
+ *        +----------------+
+ *        |   Saved CSP    | + 3 * BPERI
+ *        +----------------+
+ *        | Return Address | + 2 * BPERI
+ *        +----------------+
+ *        |  Dynamic Link  | + BPERI
+ *        +----------------+
+ *  FP -> |  Static Link   | 0
+ *        +----------------+
+ */
+
+/* Offsets relative to the frame pointer */
+
+#define _FSLINK (0)
+#define _FDLINK (BPERI)
+#define _FRET   (2 * BPERI)
+#define _FCSP   (3 * BPERI)
+#define _FLEVEL (4 * BPERI)
+
+#define _FBASE  (5 * BPERI)
+#define _FSIZE  (5 * BPERI)
+
+/* The display holds the frame pointer of the active frame at each static
+ * nesting level.  The nesting level is held in eight bits of the frame.
+ */
+
+#define MAX_DISPLAY  256
+
+/* Each active frame saves the display entry that it replaced.  Frames do
+ * not overlap, so the frame address identifies the save slot.
+ */
+
+#define DSAVEINDEX(st, fp) \
+  (((fp) - (st)->spb) / _FSIZE)
+
+/* Restore the display entry replaced by the frame at 'fp' with nesting
+ * level 'level' when that frame returns.
+ */
+
+#define RESTOREDISPLAY(st, level, fp) \
+  do { \
+    (st)->display[(level)] = (st)->dsave[DSAVEINDEX(st, fp)]; \
+  } while (0)
+
+/* Number of heap free lists:  One for each chunk size up to 256 bytes and
+ * one for each power of two above that (see libexec_heap.c).
+ */
+
+#define HEAP_NBINS             (32 + 7)
+
 /* Debug monitor capacities */
 
 #define TRACE_ARRAY_SIZE       16
@@ -182,13 +247,24 @@ typedef enum openMode_e openMode_t;
 
 struct execFileTable_s
 {
-  char fileName[FNAME_SIZE + 1];
+  char *fileName;           /* Allocated by ASSIGNFILE */
   bool inUse;
   bool text;
   bool eoln;
   uint16_t recordSize;
   FILE *stream;
   openMode_t openMode;
+
+  /* A typed file that is memory mapped is accessed through 'map' instead of
+   * 'stream'.  The stream is kept open to hold the file descriptor.
+   */
+
+  bool mapped;              /* true: File data is accessed through 'map' */
+  uint8_t *map;             /* Mapping of the file (NULL if empty) */
+  size_t mapSize;           /* Size of the mapping */
+  size_t diskSize;          /* Size of the file on disk */
+  size_t fileSize;          /* Size of the file data */
+  size_t filePos;           /* Current position in the file */
 };
 
 typedef struct execFileTable_s execFileTable_t;
@@ -229,22 +305,67 @@ struct trace_s
 typedef struct trace_s trace_t;
 #endif
 
-/* This structure describes the parameters needed to initialize the p-code
- * interpreter.
+/* This structure holds a loaded program.  It is never modified after it
+ * is loaded and may be shared by any number of instances of the p-code
+ * interpreter, including instances that run in different threads.  Loaded
+ * images are kept in a cache keyed by the file name and the hash of the
+ * loaded content (see libexec_LoadImage()).
  */
 
-struct libexec_attr_s
+struct libexec_image_s
 {
+  /* Image cache */
+
+  struct libexec_image_s *flink; /* Next image in the cache */
+  char     *fileName; /* File that the image was loaded from */
+  uint32_t  hash;     /* Hash of the entry point, I-Space and RO data */
+  int       crefs;    /* Number of references to the image */
+
+  /* The mapped POFF file.  I-Space and the read-only data are used in
+   * place.
+   */
+
+  poffMapHandle_t map;
+
   /* Instruction space (I-Space) */
 
-  uint8_t  *ispace;   /* Allocated I-Space containing p-code data */
+  const uint8_t *ispace; /* I-Space containing p-code data */
   pasSize_t entry;    /* Entry point */
   pasSize_t maxpc;    /* Last valid p-code address */
 
+  /* The result of libexec_Verify().  The program counter of a verified
+   * program need not be checked on each instruction.
+   */
+
+  bool      verified;    /* I-Space passed verification */
+  int       verifyError; /* Reason that verification failed */
+  pasSize_t verifyPC;    /* Address at which verification failed */
+
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  /* The predecoded I-Space executed by libexec_Dispatch() */
+
+  struct libexec_insn_s *code; /* One record per instruction, plus one */
+  uint16_t *pcIndex;           /* Maps I-Space address to record index */
+  pasSize_t ninsn;             /* Number of instructions in code[] */
+#endif
+
   /* Read-only data block */
 
-  uint8_t  *rodata;   /* Address of read-only data block */
+  const uint8_t *rodata; /* Address of read-only data block */
   pasSize_t roSize;   /* Size of read-only data block */
+};
+
+/* This structure describes the parameters needed to initialize the p-code
+ * interpreter.
+ */
+
+struct libexec_attr_s
+{
+  /* The program to run.  On success, the new instance takes over the
+   * caller's reference to the image.
+   */
+
+  struct libexec_image_s *image;
 
   /* Allocate for variable storage */
 
@@ -268,14 +389,26 @@ struct libexec_s
 
   stackType_t dstack;
 
+  /* The shared program image.  The fields below are copied from it. */
+
+  struct libexec_image_s *image;
+
   /* This is the emulated P-Machine instruction space (I-Space) */
 
-  uint8_t  *ispace;
+  const uint8_t *ispace;
 
  /* Address of last valid P-Code */
 
   pasSize_t maxpc;
 
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  /* The predecoded I-Space executed by libexec_Dispatch() */
+
+  struct libexec_insn_s *code; /* One record per instruction, plus one */
+  uint16_t *pcIndex;           /* Maps I-Space address to record index */
+  pasSize_t ninsn;             /* Number of instructions in code[] */
+#endif
+
   /* These are the emulated P-Machine registers:
    *
    * spb: Base of the stack
@@ -300,6 +433,15 @@ struct libexec_s
   pasSize_t pc;         /* Program counter */
   pasSize_t lsp;        /* Static nesting level */
 
+  /* The display:  display[n] is the frame pointer of the active frame at
+   * static nesting level n, for n = 0 through lsp.  It replaces walks
+   * along the static links on calls and on accesses to variables in outer
+   * scopes.
+   */
+
+  pasSize_t  display[MAX_DISPLAY];
+  pasSize_t *dsave;     /* Replaced display entries (see DSAVEINDEX) */
+
   /* Info needed to perform a simulated reset.  Memory organization:
    *
    *  0                                   : String stack
@@ -317,15 +459,65 @@ struct libexec_s
 
   pasSize_t entry;      /* Entry point */
   int16_t   exitCode;
+  uint64_t  insnCount;  /* Instructions executed by libexec_Run() */
+
+  /* Memory management.  freeList[] holds the heap offset of the first free
+   * chunk of each size class; bit n of freeMap is set when freeList[n] is
+   * not empty.
+   */
+
+  uint16_t  freeList[HEAP_NBINS];
+  uint64_t  freeMap;
 
-  /* Memory management */
+  /* Temporary string arena at the top of the heap region.  Buffers are
+   * allocated at arenaTop; arenaLast is the address of the header of the
+   * most recent buffer (arenaEnd if the arena is empty).
+   */
 
-  freeChunk_t *freeChunks;
+  uint16_t  arenaBase;
+  uint16_t  arenaEnd;
+  uint16_t  arenaTop;
+  uint16_t  arenaLast;
 
   /* File I/O */
 
-  execFileTable_t fileTable[MAX_OPEN_FILES];
+  /* The file table grows as files are allocated.  It starts with
+   * MAX_OPEN_FILES entries.
+   */
+
+  execFileTable_t *fileTable;
+  uint16_t nFiles;          /* Number of entries in fileTable */
+  bool mapFiles;            /* true: Memory map typed files when opened */
   uint8_t ioBuffer[LINE_SIZE + 1];
+  char    fmtBuffer[FORMAT_SIZE];  /* Returned by libexec_GetFormat() */
+
+  /* The streams bound to the standard files INPUT and OUTPUT.  These are
+   * stdin and stdout unless changed with libexec_SetStdio().
+   */
+
+  FILE   *input;
+  FILE   *output;
+
+#ifdef CONFIG_PASCAL_PROFILER
+  /* Execution profile:  When not NULL, the number of times that each
+   * I-Space address was dispatched (maxpc + 1 entries).
+   */
+
+  uint32_t  *profile;
+
+  /* Call stack sampler:  When not NULL, the call stack is recorded about
+   * every sampleInterval instructions by libexec_RunLoop().
+   */
+
+  struct libexec_sampler_s *sampler;
+  uint32_t   sampleInterval;
+
+  /* Heap profiler:  When not NULL, heap allocations are recorded by
+   * libexec_heap.c.
+   */
+
+  struct libexec_heapProfile_s *heapProfile;
+#endif
 
 #ifdef CONFIG_PASCAL_DEBUGGER
   /* Debug monitor */
@@ -357,6 +549,21 @@ struct libexec_s
 
 struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr);
 int    libexec_Execute(struct libexec_s *st);
+int    libexec_ExecuteVerified(struct libexec_s *st);
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+int    libexec_Dispatch(struct libexec_s *st, uint32_t maxInstructions);
+#endif
 void   libexec_Reset(struct libexec_s *st);
+int    libexec_Verify(struct libexec_image_s *image);
+int    libexec_ProcedureCall(struct libexec_s *st, level_t nestingLevel);
+ustack_t libexec_GetBaseAddress(struct libexec_s *st, level_t levelOffset,
+                                int32_t stackOffset);
+#ifdef CONFIG_PASCAL_PROFILER
+uint32_t libexec_TakeSample(struct libexec_s *st);
+void   libexec_ReleaseProfile(struct libexec_s *st);
+void   libexec_ReleaseHeapProfile(struct libexec_s *st);
+poffHandle_t libexec_ReadDebugInfo(struct libexec_s *st);
+void   libexec_ReleaseDebugInfo(poffHandle_t phandle);
+#endif
 
 #endif /* __LIBEXEC_H */
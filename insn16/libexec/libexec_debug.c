@@ -360,7 +360,7 @@ static pasSize_t pdbg_PrintPCode(struct libexec_s *st, pasSize_t pc, int16_t nit
 {
   opType_t op;
   pasSize_t  opsize;
-  uint8_t *address;
+  const uint8_t *address;
 
   for (; pc < st->maxpc && nitems > 0; nitems--)
     {
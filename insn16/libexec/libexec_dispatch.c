@@ -0,0 +1,1665 @@
+/****************************************************************************
+ * libexec_dispatch.c
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#include "paslib.h"
+#include "pas_debug.h"
+#include "pas_machine.h"
+#include "insn16.h"
+#include "pas_errcodes.h"
+
+#include "libexec_float.h"
+#include "libexec_sysio.h"
+#include "libexec_setops.h"
+#include "libexec_longops.h"
+#include "libexec_stringlib.h"
+#include "libexec_oslib.h"
+#include "libexec_predecode.h"
+#include "libexec.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Use computed goto (GCC labels-as-values) if the compiler supports it.
+ * Otherwise, fall back to a single switch statement.  Either way, there is
+ * exactly one dispatch point per instruction and no function call.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define USE_COMPUTED_GOTO 1
+#endif
+
+/* Instructions are executed from the predecoded instruction records.
+ * There is no range check on the program counter:  Execution that leaves
+ * I-Space lands on the final xBADPC record.
+ *
+ * Each dispatch is charged against the instruction budget.  When the
+ * budget is used up, the loop returns with st->pc at the next instruction
+ * to be executed.
+ *
+ * If profiling is enabled, each dispatch is also counted against the
+ * I-Space address of the record.  A superinstruction is counted once, at
+ * the address of the first instruction of its sequence.
+ */
+
+#ifdef CONFIG_PASCAL_PROFILER
+#  define PROFILE() \
+  do \
+    { \
+      if (profile != NULL) \
+        { \
+          profile[ip->pc]++; \
+        } \
+    } \
+  while (0)
+#else
+#  define PROFILE()
+#endif
+
+#ifdef USE_COMPUTED_GOTO
+#  define BEGIN_DISPATCH   DISPATCH();
+#  define END_DISPATCH
+#  define OPCODE(o)        L_##o:
+#  define ILLEGAL_OPCODE   L_ILLEGAL:
+#  define DISPATCH() \
+  do \
+    { \
+      if (--budget < 0) \
+        { \
+          goto budget_out; \
+        } \
+      PROFILE(); \
+      goto *ip->handler; \
+    } \
+  while (0)
+#else
+#  define BEGIN_DISPATCH   DISPATCH(); next_insn: switch (ip->op) {
+#  define END_DISPATCH     }
+#  define OPCODE(o)        case o:
+#  define ILLEGAL_OPCODE   default:
+#  define DISPATCH() \
+  do \
+    { \
+      if (--budget < 0) \
+        { \
+          goto budget_out; \
+        } \
+      PROFILE(); \
+      goto next_insn; \
+    } \
+  while (0)
+#endif
+
+/* Immediate data of the current instruction */
+
+#define IMM8               (ip->imm8)
+#define IMM16              (ip->imm16)
+
+/* Map an I-Space address to its instruction record */
+
+#define PCTOINSN(a) \
+  (&code[(a) < maxpc ? pcIndex[(a)] : ninsn])
+
+/* The stack pointer, the data stack base addresses, and a copy of the word
+ * at the top of the stack are held in local variables (and hence in machine
+ * registers) while the dispatch loop runs.  The top of stack copy is write-
+ * through:  The data stack in memory is always valid so that the word at
+ * any offset may be read directly.  Only st->sp must be synchronized (with
+ * SPILL() and RELOAD()) around calls to functions that use the data stack.
+ *
+ * A store to an absolute D-Space address might overwrite the top of the
+ * stack, so RPUT() and RPUTB() refresh the cached copy after the store.
+ */
+
+#define RPOP(dest) \
+  do \
+    { \
+      dest = tos; \
+      sp  -= BPERI; \
+      tos  = ds[BTOISTACK(sp)]; \
+    } \
+  while (0)
+
+#define RPUSH(src) \
+  do \
+    { \
+      ustack_t _v = (src); \
+      sp += BPERI; \
+      ds[BTOISTACK(sp)] = tos = _v; \
+    } \
+  while (0)
+
+#define SETTOP(src) \
+  do \
+    { \
+      ustack_t _v = (src); \
+      ds[BTOISTACK(sp)] = tos = _v; \
+    } \
+  while (0)
+
+#define RDISCARD(n) \
+  do \
+    { \
+      sp -= BPERI * (n); \
+      tos = ds[BTOISTACK(sp)]; \
+    } \
+  while (0)
+
+#define RTOS(off)          ds[BTOISTACK(sp) - (off)]
+#define RGET(addr)         ds[BTOISTACK(addr)]
+#define RGETB(addr)        dsb[addr]
+
+#define RPUT(src, addr) \
+  do \
+    { \
+      ds[BTOISTACK(addr)] = (src); \
+      tos = ds[BTOISTACK(sp)]; \
+    } \
+  while (0)
+
+#define RPUTB(src, addr) \
+  do \
+    { \
+      dsb[addr] = (src); \
+      tos = ds[BTOISTACK(sp)]; \
+    } \
+  while (0)
+
+#define SPILL() \
+  do \
+    { \
+      st->sp = sp; \
+    } \
+  while (0)
+
+#define RELOAD() \
+  do \
+    { \
+      sp  = st->sp; \
+      tos = ds[BTOISTACK(sp)]; \
+    } \
+  while (0)
+
+/* Library calls that allocate heap memory:  The heap profiler needs the
+ * I-Space address of the allocating instruction in st->pc.
+ */
+
+#ifdef CONFIG_PASCAL_PROFILER
+#  define SYNCPC() \
+  do \
+    { \
+      st->pc = ip->pc; \
+    } \
+  while (0)
+#else
+#  define SYNCPC()
+#endif
+
+/* Same as libexec_GetBaseAddress(), but without the function call */
+
+#define BASEADDRESS(leveloffset, offset) \
+  (st->display[(leveloffset) > st->lsp ? 0 : st->lsp - (leveloffset)] + \
+   (offset) + ((offset) >= 0 ? _FBASE : 0))
+
+/* Advance to the next sequential instruction or branch to the record
+ * index held in the immediate data.
+ */
+
+#define NEXT() \
+  do \
+    { \
+      ip++; \
+      DISPATCH(); \
+    } \
+  while (0)
+
+#define JUMP() \
+  do \
+    { \
+      ip = &code[ip->imm16]; \
+      DISPATCH(); \
+    } \
+  while (0)
+
+/* Skip over the 'n' records of a superinstruction.  The budget is charged
+ * for each instruction in the sequence.
+ */
+
+#define SKIP(n) \
+  do \
+    { \
+      ip     += (n); \
+      budget -= (n) - 1; \
+      DISPATCH(); \
+    } \
+  while (0)
+
+/* Superinstruction that compares the top of the stack with the immediate
+ * data of the first record and branches to the label of the second.
+ */
+
+#define CMPJUMP(value, cond) \
+  do \
+    { \
+      sparm1 = (value); \
+      RPOP(sparm2); \
+      if (sparm2 cond sparm1) \
+        { \
+          ip = &code[ip[1].imm16]; \
+          budget--; \
+          DISPATCH(); \
+        } \
+      SKIP(2); \
+    } \
+  while (0)
+
+/* Replace the zero-based set member at the top of the stack with a boolean
+ * that is true if the member is in the set at D-Space address 'addr'.
+ * Shared by SETIN and the LA/LAS SETIN superinstructions.
+ */
+
+#define SETMEMBER(addr, size) \
+  do \
+    { \
+      if (tos >= 8 * (ustack_t)(size)) \
+        { \
+          ret = eVALUERANGE; \
+          goto errout; \
+        } \
+      uparm3 = RGET((addr) + BPERI * (tos >> 4)); \
+      SETTOP(((uparm3 & (1 << (tos & 0x0f))) != 0) ? \
+             PASCAL_TRUE : PASCAL_FALSE); \
+    } \
+  while (0)
+
+/* Return from the dispatch loop if a helper reported an error */
+
+#define CHECK(r) \
+  do \
+    { \
+      if ((r) != eNOERROR) \
+        { \
+          goto errout; \
+        } \
+    } \
+  while (0)
+
+/* Push memory from D-Space onto the stack: Shared by the LD*M family */
+
+#define LOADMULTIPLE(size, addr) \
+  do \
+    { \
+      while ((size) > 0) \
+        { \
+          if ((size) >= BPERI) \
+            { \
+              RPUSH(RGET(addr)); \
+              (addr) += BPERI; \
+              (size) -= BPERI; \
+            } \
+          else \
+            { \
+              RPUSH(RGETB(addr)); \
+              (addr)++; \
+              (size)--; \
+            } \
+        } \
+    } \
+  while (0)
+
+/* Store stack data to D-Space:  Shared by the ST*M family.  'index' is the
+ * stack word offset of the first word to be stored.  The cached top of
+ * stack is not refreshed here:  Every user discards the stored data
+ * afterward with RDISCARD().
+ */
+
+#define STOREMULTIPLE(size, addr, index) \
+  do \
+    { \
+      while ((size) > 0) \
+        { \
+          if ((size) >= BPERI) \
+            { \
+              ds[BTOISTACK(addr)] = RTOS(index); \
+              (addr) += BPERI; \
+              (size) -= BPERI; \
+              (index)--; \
+            } \
+          else \
+            { \
+              dsb[addr] = RTOS(index); \
+              (addr)++; \
+              (size)--; \
+            } \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_ThreadedLoop
+ *
+ * Description:
+ *   Execute P-Code from the predecoded instruction records until an
+ *   exceptional condition is encountered or until 'maxInstructions' have
+ *   been executed.  This is functionally equivalent to calling
+ *   libexec_Execute() repeatedly until it returns something other than
+ *   eNOERROR, but all instruction handlers live in this one
+ *   function so that control passes directly from one handler to the next
+ *   without a function call and without any instruction decoding.
+ *
+ *   The handler addresses are local to this function.  If 'table' is
+ *   non-NULL, nothing is executed; the dispatch table is returned instead
+ *   so that libexec_Predecode() can store handler addresses in the
+ *   instruction records.
+ *
+ * Returned Value:
+ *   The exceptional condition that stopped execution (eEXIT on normal
+ *   program termination) or eNOERROR if the instruction budget was used
+ *   up.  A superinstruction may overrun the budget by the length of its
+ *   sequence.
+ *
+ ****************************************************************************/
+
+static int libexec_ThreadedLoop(struct libexec_s *st,
+                                uint32_t maxInstructions,
+                                const void *const **table)
+{
+#ifdef USE_COMPUTED_GOTO
+  static const void *const g_dispatch[NUM_DISPATCH] =
+  {
+    [0 ... 255]  = &&L_ILLEGAL,
+    [xBADPC]     = &&L_xBADPC,
+    [xPCAL]      = &&L_xPCAL,
+
+    /* Opcodes with no immediate data */
+
+    [oNOP]       = &&L_oNOP,
+    [oNEG]       = &&L_oNEG,
+    [oABS]       = &&L_oABS,
+    [oINC]       = &&L_oINC,
+    [oDEC]       = &&L_oDEC,
+    [oNOT]       = &&L_oNOT,
+    [oADD]       = &&L_oADD,
+    [oSUB]       = &&L_oSUB,
+    [oMUL]       = &&L_oMUL,
+    [oDIV]       = &&L_oDIV,
+    [oMOD]       = &&L_oMOD,
+    [oSLL]       = &&L_oSLL,
+    [oSRL]       = &&L_oSRL,
+    [oSRA]       = &&L_oSRA,
+    [oOR]        = &&L_oOR,
+    [oAND]       = &&L_oAND,
+    [oEQUZ]      = &&L_oEQUZ,
+    [oNEQZ]      = &&L_oNEQZ,
+    [oLTZ]       = &&L_oLTZ,
+    [oGTEZ]      = &&L_oGTEZ,
+    [oGTZ]       = &&L_oGTZ,
+    [oLTEZ]      = &&L_oLTEZ,
+    [oEQU]       = &&L_oEQU,
+    [oNEQ]       = &&L_oNEQ,
+    [oLT]        = &&L_oLT,
+    [oGTE]       = &&L_oGTE,
+    [oGT]        = &&L_oGT,
+    [oLTE]       = &&L_oLTE,
+    [oLDI]       = &&L_oLDI,
+    [oLDIB]      = &&L_oLDIB,
+    [oULDIB]     = &&L_oULDIB,
+    [oLDIM]      = &&L_oLDIM,
+    [oSTI]       = &&L_oSTI,
+    [oSTIB]      = &&L_oSTIB,
+    [oSTIM]      = &&L_oSTIM,
+    [oDUP]       = &&L_oDUP,
+    [oXCHG]      = &&L_oXCHG,
+    [oRET]       = &&L_oRET,
+    [oUMUL]      = &&L_oUMUL,
+    [oUDIV]      = &&L_oUDIV,
+    [oUMOD]      = &&L_oUMOD,
+    [oULT]       = &&L_oULT,
+    [oUGTE]      = &&L_oUGTE,
+    [oUGT]       = &&L_oUGT,
+    [oULTE]      = &&L_oULTE,
+    [oXOR]       = &&L_oXOR,
+    [oEND]       = &&L_oEND,
+
+    /* Opcodes with 8-bit immediate data */
+
+    [oFLOAT]     = &&L_oFLOAT,
+    [oSETOP]     = &&L_oSETOP,
+    [oLONGOP8]   = &&L_oLONGOP8,
+    [oOSOP]      = &&L_oOSOP,
+    [oPUSHB]     = &&L_oPUSHB,
+    [oUPUSHB]    = &&L_oUPUSHB,
+    [oSETIN]     = &&L_oSETIN,
+    [oSETINCL]   = &&L_oSETINCL,
+    [oSETEXCL]   = &&L_oSETEXCL,
+
+    /* Opcodes with 16-bit immediate data */
+
+    [oJEQUZ]     = &&L_oJEQUZ,
+    [oJNEQZ]     = &&L_oJNEQZ,
+    [oJLTZ]      = &&L_oJLTZ,
+    [oJGTEZ]     = &&L_oJGTEZ,
+    [oJGTZ]      = &&L_oJGTZ,
+    [oJLTEZ]     = &&L_oJLTEZ,
+    [oJMP]       = &&L_oJMP,
+    [oJEQU]      = &&L_oJEQU,
+    [oJNEQ]      = &&L_oJNEQ,
+    [oJLT]       = &&L_oJLT,
+    [oJGTE]      = &&L_oJGTE,
+    [oJGT]       = &&L_oJGT,
+    [oJLTE]      = &&L_oJLTE,
+    [oLD]        = &&L_oLD,
+    [oLDB]       = &&L_oLDB,
+    [oULDB]      = &&L_oULDB,
+    [oLDM]       = &&L_oLDM,
+    [oST]        = &&L_oST,
+    [oSTB]       = &&L_oSTB,
+    [oSTM]       = &&L_oSTM,
+    [oLDX]       = &&L_oLDX,
+    [oLDXB]      = &&L_oLDXB,
+    [oULDXB]     = &&L_oULDXB,
+    [oLDXM]      = &&L_oLDXM,
+    [oSTX]       = &&L_oSTX,
+    [oSTXB]      = &&L_oSTXB,
+    [oSTXM]      = &&L_oSTXM,
+    [oLA]        = &&L_oLA,
+    [oLAC]       = &&L_oLAC,
+    [oLAR]       = &&L_oLAR,
+    [oPUSH]      = &&L_oPUSH,
+    [oINDS]      = &&L_oINDS,
+    [oINCS]      = &&L_oINCS,
+    [oSTRLIB]    = &&L_oSTRLIB,
+    [oSYSIO]     = &&L_oSYSIO,
+    [oLAX]       = &&L_oLAX,
+    [oJULT]      = &&L_oJULT,
+    [oJUGTE]     = &&L_oJUGTE,
+    [oJUGT]      = &&L_oJUGT,
+    [oJULTE]     = &&L_oJULTE,
+
+    /* Opcodes with 8- and 16-bit immediate data */
+
+    [oPCAL]      = &&L_oPCAL,
+    [oLDS]       = &&L_oLDS,
+    [oLDSB]      = &&L_oLDSB,
+    [oULDSB]     = &&L_oULDSB,
+    [oLDSM]      = &&L_oLDSM,
+    [oSTS]       = &&L_oSTS,
+    [oSTSB]      = &&L_oSTSB,
+    [oSTSM]      = &&L_oSTSM,
+    [oLDSX]      = &&L_oLDSX,
+    [oLDSXB]     = &&L_oLDSXB,
+    [oULDSXB]    = &&L_oULDSXB,
+    [oLDSXM]     = &&L_oLDSXM,
+    [oSTSX]      = &&L_oSTSX,
+    [oSTSXB]     = &&L_oSTSXB,
+    [oSTSXM]     = &&L_oSTSXM,
+    [oLAS]       = &&L_oLAS,
+    [oLASX]      = &&L_oLASX,
+    [oLONGOP24]  = &&L_oLONGOP24,
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+    /* Superinstructions */
+
+    [xLD_PUSHB_SLL] = &&L_xLD_PUSHB_SLL,
+    [xLD_INC_ST]    = &&L_xLD_INC_ST,
+    [xLD_PUSHB]     = &&L_xLD_PUSHB,
+    [xPUSHB_SLL]    = &&L_xPUSHB_SLL,
+    [xST_LD]        = &&L_xST_LD,
+    [xLD_LD]        = &&L_xLD_LD,
+    [xADD_ST]       = &&L_xADD_ST,
+    [xINC_ST]       = &&L_xINC_ST,
+    [xPUSHB_LDXM]   = &&L_xPUSHB_LDXM,
+    [xPUSHB_STXM]   = &&L_xPUSHB_STXM,
+    [xLDS_LDS]      = &&L_xLDS_LDS,
+    [xLDS_LDI]      = &&L_xLDS_LDI,
+    [xLA_SETIN]     = &&L_xLA_SETIN,
+    [xLAS_SETIN]    = &&L_xLAS_SETIN,
+    [xPUSHB_JEQU]   = &&L_xPUSHB_JEQU,
+    [xPUSHB_JNEQ]   = &&L_xPUSHB_JNEQ,
+    [xPUSHB_JLT]    = &&L_xPUSHB_JLT,
+    [xPUSHB_JGTE]   = &&L_xPUSHB_JGTE,
+    [xPUSHB_JGT]    = &&L_xPUSHB_JGT,
+    [xPUSHB_JLTE]   = &&L_xPUSHB_JLTE,
+    [xPUSH_JEQU]    = &&L_xPUSH_JEQU,
+    [xPUSH_JNEQ]    = &&L_xPUSH_JNEQ,
+    [xPUSH_JLT]     = &&L_xPUSH_JLT,
+    [xPUSH_JGTE]    = &&L_xPUSH_JGTE,
+    [xPUSH_JGT]     = &&L_xPUSH_JGT,
+    [xPUSH_JLTE]    = &&L_xPUSH_JLTE,
+#endif
+  };
+#endif
+
+  libexec_insn_t *code;
+  libexec_insn_t *ip;
+#ifdef CONFIG_PASCAL_PROFILER
+  uint32_t *profile;
+#endif
+  uint16_t *pcIndex;
+  pasSize_t maxpc;
+  pasSize_t ninsn;
+  ustack_t *ds;
+  uint8_t  *dsb;
+  pasSize_t spb;
+  pasSize_t sp;
+  ustack_t  tos;
+  int32_t   budget;
+  int32_t   start;
+  sstack_t  sparm1;
+  sstack_t  sparm2;
+  ustack_t  uparm1;
+  ustack_t  uparm2;
+  ustack_t  uparm3;
+  int       ret;
+
+  if (table != NULL)
+    {
+#ifdef USE_COMPUTED_GOTO
+      *table = g_dispatch;
+#else
+      *table = NULL;
+#endif
+      return eNOERROR;
+    }
+
+  code    = st->code;
+  pcIndex = st->pcIndex;
+  maxpc   = st->maxpc;
+  ninsn   = st->ninsn;
+  ip      = PCTOINSN(st->pc);
+#ifdef CONFIG_PASCAL_PROFILER
+  profile = st->profile;
+#endif
+
+  ds      = st->dstack.i;
+  dsb     = st->dstack.b;
+  spb     = st->spb;
+  RELOAD();
+
+  budget  = maxInstructions > INT32_MAX ? INT32_MAX :
+            (int32_t)maxInstructions;
+  start   = budget;
+
+  BEGIN_DISPATCH
+
+  /** OPCODES WITH NO ARGUMENTS *********************************************/
+
+  /* Arithmetic & logical & and integer conversions (One stack argument) */
+
+  OPCODE(oNEG)
+    SETTOP((ustack_t)(-(sstack_t)tos));
+    NEXT();
+
+  OPCODE(oABS)
+    if (signExtend16(tos) < 0)
+      {
+        SETTOP((ustack_t)(-signExtend16(tos)));
+      }
+
+    NEXT();
+
+  OPCODE(oINC)
+    SETTOP(tos + 1);
+    NEXT();
+
+  OPCODE(oDEC)
+    SETTOP(tos - 1);
+    NEXT();
+
+  OPCODE(oNOT)
+    SETTOP(~tos);
+    NEXT();
+
+  /* Arithmetic & logical (Two stack arguments) */
+
+  OPCODE(oADD)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) + sparm1));
+    NEXT();
+
+  OPCODE(oSUB)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) - sparm1));
+    NEXT();
+
+  OPCODE(oMUL)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) * sparm1));
+    NEXT();
+
+  OPCODE(oUMUL)
+    RPOP(uparm1);
+    SETTOP(((ustack_t)tos) * uparm1);
+    NEXT();
+
+  OPCODE(oDIV)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) / sparm1));
+    NEXT();
+
+  OPCODE(oUDIV)
+    RPOP(uparm1);
+    SETTOP(((ustack_t)tos) / uparm1);
+    NEXT();
+
+  OPCODE(oMOD)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) % sparm1));
+    NEXT();
+
+  OPCODE(oUMOD)
+    RPOP(uparm1);
+    SETTOP(((ustack_t)tos) % uparm1);
+    NEXT();
+
+  OPCODE(oSLL)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) << sparm1));
+    NEXT();
+
+  OPCODE(oSRL)
+    RPOP(sparm1);
+    SETTOP(tos >> sparm1);
+    NEXT();
+
+  OPCODE(oSRA)
+    RPOP(sparm1);
+    SETTOP((ustack_t)(((sstack_t)tos) >> sparm1));
+    NEXT();
+
+  OPCODE(oOR)
+    RPOP(uparm1);
+    SETTOP(tos | uparm1);
+    NEXT();
+
+  OPCODE(oAND)
+    RPOP(uparm1);
+    SETTOP(tos & uparm1);
+    NEXT();
+
+  OPCODE(oXOR)
+    RPOP(uparm1);
+    SETTOP(tos ^ uparm1);
+    NEXT();
+
+  /* Comparisons (One stack argument) */
+
+  OPCODE(oEQUZ)
+    SETTOP(((sstack_t)tos == 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oNEQZ)
+    SETTOP(((sstack_t)tos != 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oLTZ)
+    SETTOP(((sstack_t)tos < 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oGTEZ)
+    SETTOP(((sstack_t)tos >= 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oGTZ)
+    SETTOP(((sstack_t)tos > 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oLTEZ)
+    SETTOP(((sstack_t)tos <= 0) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  /* Comparisons (Two stack arguments) */
+
+  OPCODE(oEQU)
+    RPOP(sparm1);
+    SETTOP((sparm1 == (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oNEQ)
+    RPOP(sparm1);
+    SETTOP((sparm1 != (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oLT)
+    RPOP(sparm1);
+    SETTOP((sparm1 > (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oGTE)
+    RPOP(sparm1);
+    SETTOP((sparm1 <= (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oGT)
+    RPOP(sparm1);
+    SETTOP((sparm1 < (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oLTE)
+    RPOP(sparm1);
+    SETTOP((sparm1 >= (sstack_t)tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oULT)
+    RPOP(uparm1);
+    SETTOP((uparm1 > tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oUGTE)
+    RPOP(uparm1);
+    SETTOP((uparm1 <= tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oUGT)
+    RPOP(uparm1);
+    SETTOP((uparm1 < tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  OPCODE(oULTE)
+    RPOP(uparm1);
+    SETTOP((uparm1 >= tos) ? PASCAL_TRUE : PASCAL_FALSE);
+    NEXT();
+
+  /* Load (One stack argument) */
+
+  OPCODE(oLDI)
+    SETTOP(RGET(tos));
+    NEXT();
+
+  OPCODE(oLDIB)
+    SETTOP((ustack_t)signExtend8(RGETB(tos)));
+    NEXT();
+
+  OPCODE(oULDIB)
+    SETTOP(RGETB(tos));
+    NEXT();
+
+  OPCODE(oLDIM)
+    RPOP(uparm1);                /* Size */
+    RPOP(uparm2);                /* Stack offset */
+    LOADMULTIPLE(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oDUP)
+    uparm1 = tos;
+    RPUSH(uparm1);
+    NEXT();
+
+  OPCODE(oXCHG)
+    uparm1     = tos;
+    SETTOP(RTOS(1));
+    RTOS(1) = uparm1;
+    NEXT();
+
+  /* Store (Two stack arguments) */
+
+  OPCODE(oSTI)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    RPUT(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTIB)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    RPUTB(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTIM)
+    RPOP(uparm1);                /* Size in bytes */
+    uparm3 = uparm1;             /* Save for stack discard */
+    sparm1 = ROUNDBTOI(uparm1);  /* Size in words */
+    uparm2 = RTOS(sparm1);    /* Stack offset */
+    sparm1--;
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data + the stack offset */
+
+    RDISCARD((ROUNDBTOI(uparm3) + 1));
+    NEXT();
+
+  /* Program control (No stack arguments) */
+
+  OPCODE(oNOP)
+    NEXT();
+
+  OPCODE(oRET)
+    uparm3 = st->fp;             /* The frame being released */
+    RPOP(uparm1);                /* Restore the nesting level in the LSP */
+    st->lsp = uparm1 >> 8;
+    RESTOREDISPLAY(st, uparm1 & 0xff, uparm3);
+
+    RPOP(st->csp);               /* Restore the string stack pointer */
+    RPOP(uparm2);                /* Get the return address */
+    RPOP(st->fp);                /* Set the FP back to the dynamic link */
+    RDISCARD(1);                 /* Discard the static link */
+    ip = PCTOINSN(uparm2);
+    DISPATCH();
+
+  /* System Functions (No stack arguments) */
+
+  OPCODE(oEND)
+    ret = eEXIT;
+    goto errout;
+
+  /** OPCODES WITH 8-BIT IMMEDIATE DATA *************************************/
+
+  /* Data stack:  imm8 = 8 bit data (no stack arguments) */
+
+  OPCODE(oPUSHB)
+    RPUSH(signExtend8(IMM8));
+    NEXT();
+
+  OPCODE(oUPUSHB)
+    RPUSH(IMM8);
+    NEXT();
+
+  /* Floating Point, set, OS and long operations:  imm8 = sub-opcode
+   * (varying number of stack arguments)
+   */
+
+  OPCODE(oFLOAT)
+    SPILL();
+    ret = libexec_FloatOps(st, ip->imm8);
+    RELOAD();
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  OPCODE(oSETOP)
+    SPILL();
+    ret = libexec_SetOperations(st, ip->imm8);
+    RELOAD();
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  OPCODE(oOSOP)
+    SPILL();
+    SYNCPC();
+    ret = libexec_OsOperations(st, ip->imm8);
+    RELOAD();
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  OPCODE(oLONGOP8)
+    SPILL();
+    ret = libexec_LongOperation8(st, (enum longOp8_e)ip->imm8);
+    RELOAD();
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  /* Set bit operations:  imm8 = set size in bytes */
+
+  OPCODE(oSETIN)
+    RPOP(uparm1);                /* Set address */
+    SETMEMBER(uparm1, IMM8);
+    NEXT();
+
+  OPCODE(oSETINCL)
+    RPOP(uparm2);                /* Member */
+    RPOP(uparm1);                /* Set address */
+    if (uparm2 >= 8 * (ustack_t)IMM8)
+      {
+        ret = eVALUERANGE;
+        goto errout;
+      }
+
+    uparm1 += BPERI * (uparm2 >> 4);
+    RPUT(RGET(uparm1) | (1 << (uparm2 & 0x0f)), uparm1);
+    NEXT();
+
+  OPCODE(oSETEXCL)
+    RPOP(uparm2);                /* Member */
+    RPOP(uparm1);                /* Set address */
+    if (uparm2 >= 8 * (ustack_t)IMM8)
+      {
+        ret = eVALUERANGE;
+        goto errout;
+      }
+
+    uparm1 += BPERI * (uparm2 >> 4);
+    RPUT(RGET(uparm1) & ~(1 << (uparm2 & 0x0f)), uparm1);
+    NEXT();
+
+  /** OPCODES WITH 16-BIT IMMEDIATE DATA ************************************/
+
+  /* Program control:  imm16 = unsigned label (no stack arguments) */
+
+  OPCODE(oJMP)
+    JUMP();
+
+  /* Program control:  imm16 = unsigned label (One stack argument) */
+
+  OPCODE(oJEQUZ)
+    RPOP(sparm1);
+    if (sparm1 == 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJNEQZ)
+    RPOP(sparm1);
+    if (sparm1 != 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJLTZ)
+    RPOP(sparm1);
+    if (sparm1 < 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJGTEZ)
+    RPOP(sparm1);
+    if (sparm1 >= 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJGTZ)
+    RPOP(sparm1);
+    if (sparm1 > 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJLTEZ)
+    RPOP(sparm1);
+    if (sparm1 <= 0)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  /* Program control:  imm16 = unsigned label (Two stack arguments) */
+
+  OPCODE(oJEQU)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 == sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJNEQ)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 != sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJLT)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 < sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJGTE)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 >= sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJGT)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 > sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJLTE)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    if (sparm2 <= sparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJULT)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    if (uparm2 < uparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJUGTE)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    if (uparm2 >= uparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJUGT)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    if (uparm2 > uparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  OPCODE(oJULTE)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    if (uparm2 <= uparm1)
+      {
+        JUMP();
+      }
+
+    NEXT();
+
+  /* Load:  imm16 = usigned offset (no stack arguments) */
+
+  OPCODE(oLD)
+    uparm1 = spb + IMM16;
+    RPUSH(RGET(uparm1));
+    NEXT();
+
+  OPCODE(oLDB)
+    uparm1 = spb + IMM16;
+    RPUSH((ustack_t)signExtend8(RGETB(uparm1)));
+    NEXT();
+
+  OPCODE(oULDB)
+    uparm1 = spb + IMM16;
+    RPUSH(RGETB(uparm1));
+    NEXT();
+
+  OPCODE(oLDM)
+    RPOP(uparm1);
+    uparm2 = spb + IMM16;
+    LOADMULTIPLE(uparm1, uparm2);
+    NEXT();
+
+  /* Load & store: imm16 = unsigned base offset (One stack argument) */
+
+  OPCODE(oST)
+    uparm1 = spb + IMM16;
+    RPOP(uparm2);
+    RPUT(uparm2, uparm1);
+    NEXT();
+
+  OPCODE(oSTB)
+    uparm1 = spb + IMM16;
+    RPOP(uparm2);
+    RPUTB(uparm2, uparm1);
+    NEXT();
+
+  OPCODE(oSTM)
+    RPOP(uparm1);                /* Size */
+    uparm3 = uparm1;             /* Save for stack discard */
+    uparm2 = spb + IMM16;
+    sparm1 = ROUNDBTOI(uparm1) - 1;
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data */
+
+    RDISCARD(ROUNDBTOI(uparm3));
+    NEXT();
+
+  OPCODE(oLDX)
+    uparm1     = spb + IMM16 + tos;
+    SETTOP(RGET(uparm1));
+    NEXT();
+
+  OPCODE(oLDXB)
+    uparm1     = spb + IMM16 + tos;
+    SETTOP((ustack_t)signExtend8(RGETB(uparm1)));
+    NEXT();
+
+  OPCODE(oULDXB)
+    uparm1     = spb + IMM16 + tos;
+    SETTOP(RGETB(uparm1));
+    NEXT();
+
+  OPCODE(oLDXM)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += spb + IMM16;
+    LOADMULTIPLE(uparm1, uparm2);
+    NEXT();
+
+  /* Store: imm16 = unsigned base offset (Two stack arguments) */
+
+  OPCODE(oSTX)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += spb + IMM16;
+    RPUT(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTXB)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += spb + IMM16;
+    RPUTB(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTXM)
+    RPOP(uparm1);                /* Size */
+    uparm3 = uparm1;             /* Save for stack discard */
+    sparm1 = ROUNDBTOI(uparm1);  /* Size in 16-bit words */
+    uparm2 = RTOS(sparm1);    /* index */
+    sparm1--;
+    uparm2 += spb + IMM16;
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data + the index */
+
+    RDISCARD((ROUNDBTOI(uparm3) + 1));
+    NEXT();
+
+  OPCODE(oLA)
+    uparm1 = spb + IMM16;
+    RPUSH(uparm1);
+    NEXT();
+
+  OPCODE(oLAX)
+    SETTOP(spb + IMM16 + tos);
+    NEXT();
+
+  /* Data stack:  imm16 = 16 bit signed data (no stack arguments) */
+
+  OPCODE(oPUSH)
+    RPUSH(IMM16);
+    NEXT();
+
+  OPCODE(oINDS)
+    sp += signExtend16(IMM16);
+    tos = ds[BTOISTACK(sp)];
+    NEXT();
+
+  OPCODE(oINCS)
+    st->csp += signExtend16(IMM16);
+    NEXT();
+
+  /* System Functions:  imm16 = sub-function code */
+
+  OPCODE(oSTRLIB)
+    SPILL();
+    SYNCPC();
+    ret = libexec_StringOperations(st, ip->imm16);
+    RELOAD();
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  OPCODE(oSYSIO)
+    SPILL();
+    SYNCPC();
+    ret = libexec_sysio(st, ip->imm16);
+    RELOAD();
+
+    /* Repeat the operation on the next call if input is not available */
+
+    if (ret == eWOULDBLOCK)
+      {
+        goto errout;
+      }
+
+    ip++;
+    CHECK(ret);
+    DISPATCH();
+
+  /* Program control:  imm16 = unsigned data offset (no stack arguments) */
+
+  OPCODE(oLAC)
+    uparm1 = IMM16 + st->rop;
+    RPUSH(uparm1);
+    NEXT();
+
+  OPCODE(oLAR)
+    uparm1 = IMM16 + sp;
+    RPUSH(uparm1);
+    NEXT();
+
+  /** OPCODES WITH 8- AND 16-BIT IMMEDIATE DATA *****************************/
+
+  /* Load:  imm8 = level; imm16 = signed frame offset (no stack arguments) */
+
+  OPCODE(oLDS)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUSH(RGET(uparm1));
+    NEXT();
+
+  OPCODE(oLDSB)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUSH((ustack_t)signExtend8(RGETB(uparm1)));
+    NEXT();
+
+  OPCODE(oULDSB)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUSH(RGETB(uparm1));
+    NEXT();
+
+  OPCODE(oLDSM)
+    RPOP(uparm1);
+    uparm2 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    LOADMULTIPLE(uparm1, uparm2);
+    NEXT();
+
+  /* Load & store: imm8 = level; imm16 = signed frame offset (One stack
+   * argument)
+   */
+
+  OPCODE(oSTS)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPOP(uparm2);
+    RPUT(uparm2, uparm1);
+    NEXT();
+
+  OPCODE(oSTSB)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPOP(uparm2);
+    RPUTB(uparm2, uparm1);
+    NEXT();
+
+  OPCODE(oSTSM)
+    RPOP(uparm1);                /* Size */
+    uparm3 = uparm1;             /* Save for stack discard */
+    uparm2 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    sparm1 = ROUNDBTOI(uparm1) - 1;
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data */
+
+    RDISCARD(ROUNDBTOI(uparm3));
+    NEXT();
+
+  OPCODE(oLDSX)
+    uparm1     = BASEADDRESS(IMM8, signExtend16(IMM16) + tos);
+    SETTOP(RGET(uparm1));
+    NEXT();
+
+  OPCODE(oLDSXB)
+    uparm1     = BASEADDRESS(IMM8, signExtend16(IMM16) + tos);
+    SETTOP((ustack_t)signExtend8(RGETB(uparm1)));
+    NEXT();
+
+  OPCODE(oULDSXB)
+    uparm1     = BASEADDRESS(IMM8, signExtend16(IMM16) + tos);
+    SETTOP(RGETB(uparm1));
+    NEXT();
+
+  OPCODE(oLDSXM)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += BASEADDRESS(IMM8, signExtend16(IMM16));
+    LOADMULTIPLE(uparm1, uparm2);
+    NEXT();
+
+  /* Store: imm8 = level; imm16 = signed frame offset (Two stack arguments) */
+
+  OPCODE(oSTSX)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUT(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTSXB)
+    RPOP(uparm1);
+    RPOP(uparm2);
+    uparm2 += BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUTB(uparm1, uparm2);
+    NEXT();
+
+  OPCODE(oSTSXM)
+    RPOP(uparm1);                /* Size */
+    uparm3 = uparm1;             /* Save for stack discard */
+    sparm1 = ROUNDBTOI(uparm1);  /* Size in 16-bit words */
+    uparm2 = RTOS(sparm1);    /* index */
+    sparm1--;
+    uparm2 += BASEADDRESS(IMM8, signExtend16(IMM16));
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data + the index */
+
+    RDISCARD((ROUNDBTOI(uparm3) + 1));
+    NEXT();
+
+  OPCODE(oLAS)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUSH(uparm1);
+    NEXT();
+
+  OPCODE(oLASX)
+    SETTOP(BASEADDRESS(IMM8, signExtend16(IMM16) + tos));
+    NEXT();
+
+  /* Program Control:  imm8 = level; imm16 = unsigned label (No stack
+   * arguments).  The procedure call logic uses st->pc to form the return
+   * address.
+   */
+
+  OPCODE(oPCAL)
+    SPILL();
+    st->pc = ip->pc;
+    ret    = libexec_ProcedureCall(st, IMM8);
+    ip     = &code[IMM16];
+    RELOAD();
+    CHECK(ret);
+    DISPATCH();
+
+  /* The same call in a verified program.  The nesting level was checked
+   * when the program was loaded, so the frame is built here directly (see
+   * libexec_ProcedureCall()).
+   */
+
+  OPCODE(xPCAL)
+    uparm1 = IMM8;               /* Nesting level of the callee */
+    uparm2 = sp + BPERI;         /* The new frame */
+
+    RGET(uparm2 + _FSLINK) = st->display[uparm1 - 1];
+    RGET(uparm2 + _FDLINK) = st->fp;
+    RGET(uparm2 + _FRET)   = ip->pc + 4;
+    RGET(uparm2 + _FCSP)   = st->csp;
+    RGET(uparm2 + _FLEVEL) = st->lsp << 8 | uparm1;
+    sp  = uparm2 + _FSIZE - BPERI;
+    tos = RGET(sp);
+
+    st->lsp                           = uparm1;
+    st->fp                            = uparm2;
+    st->dsave[DSAVEINDEX(st, uparm2)] = st->display[uparm1];
+    st->display[uparm1]               = uparm2;
+    JUMP();
+
+  /* Long branch operations:  imm8 = long opcode; imm16 = unsigned label.
+   * The long operation updates st->pc itself.
+   */
+
+  OPCODE(oLONGOP24)
+    SPILL();
+    st->pc = ip->pc;
+    ret    = libexec_LongOperation24(st, (enum longOp24_e)IMM8, IMM16);
+    ip     = PCTOINSN(st->pc);
+    RELOAD();
+    CHECK(ret);
+    DISPATCH();
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+  /** SUPERINSTRUCTIONS *****************************************************/
+
+  /* Each of these is equivalent to executing the sequence of instructions
+   * that begins at 'ip'.  See libexec_predecode.c.
+   */
+
+  OPCODE(xLD_PUSHB_SLL)
+    uparm1 = spb + IMM16;
+    sparm1 = signExtend8(ip[1].imm8);
+    RPUSH((ustack_t)(((sstack_t)RGET(uparm1)) << sparm1));
+    SKIP(3);
+
+  OPCODE(xLD_INC_ST)
+    uparm1 = spb + IMM16;
+    uparm2 = spb + ip[2].imm16;
+    RPUT(RGET(uparm1) + 1, uparm2);
+    SKIP(3);
+
+  OPCODE(xLD_PUSHB)
+    uparm1 = spb + IMM16;
+    RPUSH(RGET(uparm1));
+    RPUSH(signExtend8(ip[1].imm8));
+    SKIP(2);
+
+  OPCODE(xPUSHB_SLL)
+    sparm1     = signExtend8(IMM8);
+    SETTOP((ustack_t)(((sstack_t)tos) << sparm1));
+    SKIP(2);
+
+  OPCODE(xST_LD)
+    uparm1 = spb + IMM16;
+    RPOP(uparm2);
+    RPUT(uparm2, uparm1);
+    uparm1 = spb + ip[1].imm16;
+    RPUSH(RGET(uparm1));
+    SKIP(2);
+
+  OPCODE(xLD_LD)
+    uparm1 = spb + IMM16;
+    RPUSH(RGET(uparm1));
+    uparm1 = spb + ip[1].imm16;
+    RPUSH(RGET(uparm1));
+    SKIP(2);
+
+  OPCODE(xADD_ST)
+    RPOP(sparm1);
+    RPOP(sparm2);
+    uparm1 = spb + ip[1].imm16;
+    RPUT((ustack_t)(sparm2 + sparm1), uparm1);
+    SKIP(2);
+
+  OPCODE(xINC_ST)
+    uparm1 = spb + ip[1].imm16;
+    RPOP(uparm2);
+    RPUT(uparm2 + 1, uparm1);
+    SKIP(2);
+
+  OPCODE(xPUSHB_LDXM)
+    uparm1  = signExtend8(IMM8); /* Size */
+    RPOP(uparm2);                /* Index */
+    uparm2 += spb + ip[1].imm16;
+    LOADMULTIPLE(uparm1, uparm2);
+    SKIP(2);
+
+  OPCODE(xPUSHB_STXM)
+    uparm1 = signExtend8(IMM8);  /* Size */
+    uparm3 = uparm1;             /* Save for stack discard */
+    sparm1 = ROUNDBTOI(uparm1);  /* Size in 16-bit words */
+    uparm2 = RTOS(sparm1);    /* index */
+    sparm1--;
+    uparm2 += spb + ip[1].imm16;
+    STOREMULTIPLE(uparm1, uparm2, sparm1);
+
+    /* Discard the stored data + the index */
+
+    RDISCARD((ROUNDBTOI(uparm3) + 1));
+    SKIP(2);
+
+  OPCODE(xLDS_LDS)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    RPUSH(RGET(uparm1));
+    uparm1 = BASEADDRESS(ip[1].imm8, signExtend16(ip[1].imm16));
+    RPUSH(RGET(uparm1));
+    SKIP(2);
+
+  OPCODE(xLDS_LDI)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    uparm1 = RGET(uparm1);
+    RPUSH(RGET(uparm1));
+    SKIP(2);
+
+  OPCODE(xLA_SETIN)
+    uparm1 = spb + IMM16;
+    SETMEMBER(uparm1, ip[1].imm8);
+    SKIP(2);
+
+  OPCODE(xLAS_SETIN)
+    uparm1 = BASEADDRESS(IMM8, signExtend16(IMM16));
+    SETMEMBER(uparm1, ip[1].imm8);
+    SKIP(2);
+
+  /* Compare with a constant and branch */
+
+  OPCODE(xPUSHB_JEQU)
+    CMPJUMP(signExtend8(IMM8), ==);
+
+  OPCODE(xPUSHB_JNEQ)
+    CMPJUMP(signExtend8(IMM8), !=);
+
+  OPCODE(xPUSHB_JLT)
+    CMPJUMP(signExtend8(IMM8), <);
+
+  OPCODE(xPUSHB_JGTE)
+    CMPJUMP(signExtend8(IMM8), >=);
+
+  OPCODE(xPUSHB_JGT)
+    CMPJUMP(signExtend8(IMM8), >);
+
+  OPCODE(xPUSHB_JLTE)
+    CMPJUMP(signExtend8(IMM8), <=);
+
+  OPCODE(xPUSH_JEQU)
+    CMPJUMP((sstack_t)IMM16, ==);
+
+  OPCODE(xPUSH_JNEQ)
+    CMPJUMP((sstack_t)IMM16, !=);
+
+  OPCODE(xPUSH_JLT)
+    CMPJUMP((sstack_t)IMM16, <);
+
+  OPCODE(xPUSH_JGTE)
+    CMPJUMP((sstack_t)IMM16, >=);
+
+  OPCODE(xPUSH_JGT)
+    CMPJUMP((sstack_t)IMM16, >);
+
+  OPCODE(xPUSH_JLTE)
+    CMPJUMP((sstack_t)IMM16, <=);
+#endif
+
+  /* Execution left I-Space */
+
+  OPCODE(xBADPC)
+    ret = eBADPC;
+    goto errout;
+
+  /* Pseudo-operations and unassigned opcodes */
+
+  ILLEGAL_OPCODE
+    ret = eILLEGALOPCODE;
+    goto errout;
+
+  END_DISPATCH
+
+budget_out:
+  ret = eNOERROR;
+
+  /* The instruction that found the budget used up was not executed */
+
+  budget++;
+
+errout:
+  SPILL();
+  st->pc         = ip->pc;
+  st->insnCount += start - budget;
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_Dispatch
+ *
+ * Description:
+ *   Execute P-Code until an exceptional condition is encountered or until
+ *   'maxInstructions' have been executed.
+ *
+ ****************************************************************************/
+
+int libexec_Dispatch(struct libexec_s *st, uint32_t maxInstructions)
+{
+  return libexec_ThreadedLoop(st, maxInstructions, NULL);
+}
+
+/****************************************************************************
+ * Name: libexec_DispatchTable
+ *
+ * Description:
+ *   Return the table of opcode handler addresses indexed by dispatch code,
+ *   or NULL if the dispatch loop is built as a switch statement.
+ *
+ ****************************************************************************/
+
+const void *const *libexec_DispatchTable(void)
+{
+  const void *const *table;
+
+  (void)libexec_ThreadedLoop(NULL, 0, &table);
+  return table;
+}
@@ -0,0 +1,288 @@
+/****************************************************************************
+ * libexec_format.c
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "libexec_format.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The largest precision handled by libexec_FormatReal.  10**22 is the
+ * largest power of ten that is exactly representable as a double.
+ */
+
+#define MAX_PRECISION 22
+
+/* Reals are formatted by scaling them to an integer.  The scaled value must
+ * be exactly representable.
+ */
+
+#define TWO_POW_53    9007199254740992.0
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const char g_digitPairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const double g_powersOfTen[MAX_PRECISION + 1] =
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_Digits32
+ *
+ * Description:
+ *   Generate the decimal digits of value, two at a time, into the memory
+ *   that ends at end.  Returns a pointer to the first digit.
+ *
+ ****************************************************************************/
+
+static char *libexec_Digits32(char *end, uint32_t value)
+{
+  while (value >= 100)
+    {
+      uint32_t pair = value % 100;
+
+      value /= 100;
+      end   -= 2;
+      memcpy(end, &g_digitPairs[2 * pair], 2);
+    }
+
+  if (value >= 10)
+    {
+      end -= 2;
+      memcpy(end, &g_digitPairs[2 * value], 2);
+    }
+  else
+    {
+      *--end = '0' + value;
+    }
+
+  return end;
+}
+
+/****************************************************************************
+ * Name: libexec_CopyNumber
+ *
+ * Description:
+ *   Copy the formatted number that starts at ptr and ends at end into
+ *   buffer and NUL terminate it.  Returns the length of the number.
+ *
+ ****************************************************************************/
+
+static int libexec_CopyNumber(char *buffer, const char *ptr,
+                              const char *end)
+{
+  int len = end - ptr;
+
+  memcpy(buffer, ptr, len);
+  buffer[len] = '\0';
+  return len;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_FormatSigned and libexec_FormatUnsigned
+ *
+ * Description:
+ *   Format a 16- or 32-bit integer in decimal into buffer, which must hold
+ *   at least FORMAT_NUMSIZE bytes.  The result is the same as printf's %d
+ *   or %u with no field width.  Returns the length of the number.
+ *
+ ****************************************************************************/
+
+int libexec_FormatSigned(char *buffer, int32_t value)
+{
+  char digits[FORMAT_NUMSIZE];
+  char *end = &digits[FORMAT_NUMSIZE];
+  char *ptr;
+
+  if (value < 0)
+    {
+      ptr    = libexec_Digits32(end, -(uint32_t)value);
+      *--ptr = '-';
+    }
+  else
+    {
+      ptr    = libexec_Digits32(end, (uint32_t)value);
+    }
+
+  return libexec_CopyNumber(buffer, ptr, end);
+}
+
+int libexec_FormatUnsigned(char *buffer, uint32_t value)
+{
+  char digits[FORMAT_NUMSIZE];
+  char *end = &digits[FORMAT_NUMSIZE];
+
+  return libexec_CopyNumber(buffer, libexec_Digits32(end, value), end);
+}
+
+/****************************************************************************
+ * Name: libexec_FormatReal
+ *
+ * Description:
+ *   Format a real in fixed point notation into buffer, which must hold at
+ *   least FORMAT_NUMSIZE bytes.  The precision is used only if a field
+ *   width is also provided;  otherwise six decimal places are produced.
+ *   The result is the same as printf's %.<precision>f:  The value is
+ *   scaled to an integer and the exact product is rounded to nearest with
+ *   ties to even.
+ *
+ * Returned Value:
+ *   The length of the number or -1 if the value is too large, not finite,
+ *   or requires more than MAX_PRECISION decimal places.  The caller must
+ *   then fall back to printf.
+ *
+ ****************************************************************************/
+
+int libexec_FormatReal(char *buffer, double value, uint8_t fieldWidth,
+                       uint8_t precision)
+{
+  char digits[FORMAT_NUMSIZE];
+  char *end = &digits[FORMAT_NUMSIZE];
+  char *ptr = end;
+  double scale;
+  double scaled;
+  double whole;
+  double fraction;
+  double error;
+  uint64_t number;
+  bool negative;
+  int i;
+
+  if (fieldWidth == 0 || precision == 0)
+    {
+      precision = 6;
+    }
+
+  if (precision > MAX_PRECISION)
+    {
+      return -1;
+    }
+
+  /* printf reports the sign of negative zero and of negative values that
+   * round to zero.
+   */
+
+  negative = (signbit(value) != 0);
+  if (negative)
+    {
+      value = -value;
+    }
+
+  /* This also rejects NaNs */
+
+  scale  = g_powersOfTen[precision];
+  scaled = value * scale;
+  if (!(scaled < TWO_POW_53))
+    {
+      return -1;
+    }
+
+  /* The exact product value * scale is whole + fraction + error where
+   * fraction is in [0, 1) and error is the (tiny) rounding error of the
+   * multiplication.  All three parts are exact.
+   */
+
+  error    = fma(value, scale, -scaled);
+  whole    = floor(scaled);
+  fraction = scaled - whole;
+  number   = (uint64_t)whole;
+
+  if (fraction - 0.5 > -error ||
+      (fraction - 0.5 == -error && (number & 1) != 0))
+    {
+      number++;
+    }
+
+  /* Generate the decimal places, the decimal point, and then at least one
+   * digit of the integer part.
+   */
+
+  for (i = 0; i < precision; i++)
+    {
+      *--ptr  = '0' + (int)(number % 10);
+      number /= 10;
+    }
+
+  if (precision > 0)
+    {
+      *--ptr = '.';
+    }
+
+  do
+    {
+      *--ptr  = '0' + (int)(number % 10);
+      number /= 10;
+    }
+  while (number > 0);
+
+  if (negative)
+    {
+      *--ptr = '-';
+    }
+
+  return libexec_CopyNumber(buffer, ptr, end);
+}
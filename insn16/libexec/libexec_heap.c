@@ -39,6 +39,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 #include <string.h>
 #include <errno.h>
@@ -46,6 +48,7 @@
 #include "pas_debug.h"
 #include "pas_errcodes.h"
 #include "pas_error.h"
+#include "execlib.h"
 
 #include "libexec.h"
 #include "libexec_heap.h"
@@ -54,14 +57,58 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-/* Alignment helpers */
+/* Alignment helpers.  An allocation unit is the size of a chunk header. */
 
-#define HEAP_ALIGN_SHIFT  (4)
+#define HEAP_ALIGN_SHIFT  (3)
 #define HEAP_ALLOC_UNIT   (1 << HEAP_ALIGN_SHIFT)
 #define HEAP_ALIGN_MASK   (HEAP_ALLOC_UNIT - 1)
 #define HEAP_ALIGNUP(a)   (((a) + HEAP_ALIGN_MASK) & ~HEAP_ALIGN_MASK)
 #define HEAP_ALIGNDOWN(a) ((a) & ~HEAP_ALIGN_MASK)
 
+/* Size classes.  Every chunk size is a multiple of HEAP_ALLOC_UNIT and is
+ * at least HEAP_MIN_CHUNK, so that it can hold a free chunk header.  Free
+ * chunks of up to HEAP_NEXACT allocation units (256 bytes) are kept in one
+ * free list per size so that the common small allocations are satisfied
+ * from the head of a list without any search.  Larger free chunks are kept
+ * in one list for each power of two number of allocation units.
+ */
+
+#define HEAP_EXACT_SHIFT  (5)
+#define HEAP_NEXACT       (1 << HEAP_EXACT_SHIFT)
+#define HEAP_MIN_CHUNK    sizeof(freeChunk_t)
+
+/* The largest chunk that can be described by the 15-bit forward offset */
+
+#define HEAP_MAX_CHUNK    HEAP_ALIGNDOWN(0x7fff)
+
+/* Terminates a free list.  Heap offset zero is a valid chunk address. */
+
+#define HEAP_NO_CHUNK     (0xffff)
+
+/* Temporary string arena.  The arena occupies the top of the heap region
+ * and holds up to HEAP_ARENA_DEPTH default-sized string buffers, but never
+ * more than 1/HEAP_ARENA_FRACTION of the heap.  The heap takes over the
+ * arena if it runs out of memory while the arena is empty.
+ */
+
+#define HEAP_ARENA_DEPTH     (8)
+#define HEAP_ARENA_FRACTION  (4)
+#define HEAP_ARENA_BLOCK(n)  (sizeof(arenaBlock_t) + INT_ALIGNUP(n))
+#define HEAP_ARENA_SIZE      HEAP_ALIGNUP(HEAP_ARENA_DEPTH * \
+                               HEAP_ARENA_BLOCK(STRING_BUFFER_SIZE))
+
+/* Kinds of allocations recorded by the heap profiler.  The kind of a heap
+ * chunk is kept in the kind field of its header.
+ */
+
+#define HEAP_KIND_NEW        (0)  /* NEW() */
+#define HEAP_KIND_STRING     (1)  /* Temporary string */
+
+/* Return the free chunk at a heap offset */
+
+#define HEAP_CHUNK(st, heapStart, offset) \
+  ((freeChunk_t *)ATSTACK(st, (heapStart) + (offset)))
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -81,6 +128,8 @@ static void libexec_MemInfo(struct libexec_s *st, const char *msg,
 #else
 #  define libexec_MemInfo(st, msg, size)
 #endif
+static inline unsigned int libexec_SizeClass(uint16_t chunkSize);
+static inline unsigned int libexec_FirstSizeClass(uint64_t freeMap);
 static void libexec_AddChunkToFreeList(struct libexec_s *st,
              freeChunk_t *newChunk);
 static void libexec_RemoveChunkFromFreeList(struct libexec_s *st,
@@ -88,6 +137,17 @@ static void libexec_RemoveChunkFromFreeList(struct libexec_s *st,
 static void libexec_DisposeChunk(struct libexec_s *st, freeChunk_t *newChunk);
 static uint16_t libexec_Alloc(struct libexec_s *st, uint16_t allocSize);
 static int libexec_Free(struct libexec_s *st, uint16_t address);
+static uint16_t libexec_ArenaAlloc(struct libexec_s *st, uint16_t allocSize);
+static int libexec_ArenaFree(struct libexec_s *st, uint16_t address);
+static bool libexec_ReleaseArena(struct libexec_s *st);
+#ifdef CONFIG_PASCAL_PROFILER
+static void libexec_ProfileAlloc(struct libexec_s *st, uint16_t address,
+              uint16_t reqSize, uint8_t kind);
+static void libexec_ProfileFree(struct libexec_s *st, memChunk_t *chunk);
+#else
+#  define libexec_ProfileAlloc(st, address, reqSize, kind)
+#  define libexec_ProfileFree(st, chunk)
+#endif
 
 /****************************************************************************
  * Private Type Definitions
@@ -101,10 +161,10 @@ struct memChunk_s
   uint16_t inUse   : 1;  /* true:  This chunk is in-use */
 
   uint16_t back    : 15; /* Offset from this chunk to the previous chunk */
-  uint16_t pad1    : 1;  /* Available for future use */
+  uint16_t kind    : 1;  /* Heap profiler:  HEAP_KIND_* of this chunk */
 
   uint16_t address;      /* Heap base stack address of this chunk */
-  uint16_t pad2;         /* Available for future use */
+  uint16_t allocPc;      /* Heap profiler:  PC that allocated this chunk */
 };
 
 typedef struct memChunk_s memChunk_t;
@@ -121,6 +181,60 @@ struct freeChunk_s
 
 typedef struct freeChunk_s freeChunk_t;
 
+/* This structure precedes each temporary string buffer in the arena */
+
+struct arenaBlock_s
+{
+  uint16_t prev;         /* D-Space address of the previous block */
+  uint16_t inUse;        /* Non-zero:  This block has not been freed */
+  uint16_t pc;           /* Allocating instruction (heap profiler only) */
+};
+
+typedef struct arenaBlock_s arenaBlock_t;
+
+#ifdef CONFIG_PASCAL_PROFILER
+/* The heap allocations made by one instruction, or the chunks left in use
+ * at exit by one instruction.
+ */
+
+struct libexec_heapSite_s
+{
+  uint32_t count;        /* Number of allocations */
+  uint32_t bytes;        /* Bytes requested */
+  uint8_t  kind;         /* HEAP_KIND_NEW or HEAP_KIND_STRING */
+};
+
+/* The allocations of one source line, for reporting */
+
+struct libexec_heapLine_s
+{
+  const char *fileName;  /* Source file (NULL if unknown) */
+  uint32_t    lineno;    /* Source line (or PC if the file is unknown) */
+  uint32_t    count;     /* Number of allocations */
+  uint32_t    bytes;     /* Bytes requested */
+  uint8_t     kind;      /* HEAP_KIND_NEW or HEAP_KIND_STRING */
+};
+
+/* The state of the heap profiler.  Heap byte counts include the chunk
+ * headers.
+ */
+
+struct libexec_heapProfile_s
+{
+  struct libexec_heapSite_s *sites;
+                         /* Allocations indexed by PC (maxpc + 1 entries) */
+  uint32_t nallocs;      /* Successful heap allocations */
+  uint32_t nfrees;       /* Heap chunks freed */
+  uint32_t nfailed;      /* Allocations that failed */
+  uint32_t arenaAllocs;  /* Temporary strings allocated from the arena */
+  uint32_t liveBytes;    /* Heap bytes in use now */
+  uint32_t peakBytes;    /* Largest value of liveBytes */
+  uint16_t highWater;    /* Highest heap offset ever in use */
+  uint16_t arenaPeak;    /* Most arena bytes in use at once */
+  uint16_t maxFailed;    /* Largest failed request */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -131,32 +245,31 @@ typedef struct freeChunk_s freeChunk_t;
 static void libexec_DumpFreeList(struct libexec_s *st, const char *msg,
                                  freeChunk_t *newChunk)
 {
-  freeChunk_t *freeChunk;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
-  unsigned int chunkNo = 1;
-
-  /* Search the ordered free list for the smallest free chunk that is big
-   * enough for this allocation.
-   */
-
-  freeChunk = st->freeChunks;
+  unsigned int sizeClass;
 
   printf("%s: address=%04x\n", msg, newChunk->chunk.address);
-  printf("FREE LIST:\n");
-  while (freeChunk != NULL)
+  printf("FREE LISTS:\n");
+
+  for (sizeClass = 0; sizeClass < HEAP_NBINS; sizeClass++)
     {
-      printf("%4u: address=%04x forward=%04x back=%04x inuse=%u\n",
-             chunkNo, freeChunk->chunk.address, freeChunk->chunk.forward,
-             freeChunk->chunk.back, freeChunk->chunk.inUse);
-      printf("      prev=%04x next=%04x\n", freeChunk->prev, freeChunk->next);
+      uint16_t offset = st->freeList[sizeClass];
+      unsigned int chunkNo = 1;
 
-      if (freeChunk->next == 0)
+      while (offset != HEAP_NO_CHUNK)
         {
-          break;
-        }
+          freeChunk_t *freeChunk = HEAP_CHUNK(st, heapStart, offset);
 
-      freeChunk = (freeChunk_t *)ATSTACK(st, heapStart + freeChunk->next);
-      chunkNo++;
+          printf("%2u/%-4u: address=%04x forward=%04x back=%04x inuse=%u\n",
+                 sizeClass, chunkNo, freeChunk->chunk.address,
+                 freeChunk->chunk.forward, freeChunk->chunk.back,
+                 freeChunk->chunk.inUse);
+          printf("         prev=%04x next=%04x\n",
+                 freeChunk->prev, freeChunk->next);
+
+          offset = freeChunk->next;
+          chunkNo++;
+        }
     }
 }
 #endif
@@ -169,7 +282,7 @@ static void libexec_DumpHeap(struct libexec_s *st, const char *msg,
 {
   memChunk_t *chunk;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
-  uint16_t heapEnd   = HEAP_ALIGNDOWN(heapStart + st->hpSize);
+  uint16_t heapEnd   = st->arenaBase;
   uint16_t chunkAddr = heapStart;
   unsigned int chunkNo = 1;
 
@@ -216,149 +329,130 @@ static void libexec_DumpHeap(struct libexec_s *st, const char *msg,
 static void libexec_MemInfo(struct libexec_s *st, const char *msg,
               uint16_t size)
 {
-  freeChunk_t *freeChunk;
   uint32_t totalFreeMemory;
   uint16_t largestChunkSize;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
-  uint16_t heapEnd   = HEAP_ALIGNDOWN(heapStart + st->hpSize);
+  uint16_t heapEnd   = st->arenaBase;
   unsigned int numFreeChunks;
+  unsigned int sizeClass;
 
-  /* Traverse the ordered free list collecting statistics. */
+  /* Traverse each of the free lists collecting statistics. */
 
-  freeChunk        = st->freeChunks;
   totalFreeMemory  = 0;
   largestChunkSize = 0;
   numFreeChunks    = 0;
 
-  while (freeChunk != NULL)
+  for (sizeClass = 0; sizeClass < HEAP_NBINS; sizeClass++)
     {
-      uint16_t chunkSize = freeChunk->chunk.forward;
+      uint16_t offset = st->freeList[sizeClass];
 
-      /* Update statistics */
-
-      totalFreeMemory += chunkSize;
-
-      if (chunkSize > largestChunkSize)
+      while (offset != HEAP_NO_CHUNK)
         {
-          largestChunkSize = chunkSize;
-        }
+          freeChunk_t *freeChunk = HEAP_CHUNK(st, heapStart, offset);
+          uint16_t chunkSize     = freeChunk->chunk.forward;
 
-      numFreeChunks++;
+          /* Update statistics */
 
-      /* The final free chunk should have next == 0 */
+          totalFreeMemory += chunkSize;
 
-      if (freeChunk->next == 0)
-        {
-          break;
-        }
+          if (chunkSize > largestChunkSize)
+            {
+              largestChunkSize = chunkSize;
+            }
 
-      freeChunk = (freeChunk_t *)ATSTACK(st, heapStart + freeChunk->next);
+          numFreeChunks++;
+          offset = freeChunk->next;
+        }
     }
 
   if (size > 0)
     {
-      printf("%s (size: %" PRIu16 "):\n", msg, size);
+      fprintf(st->output, "%s (size: %" PRIu16 "):\n", msg, size);
     }
   else
     {
-      printf("%s:\n", msg);
+      fprintf(st->output, "%s:\n", msg);
     }
 
-  printf("  Heap size: %" PRIu16 " Free memory: %" PRIu32 "\n",
+  fprintf(st->output, "  Heap size: %" PRIu16 " Free memory: %" PRIu32 "\n",
           heapEnd - heapStart, totalFreeMemory);
-  printf("  Number free chunks: %" PRIu16 " Largest free chunk: %" PRIu16 "\n",
+  fprintf(st->output,
+          "  Number free chunks: %" PRIu16 " Largest free chunk: %" PRIu16 "\n",
           numFreeChunks, largestChunkSize);
 }
 #endif
 
 /****************************************************************************/
 
-static void libexec_AddChunkToFreeList(struct libexec_s *st,
-                                       freeChunk_t *newChunk)
-{
-  freeChunk_t *prevChunk;
-  freeChunk_t *freeChunk;
-  uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
+/* Return the size class of a chunk of 'chunkSize' bytes (a non-zero multiple
+ * of HEAP_ALLOC_UNIT).  Classes 0 through HEAP_NEXACT - 1 hold chunks of
+ * exactly 1 through HEAP_NEXACT allocation units; each class above that
+ * holds chunks of 2**n through 2**(n+1) - 1 allocation units.
+ */
 
-  /* Find the location to insert the free chunk in the ordered list */
-
-  prevChunk = NULL;
-  freeChunk = st->freeChunks;
+static inline unsigned int libexec_SizeClass(uint16_t chunkSize)
+{
+  unsigned int units = chunkSize >> HEAP_ALIGN_SHIFT;
+  unsigned int log2;
 
-  while (freeChunk != NULL)
+  if (units <= HEAP_NEXACT)
     {
-      freeChunk_t *nextChunk;
+      return units - 1;
+    }
 
-      /* Get a pointer to the next free chunk */
+  for (log2 = HEAP_EXACT_SHIFT; (units >> (log2 + 1)) != 0; log2++);
+  return HEAP_NEXACT + log2 - HEAP_EXACT_SHIFT;
+}
 
-      if (freeChunk->next == 0)
-        {
-          nextChunk = NULL;
-        }
-      else
-        {
-          uint16_t nextAddr = heapStart + freeChunk->next;
-          nextChunk         = (freeChunk_t *)ATSTACK(st, nextAddr);
-        }
+/****************************************************************************/
 
-      /* Is this chunk larger than the one are are inserting? */
+/* Return the lowest size class set in a non-zero free list bit map */
 
-      if (freeChunk->chunk.forward >= newChunk->chunk.forward)
-        {
-          /* Found it!  the previous chunk is smaller than this one (or is
-           * the head of the list) and the following free chunk is larger (if.
-           * there is one).  So it belongs in between.
-           */
+static inline unsigned int libexec_FirstSizeClass(uint64_t freeMap)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(freeMap);
+#else
+  unsigned int sizeClass = 0;
 
-          /* Add the new chunk to the free list */
+  while ((freeMap & 1) == 0)
+    {
+      freeMap >>= 1;
+      sizeClass++;
+    }
 
-          if (prevChunk == NULL)
-            {
-              newChunk->prev  = 0;
-              newChunk->next  = freeChunk->chunk.address;
-              freeChunk->prev = newChunk->chunk.address;
-              st->freeChunks  = newChunk;
-            }
-          else if (nextChunk != NULL)
-            {
-              newChunk->prev  = prevChunk->chunk.address;
-              newChunk->next  = nextChunk->chunk.address;
-              nextChunk->prev = newChunk->chunk.address;
-              prevChunk->next = newChunk->chunk.address;
-            }
-          else
-            {
-              newChunk->prev  = prevChunk->chunk.address;
-              newChunk->next  = 0;
-              prevChunk->next = newChunk->chunk.address;
-            }
+  return sizeClass;
+#endif
+}
 
-          libexec_DumpFreeList(st, "Added Free Chunk",
-                               newChunk);
-          return;
-        }
+/****************************************************************************/
+
+static void libexec_AddChunkToFreeList(struct libexec_s *st,
+                                       freeChunk_t *newChunk)
+{
+  uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
+  unsigned int sizeClass;
+  uint16_t head;
 
-      /* Set up for the next time through the loop */
+  /* Push the chunk onto the head of the free list for its size class.
+   * Reusing the most recently freed chunk first keeps the working set of
+   * the heap small.
+   */
 
-      prevChunk = freeChunk;
-      freeChunk = nextChunk;
-    }
+  sizeClass      = libexec_SizeClass(newChunk->chunk.forward);
+  head           = st->freeList[sizeClass];
 
-  /* We get here if the free chunk belongs at the end of the list */
+  newChunk->prev = HEAP_NO_CHUNK;
+  newChunk->next = head;
 
-  if (prevChunk == NULL)
+  if (head != HEAP_NO_CHUNK)
     {
-      newChunk->prev  = 0;
-      newChunk->next  = 0;
-      st->freeChunks  = newChunk;
-    }
-  else
-    {
-      newChunk->prev  = prevChunk->chunk.address;
-      newChunk->next  = 0;
-      prevChunk->next = newChunk->chunk.address;
+      HEAP_CHUNK(st, heapStart, head)->prev = newChunk->chunk.address;
     }
 
+  st->freeList[sizeClass] = newChunk->chunk.address;
+  st->freeMap            |= (uint64_t)1 << sizeClass;
+
   libexec_DumpFreeList(st, "Added Free Chunk", newChunk);
 }
 
@@ -369,76 +463,33 @@ static void libexec_RemoveChunkFromFreeList(struct libexec_s *st,
 {
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
 
-  /* Check if this is the only chunk in the list */
+  /* Link the chunk before this one to the chunk after this one.  If this is
+   * the first chunk in the list, then the chunk after this one becomes the
+   * head of the list.
+   */
 
-  if (freeChunk->prev == 0 && freeChunk->next == 0)
+  if (freeChunk->prev != HEAP_NO_CHUNK)
     {
-      /* This is the only chunk in the free list */
-
-      st->freeChunks = NULL;
+      HEAP_CHUNK(st, heapStart, freeChunk->prev)->next = freeChunk->next;
     }
   else
     {
-      /* There are multiple chunks in the free list */
-
-      freeChunk_t *prevChunk;
-      freeChunk_t *nextChunk;
-      uint16_t prevAddr;
-      uint16_t nextAddr;
-
-      /* Check if this is the first chunk in the free list */
-
-      if (freeChunk->prev == 0)
-        {
-          /* Set the chunk after this one to the new first chunk.  Since the
-           * the list is not empty, we kno that there is a chunk after this
-           * one.
-           */
+      unsigned int sizeClass = libexec_SizeClass(freeChunk->chunk.forward);
 
-          nextAddr             = heapStart + freeChunk->next;
-          st->freeChunks       = (freeChunk_t *)ATSTACK(st, nextAddr);
-          st->freeChunks->prev = 0;
-        }
-      else
+      st->freeList[sizeClass] = freeChunk->next;
+      if (freeChunk->next == HEAP_NO_CHUNK)
         {
-          /* Link the chunk before this one to the chunk after this one
-           * (if there is one)
-           */
-
-          prevAddr             = heapStart + freeChunk->prev;
-          prevChunk            = (freeChunk_t *)ATSTACK(st, prevAddr);
-          prevChunk->next      = freeChunk->next;
+          st->freeMap &= ~((uint64_t)1 << sizeClass);
         }
+    }
 
-      /* Check if this is the last chunk in the free list */
-
-      if (freeChunk->next == 0)
-        {
-          /* Make the previous chunk the end of the list.  Since the
-           * the list is not empty, we kno that there is a chunk after this
-           * one.
-           */
-
-          prevAddr             = heapStart + freeChunk->prev;
-          prevChunk            = (freeChunk_t *)ATSTACK(st, prevAddr);
-          prevChunk->next      = 0;
-        }
-      else if (freeChunk->prev == 0)
-        {
-          /* There is a chunk after this one, but not one before.
-           * This case was already handled above.
-           */
-        }
-      else
-        {
-          /* There are chunks both before and after this one.  Link the chunk
-           * after this one to the chunk before this one.
-           */
+  /* Link the chunk after this one (if there is one) back to the chunk
+   * before this one.
+   */
 
-          nextAddr             = heapStart + freeChunk->next;
-          nextChunk            = (freeChunk_t *)ATSTACK(st, nextAddr);
-          nextChunk->prev      = freeChunk->prev;
-        }
+  if (freeChunk->next != HEAP_NO_CHUNK)
+    {
+      HEAP_CHUNK(st, heapStart, freeChunk->next)->prev = freeChunk->prev;
     }
 
   libexec_DumpFreeList(st, "Removed Free Chunk", freeChunk);
@@ -448,121 +499,59 @@ static void libexec_RemoveChunkFromFreeList(struct libexec_s *st,
 
 static void libexec_DisposeChunk(struct libexec_s *st, freeChunk_t *newChunk)
 {
-  freeChunk_t *prevChunk = NULL;
-  freeChunk_t *nextChunk = NULL;
-  uint16_t addr;
+  freeChunk_t *nextChunk;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
-  bool merged = false;
 
   /* This chunk is no longer in use */
 
   newChunk->chunk.inUse = 0;
 
-  /* Get the memory chunks after the newly freed one */
-
-  if (newChunk->chunk.forward != 0)
-    {
-      addr      = heapStart + newChunk->chunk.address +
-                  newChunk->chunk.forward;
-      nextChunk = (freeChunk_t *)ATSTACK(st, addr);
-    }
-
-  /* Check if we can merge the new free chunk with the preceding chunk. */
+  /* Check if we can merge the new free chunk with the preceding chunk.  Only
+   * the first chunk in the heap has no preceding chunk.
+   */
 
   if (newChunk->chunk.back != 0)
     {
-      /* Get the memory chunks before the newly freed one */
-
-      addr      = heapStart + newChunk->chunk.address -
-                  newChunk->chunk.back;
-      prevChunk = (freeChunk_t *)ATSTACK(st, addr);
-
-      /* Is the previous chunk inUse? */
+      freeChunk_t *prevChunk =
+        HEAP_CHUNK(st, heapStart,
+                   newChunk->chunk.address - newChunk->chunk.back);
 
       if (!prevChunk->chunk.inUse)
         {
-          /* No, then merge the newChunk into it.  First, remove it
-           * from the free list.
+          /* Merge the new chunk into the preceding free chunk.  The size of
+           * the preceding chunk changes, so it must be removed from its
+           * free list first.
            */
 
           libexec_RemoveChunkFromFreeList(st, prevChunk);
-
-          prevChunk->chunk.forward  += newChunk->chunk.forward;
-          if (nextChunk != NULL)
-            {
-              nextChunk->chunk.back += newChunk->chunk.back;
-            }
-
-          /* Then put the larger chunk back into the free list. */
-
-          libexec_AddChunkToFreeList(st, prevChunk);
-          newChunk                   = prevChunk;
-          prevChunk                  = NULL;
-          merged                     = true;
+          prevChunk->chunk.forward += newChunk->chunk.forward;
+          newChunk                  = prevChunk;
         }
     }
 
-  /* Check if we can merge the new free chunk with the following chunk. */
-
-  if (nextChunk != NULL)
-    {
-      /* Get the memory chunk after the next one */
-
-      /* Is the next chunk inUse? */
-
-      if (!nextChunk->chunk.inUse)
-        {
-          /* No, then merge it into the newChunk.  First, remove the
-           * nextChunk from the free list.
-           */
-
-          libexec_RemoveChunkFromFreeList(st, nextChunk);
-
-          /* If the newChunk was merged and added to the free list (above)
-           * then we will have to take it back out of the free list
-           */
-
-          if (merged)
-            {
-              libexec_RemoveChunkFromFreeList(st, newChunk);
-            }
-
-          /* Then merge the nextChunk into the newChunk */
-
-          newChunk->chunk.forward += nextChunk->chunk.forward;
-
-          /* Is there a memory chunk after the next chunk */
-
-          if (nextChunk->chunk.forward != 0)
-            {
-              freeChunk_t *afterThat = NULL;
-
-              /* Yes, get the memory chunk after the next chunk */
-
-              addr      = heapStart + nextChunk->chunk.address +
-                          nextChunk->chunk.forward;
-              afterThat = (freeChunk_t *)ATSTACK(st, addr);
-
-              /* And adjust its back pointer */
-
-              afterThat->chunk.back += newChunk->chunk.back;
-            }
+  /* Check if we can merge the new free chunk with the following chunk.
+   * There is always a following chunk:  The terminus chunk at the end of
+   * the heap is never free.
+   */
 
-          /* Then put the merged chunk back into the free list. */
+  nextChunk = HEAP_CHUNK(st, heapStart,
+                         newChunk->chunk.address + newChunk->chunk.forward);
 
-          libexec_AddChunkToFreeList(st, newChunk);
-          merged        = true;
-        }
+  if (!nextChunk->chunk.inUse)
+    {
+      libexec_RemoveChunkFromFreeList(st, nextChunk);
+      newChunk->chunk.forward += nextChunk->chunk.forward;
+      nextChunk = HEAP_CHUNK(st, heapStart,
+                             newChunk->chunk.address +
+                             newChunk->chunk.forward);
     }
 
-  /* If the new chunk was not merged, then insert the newChunk into the free
-   * list.
+  /* Then fix up the back offset of the chunk that now follows the merged
+   * chunk and put the merged chunk into the free list.
    */
 
-  if (!merged)
-    {
-      libexec_AddChunkToFreeList(st, newChunk);
-    }
+  nextChunk->chunk.back = newChunk->chunk.forward;
+  libexec_AddChunkToFreeList(st, newChunk);
 }
 
 /****************************************************************************/
@@ -571,91 +560,115 @@ static uint16_t libexec_Alloc(struct libexec_s *st, uint16_t allocSize)
 {
   freeChunk_t *freeChunk;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
-  uint16_t allocChunkSize;
+  uint32_t allocChunkSize;
+  unsigned int sizeClass;
+  uint16_t offset;
+  uint64_t largerMap;
 
-  /* Search the ordered free list for the smallest free chunk that is big
-   * enough for this allocation.
+  /* Get the size of the chunk needed to hold the allocation plus its
+   * header.
    */
 
-  freeChunk      = st->freeChunks;
-  allocChunkSize = HEAP_ALIGNUP(allocSize) + sizeof(memChunk_t);
-
-  while (freeChunk != NULL)
+  allocChunkSize = HEAP_ALIGNUP((uint32_t)allocSize + sizeof(memChunk_t));
+  if (allocChunkSize < HEAP_MIN_CHUNK)
     {
-      freeChunk_t *nextChunk;
-      uint16_t freeChunkSize;
-
-      /* Get the size of this chunk (minus overhead when in-use) */
+      allocChunkSize = HEAP_MIN_CHUNK;
+    }
+  else if (allocChunkSize > HEAP_MAX_CHUNK)
+    {
+      goto errout;
+    }
 
-      freeChunkSize = freeChunk->chunk.forward;
+  sizeClass = libexec_SizeClass(allocChunkSize);
+  offset    = st->freeList[sizeClass];
 
-      /* Get a pointer to the next free chunk */
+  /* Every chunk in an exact size class is the requested size.  In the
+   * larger size classes, search the list for the first chunk that is big
+   * enough.
+   */
 
-      if (freeChunk->next == 0)
-        {
-          nextChunk = NULL;
-        }
-      else
+  if (sizeClass >= HEAP_NEXACT)
+    {
+      while (offset != HEAP_NO_CHUNK &&
+             HEAP_CHUNK(st, heapStart, offset)->chunk.forward <
+             allocChunkSize)
         {
-          uint16_t nextAddr = heapStart + freeChunk->next;
-          nextChunk = (freeChunk_t *)ATSTACK(st, nextAddr);
+          offset = HEAP_CHUNK(st, heapStart, offset)->next;
         }
+    }
 
-      /* Is it big enough to provide the requested allocation? */
+  /* Otherwise, any chunk in the smallest non-empty larger size class is big
+   * enough.
+   */
 
-      if (freeChunkSize >= allocChunkSize)
+  if (offset == HEAP_NO_CHUNK)
+    {
+      largerMap = st->freeMap & ~(((uint64_t)2 << sizeClass) - 1);
+      if (largerMap == 0)
         {
-          libexec_RemoveChunkFromFreeList(st, freeChunk);
-
-          /* Divide the chunk into an in-use chunk and an available sub-
-           * chunk if we did not need the whole thing.
+          /* Try again with the arena memory if no temporary strings are
+           * using it.
            */
 
-          freeChunk->chunk.inUse       = 1;
-
-          if (freeChunkSize > allocChunkSize + sizeof(freeChunk_t))
+          if (libexec_ReleaseArena(st))
             {
-              /* Break off "sub-chunk" for the new free chunk at offset
-               * "size"
-               */
-
-              freeChunk_t *subChunk    = (freeChunk_t *)
-                ATSTACK(st, heapStart + freeChunk->chunk.address +
-                        allocChunkSize);
-
-              subChunk->chunk.forward  = freeChunk->chunk.forward -
-                                         allocChunkSize;
-              subChunk->chunk.inUse    = 0;
-              subChunk->chunk.back     = allocChunkSize;
-              subChunk->chunk.pad1     = 0;
-              subChunk->chunk.address  = freeChunk->chunk.address +
-                                         allocChunkSize;
-              subChunk->chunk.pad2     = 0;
+              return libexec_Alloc(st, allocSize);
+            }
 
-              /* And shrink the original to the requested chunk size */
+          goto errout;
+        }
 
-              freeChunk->chunk.forward = allocChunkSize;
+      offset = st->freeList[libexec_FirstSizeClass(largerMap)];
+    }
 
-              /* Add the free sub-chunk that we broke off to the ordered free list */
+  freeChunk = HEAP_CHUNK(st, heapStart, offset);
+  libexec_RemoveChunkFromFreeList(st, freeChunk);
+  freeChunk->chunk.inUse = 1;
 
-              libexec_DisposeChunk(st, subChunk);
-            }
+  /* Divide the chunk into an in-use chunk and an available sub-chunk if we
+   * did not need the whole thing.  A remainder too small to hold a free
+   * chunk header stays with the allocation.
+   */
 
-          /* Generate debug output as configured */
+  if (freeChunk->chunk.forward >= allocChunkSize + HEAP_MIN_CHUNK)
+    {
+      freeChunk_t *subChunk;
+      memChunk_t  *afterThat;
+
+      subChunk                 = HEAP_CHUNK(st, heapStart,
+                                            offset + allocChunkSize);
+      subChunk->chunk.forward  = freeChunk->chunk.forward - allocChunkSize;
+      subChunk->chunk.inUse    = 0;
+      subChunk->chunk.back     = allocChunkSize;
+      subChunk->chunk.kind     = 0;
+      subChunk->chunk.address  = offset + allocChunkSize;
+      subChunk->chunk.allocPc  = 0;
+
+      /* The chunk after the original now follows the sub-chunk */
+
+      afterThat                = (memChunk_t *)
+        HEAP_CHUNK(st, heapStart,
+                   subChunk->chunk.address + subChunk->chunk.forward);
+      afterThat->back          = subChunk->chunk.forward;
+
+      /* Shrink the original to the requested chunk size and add the free
+       * sub-chunk that we broke off to its free list.
+       */
+
+      freeChunk->chunk.forward = allocChunkSize;
+      libexec_AddChunkToFreeList(st, subChunk);
+    }
 
-          libexec_DumpHeap(st, "After allocation",
-            heapStart + freeChunk->chunk.address);
-          libexec_MemInfo(st, "After allocation", allocSize);
+  /* Generate debug output as configured */
 
-          /* Return the address of the allocated memory */
+  libexec_DumpHeap(st, "After allocation", heapStart + offset);
+  libexec_MemInfo(st, "After allocation", allocSize);
 
-          return heapStart + freeChunk->chunk.address + sizeof(memChunk_t);
-        }
+  /* Return the address of the allocated memory */
 
-      /* Set up for the next time through the loop */
+  return heapStart + offset + sizeof(memChunk_t);
 
-      freeChunk = nextChunk;
-    }
+errout:
 
   /* Failed to allocate */
 
@@ -671,10 +684,13 @@ static int libexec_Free(struct libexec_s *st, uint16_t address)
   freeChunk_t *freeChunk;
   uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
 
-  /* Verify that the address being freed lies in the heap region */
+  /* Verify that the address being freed lies in the heap region and could
+   * be the address of an allocation.
+   */
 
   if (address < heapStart + sizeof(memChunk_t) ||
-      address >= (heapStart + st->hpSize - HEAP_ALLOC_UNIT))
+      address >= st->arenaBase - HEAP_ALLOC_UNIT ||
+      ((address - heapStart - sizeof(memChunk_t)) & HEAP_ALIGN_MASK) != 0)
     {
       return eHUH;
     }
@@ -698,9 +714,7 @@ static int libexec_Free(struct libexec_s *st, uint16_t address)
       uint16_t chunkSize = freeChunk->chunk.forward;
 #endif
 
-      freeChunk->next    = 0;
-      freeChunk->prev    = 0;
-
+      libexec_ProfileFree(st, &freeChunk->chunk);
       libexec_DisposeChunk(st, freeChunk);
 
       /* Output debug information as configured */
@@ -712,6 +726,323 @@ static int libexec_Free(struct libexec_s *st, uint16_t address)
     }
 }
 
+/****************************************************************************/
+
+/* Allocate a temporary string buffer from the top of the arena.  Returns
+ * zero if the arena is full.
+ */
+
+static uint16_t libexec_ArenaAlloc(struct libexec_s *st, uint16_t allocSize)
+{
+  arenaBlock_t *block;
+  uint16_t blockAddr = st->arenaTop;
+
+  if ((uint32_t)blockAddr + HEAP_ARENA_BLOCK(allocSize) >
+      (uint32_t)st->arenaEnd)
+    {
+      return 0;
+    }
+
+  block           = (arenaBlock_t *)ATSTACK(st, blockAddr);
+  block->prev     = st->arenaLast;
+  block->inUse    = 1;
+
+  st->arenaLast   = blockAddr;
+  st->arenaTop    = blockAddr + HEAP_ARENA_BLOCK(allocSize);
+
+  return blockAddr + sizeof(arenaBlock_t);
+}
+
+/****************************************************************************/
+
+/* Free a temporary string buffer in the arena.  Freeing the most recent
+ * allocation releases it and any earlier buffers that were freed out of
+ * order.  Other buffers are only marked free; their space is released when
+ * all of the buffers allocated after them have been freed.
+ */
+
+static int libexec_ArenaFree(struct libexec_s *st, uint16_t address)
+{
+  arenaBlock_t *block;
+
+  if (address < st->arenaBase + sizeof(arenaBlock_t))
+    {
+      return eHUH;
+    }
+
+  /* Buffers above the top of the arena have already been released */
+
+  if (address >= st->arenaTop)
+    {
+      return eDOUBLEFREE;
+    }
+
+  block = (arenaBlock_t *)ATSTACK(st, address - sizeof(arenaBlock_t));
+  if (!block->inUse)
+    {
+      return eDOUBLEFREE;
+    }
+
+  block->inUse = 0;
+
+  while (st->arenaLast != st->arenaEnd)
+    {
+      block = (arenaBlock_t *)ATSTACK(st, st->arenaLast);
+      if (block->inUse)
+        {
+          break;
+        }
+
+      st->arenaTop  = st->arenaLast;
+      st->arenaLast = block->prev;
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************/
+
+/* Give the memory of an empty arena to the heap.  The terminus chunk at the
+ * end of the heap moves to the end of the arena and the space between them
+ * becomes one free chunk.  Temporary strings are allocated from the heap
+ * after that.  Returns true if the heap grew.
+ */
+
+static bool libexec_ReleaseArena(struct libexec_s *st)
+{
+  freeChunk_t *newChunk;
+  memChunk_t  *terminus;
+  uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
+  uint16_t oldEnd    = st->arenaBase - HEAP_ALLOC_UNIT;
+  uint16_t newEnd    = st->arenaEnd - HEAP_ALLOC_UNIT;
+
+  /* The arena must exist, be empty, and follow a heap that is managed */
+
+  if (st->arenaBase == st->arenaEnd || st->arenaLast != st->arenaEnd ||
+      st->arenaBase <= heapStart + 2 * HEAP_ALLOC_UNIT)
+    {
+      return false;
+    }
+
+  terminus                = (memChunk_t *)ATSTACK(st, newEnd);
+  memset(terminus, 0, sizeof(memChunk_t));
+  terminus->address       = newEnd - heapStart;
+  terminus->inUse         = 1;
+  terminus->back          = newEnd - oldEnd;
+
+  /* The old terminus becomes the header of the new chunk.  It is still
+   * marked in-use, so disposing of it merges it with any free chunk before
+   * it.
+   */
+
+  newChunk                = (freeChunk_t *)ATSTACK(st, oldEnd);
+  newChunk->chunk.forward = newEnd - oldEnd;
+
+  st->arenaBase           = st->arenaEnd;
+  st->arenaTop            = st->arenaEnd;
+
+  libexec_DisposeChunk(st, newChunk);
+  return true;
+}
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+/* Record an allocation of 'reqSize' bytes at 'address' (zero if the
+ * allocation failed) by the instruction at st->pc.
+ */
+
+static void libexec_ProfileAlloc(struct libexec_s *st, uint16_t address,
+                                 uint16_t reqSize, uint8_t kind)
+{
+  struct libexec_heapProfile_s *profile = st->heapProfile;
+  uint16_t pc = st->pc < st->maxpc ? st->pc : st->maxpc;
+
+  if (profile == NULL)
+    {
+      return;
+    }
+
+  if (address == 0)
+    {
+      profile->nfailed++;
+      if (reqSize > profile->maxFailed)
+        {
+          profile->maxFailed = reqSize;
+        }
+
+      return;
+    }
+
+  profile->sites[pc].count++;
+  profile->sites[pc].bytes += reqSize;
+  profile->sites[pc].kind   = kind;
+
+  if (address >= st->arenaBase && address < st->arenaEnd)
+    {
+      arenaBlock_t *block = (arenaBlock_t *)
+        ATSTACK(st, address - sizeof(arenaBlock_t));
+
+      block->pc = pc;
+      profile->arenaAllocs++;
+
+      if (st->arenaTop - st->arenaBase > profile->arenaPeak)
+        {
+          profile->arenaPeak = st->arenaTop - st->arenaBase;
+        }
+    }
+  else
+    {
+      memChunk_t *chunk = (memChunk_t *)
+        ATSTACK(st, address - sizeof(memChunk_t));
+
+      chunk->kind    = kind;
+      chunk->allocPc = pc;
+
+      profile->nallocs++;
+      profile->liveBytes += chunk->forward;
+
+      if (profile->liveBytes > profile->peakBytes)
+        {
+          profile->peakBytes = profile->liveBytes;
+        }
+
+      if (chunk->address + chunk->forward > profile->highWater)
+        {
+          profile->highWater = chunk->address + chunk->forward;
+        }
+    }
+}
+#endif
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+static void libexec_ProfileFree(struct libexec_s *st, memChunk_t *chunk)
+{
+  struct libexec_heapProfile_s *profile = st->heapProfile;
+
+  if (profile != NULL)
+    {
+      profile->nfrees++;
+      profile->liveBytes -= chunk->forward;
+    }
+}
+#endif
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+static int libexec_CompareHeapLines(const void *a, const void *b)
+{
+  const struct libexec_heapLine_s *pa = a;
+  const struct libexec_heapLine_s *pb = b;
+
+  return (pa->bytes < pb->bytes) - (pa->bytes > pb->bytes);
+}
+#endif
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+/* Report the allocations in sites[] (indexed by PC) by source line, largest
+ * first.  Returns false if there were none.
+ */
+
+static bool libexec_ReportHeapSites(struct libexec_s *st, FILE *report,
+                                    const char *title,
+                                    const struct libexec_heapSite_s *sites)
+{
+  struct libexec_heapLine_s *lines;
+  poffLibLineNumber_t *lineno;
+  const char *fileName;
+  uint32_t line;
+  unsigned int nlines;
+  unsigned int i;
+  pasSize_t pc;
+
+  lines = (struct libexec_heapLine_s *)
+    calloc(st->maxpc + 1, sizeof(struct libexec_heapLine_s));
+  if (lines == NULL)
+    {
+      return false;
+    }
+
+  /* Credit each allocation site to its source line */
+
+  nlines = 0;
+  for (pc = 0; pc <= st->maxpc; pc++)
+    {
+      if (sites[pc].count == 0)
+        {
+          continue;
+        }
+
+      lineno = pc < st->maxpc ? poffFindLineNumber(pc) : NULL;
+      if (lineno != NULL)
+        {
+          fileName = lineno->filename;
+          line     = lineno->lineno;
+        }
+      else
+        {
+          fileName = NULL;
+          line     = pc;
+        }
+
+      for (i = 0; i < nlines; i++)
+        {
+          if (lines[i].lineno == line && lines[i].fileName == fileName &&
+              lines[i].kind == sites[pc].kind)
+            {
+              break;
+            }
+        }
+
+      if (i == nlines)
+        {
+          lines[i].fileName = fileName;
+          lines[i].lineno   = line;
+          lines[i].kind     = sites[pc].kind;
+          nlines++;
+        }
+
+      lines[i].count += sites[pc].count;
+      lines[i].bytes += sites[pc].bytes;
+    }
+
+  if (nlines > 0)
+    {
+      qsort(lines, nlines, sizeof(struct libexec_heapLine_s),
+            libexec_CompareHeapLines);
+
+      fprintf(report, "\n%s:\n", title);
+      fprintf(report, "%10s %10s  %-6s  %s\n",
+              "COUNT", "BYTES", "KIND", "SOURCE");
+
+      for (i = 0; i < nlines; i++)
+        {
+          fprintf(report, "%10" PRIu32 " %10" PRIu32 "  %-6s  ",
+                  lines[i].count, lines[i].bytes,
+                  lines[i].kind == HEAP_KIND_NEW ? "new" : "string");
+
+          if (lines[i].fileName != NULL)
+            {
+              fprintf(report, "%s:%" PRIu32 "\n",
+                      lines[i].fileName, lines[i].lineno);
+            }
+          else
+            {
+              fprintf(report, "PC 0x%04" PRIx32 "\n", lines[i].lineno);
+            }
+        }
+    }
+
+  free(lines);
+  return nlines > 0;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -720,12 +1051,52 @@ static int libexec_Free(struct libexec_s *st, uint16_t address)
 
 void libexec_InitializeHeap(struct libexec_s *st)
 {
+  unsigned int sizeClass;
+  uint16_t heapStart;
+  uint16_t heapEnd;
+  uint16_t arenaSize;
+
+  /* All free lists are initially empty */
+
+  for (sizeClass = 0; sizeClass < HEAP_NBINS; sizeClass++)
+    {
+      st->freeList[sizeClass] = HEAP_NO_CHUNK;
+    }
+
+  st->freeMap = 0;
+
+  /* The temporary string arena is taken from the top of the heap region.
+   * It is omitted if the heap is too small to spare a string buffer for it.
+   * arenaLast == arenaEnd means that the arena is empty.
+   */
+
+  heapStart = HEAP_ALIGNUP(st->hpb);
+  heapEnd   = HEAP_ALIGNDOWN(st->hpb + st->hpSize);
+  arenaSize = 0;
+
+  if (heapEnd > heapStart)
+    {
+      arenaSize = HEAP_ALIGNDOWN((heapEnd - heapStart) / HEAP_ARENA_FRACTION);
+      if (arenaSize > HEAP_ARENA_SIZE)
+        {
+          arenaSize = HEAP_ARENA_SIZE;
+        }
+      else if (arenaSize < HEAP_ARENA_BLOCK(STRING_BUFFER_SIZE))
+        {
+          arenaSize = 0;
+        }
+    }
+
+  st->arenaEnd  = heapEnd;
+  st->arenaBase = heapEnd - arenaSize;
+  st->arenaTop  = st->arenaBase;
+  st->arenaLast = st->arenaEnd;
+  heapEnd       = st->arenaBase;
+
   /* We can't use the memory manager if no heap was specified */
 
-  if (st->hpSize > 2 * HEAP_ALLOC_UNIT)
+  if (heapEnd > heapStart + 2 * HEAP_ALLOC_UNIT)
     {
-      uint16_t     heapStart = HEAP_ALIGNUP(st->hpb);
-      uint16_t     heapEnd   = HEAP_ALIGNDOWN(heapStart + st->hpSize);
       uint16_t     heapSize;
       memChunk_t  *terminus;
       freeChunk_t *initialChunk;
@@ -743,7 +1114,7 @@ void libexec_InitializeHeap(struct libexec_s *st)
       memset(initialChunk, 0, sizeof(freeChunk_t));
       initialChunk->chunk.forward  = heapSize;
 
-      st->freeChunks               = initialChunk;
+      libexec_AddChunkToFreeList(st, initialChunk);
 
       libexec_DumpHeap(st, "Initially", heapStart);
       libexec_MemInfo(st, "Initially", 0);
@@ -764,6 +1135,8 @@ int libexec_New(struct libexec_s *st, uint16_t size)
         {
           errorCode = eNOERROR;
         }
+
+      libexec_ProfileAlloc(st, addr, size, HEAP_KIND_NEW);
     }
 
   PUSH(st, addr);
@@ -786,11 +1159,23 @@ uint16_t libexec_AllocTmpString(struct libexec_s *st, uint16_t reqSize,
 
   if (reqSize > 0 && reqSize <= STRING_BUFFER_MAX)
     {
-      addr = libexec_Alloc(st, reqSize);
+      /* Temporary strings are nearly always freed in the reverse order of
+       * their allocation, so try the arena first.  Use the heap only if the
+       * arena is full.
+       */
+
+      addr = libexec_ArenaAlloc(st, reqSize);
+      if (addr == 0)
+        {
+          addr = libexec_Alloc(st, reqSize);
+        }
+
       if (addr > 0)
         {
           *allocSize = reqSize | HEAP_STRING;
         }
+
+      libexec_ProfileAlloc(st, addr, reqSize, HEAP_KIND_STRING);
     }
 
   return addr;
@@ -809,8 +1194,214 @@ int libexec_FreeTmpString(struct libexec_s *st, uint16_t allocAddr,
     {
       /* Yes, free it */
 
-      errorCode = libexec_Free(st, allocAddr);
+      if (allocAddr >= st->arenaBase && allocAddr < st->arenaEnd)
+        {
+          errorCode = libexec_ArenaFree(st, allocAddr);
+        }
+      else
+        {
+          errorCode = libexec_Free(st, allocAddr);
+        }
     }
 
   return errorCode;
 }
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+/* Start recording heap allocations */
+
+int libexec_EnableHeapProfile(EXEC_HANDLE_t handle)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  struct libexec_heapProfile_s *profile;
+
+  if (st->heapProfile == NULL)
+    {
+      profile = (struct libexec_heapProfile_s *)
+        calloc(1, sizeof(struct libexec_heapProfile_s));
+      if (profile == NULL)
+        {
+          return eNOMEMORY;
+        }
+
+      profile->sites = (struct libexec_heapSite_s *)
+        calloc(st->maxpc + 1, sizeof(struct libexec_heapSite_s));
+      if (profile->sites == NULL)
+        {
+          free(profile);
+          return eNOMEMORY;
+        }
+
+      st->heapProfile = profile;
+    }
+
+  return eNOERROR;
+}
+#endif
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+/* Write the heap profile collected since libexec_EnableHeapProfile() to
+ * 'report':  The allocation statistics, the state of the heap now, the
+ * allocations by source line, and the allocations that have not been freed
+ * by source line.  This is normally called after the program terminates,
+ * so the last section is a leak report.
+ *
+ * The libpoff line number tables are global, so this must not be called
+ * concurrently from more than one thread.
+ */
+
+void libexec_HeapProfileReport(EXEC_HANDLE_t handle, FILE *report)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  struct libexec_heapProfile_s *profile = st->heapProfile;
+  struct libexec_heapSite_s *leaks;
+  arenaBlock_t *block;
+  poffHandle_t phandle;
+  uint16_t heapStart = HEAP_ALIGNUP(st->hpb);
+  uint16_t heapEnd   = st->arenaBase;
+  uint16_t chunkAddr;
+  uint16_t blockAddr;
+  uint16_t blockEnd;
+  uint32_t freeBytes;
+  uint16_t largest;
+  unsigned int nfree;
+  unsigned int sizeClass;
+
+  if (profile == NULL)
+    {
+      return;
+    }
+
+  leaks = (struct libexec_heapSite_s *)
+    calloc(st->maxpc + 1, sizeof(struct libexec_heapSite_s));
+  if (leaks == NULL)
+    {
+      return;
+    }
+
+  /* Collect the chunks that are still in use.  The terminus chunk at the
+   * end of the heap has a zero forward offset.
+   */
+
+  for (chunkAddr = heapStart; chunkAddr < heapEnd; )
+    {
+      memChunk_t *chunk = (memChunk_t *)ATSTACK(st, chunkAddr);
+
+      if (chunk->forward == 0)
+        {
+          break;
+        }
+
+      if (chunk->inUse && chunk->allocPc <= st->maxpc)
+        {
+          leaks[chunk->allocPc].count++;
+          leaks[chunk->allocPc].bytes += chunk->forward - sizeof(memChunk_t);
+          leaks[chunk->allocPc].kind   = chunk->kind;
+        }
+
+      chunkAddr += chunk->forward;
+    }
+
+  /* And the temporary strings still in the arena.  Each block extends to
+   * the start of the next one.
+   */
+
+  for (blockAddr = st->arenaLast, blockEnd = st->arenaTop;
+       blockAddr != st->arenaEnd;
+       blockEnd = blockAddr, blockAddr = block->prev)
+    {
+      block = (arenaBlock_t *)ATSTACK(st, blockAddr);
+      if (block->inUse && block->pc <= st->maxpc)
+        {
+          leaks[block->pc].count++;
+          leaks[block->pc].bytes += blockEnd - blockAddr -
+                                    sizeof(arenaBlock_t);
+          leaks[block->pc].kind   = HEAP_KIND_STRING;
+        }
+    }
+
+  /* Measure the fragmentation of the free memory */
+
+  freeBytes = 0;
+  largest   = 0;
+  nfree     = 0;
+
+  for (sizeClass = 0; sizeClass < HEAP_NBINS; sizeClass++)
+    {
+      uint16_t offset = st->freeList[sizeClass];
+
+      while (offset != HEAP_NO_CHUNK)
+        {
+          freeChunk_t *freeChunk = HEAP_CHUNK(st, heapStart, offset);
+
+          freeBytes += freeChunk->chunk.forward;
+          if (freeChunk->chunk.forward > largest)
+            {
+              largest = freeChunk->chunk.forward;
+            }
+
+          nfree++;
+          offset = freeChunk->next;
+        }
+    }
+
+  phandle = libexec_ReadDebugInfo(st);
+
+  fprintf(report, "Heap profile of %s\n", st->image->fileName);
+  fprintf(report, "  Heap size:           %" PRIu16 " bytes "
+          "(%" PRIu16 " for the temporary string arena)\n",
+          st->arenaEnd > heapStart ? st->arenaEnd - heapStart : 0,
+          st->arenaEnd - st->arenaBase);
+  fprintf(report, "  Heap allocations:    %" PRIu32 " (%" PRIu32
+          " freed)\n", profile->nallocs, profile->nfrees);
+  fprintf(report, "  Arena allocations:   %" PRIu32 " (peak %" PRIu16
+          " bytes in use)\n", profile->arenaAllocs, profile->arenaPeak);
+  fprintf(report, "  Failed allocations:  %" PRIu32, profile->nfailed);
+  if (profile->nfailed > 0)
+    {
+      fprintf(report, " (largest request %" PRIu16 " bytes)",
+              profile->maxFailed);
+    }
+
+  fputc('\n', report);
+  fprintf(report, "  Peak heap use:       %" PRIu32 " bytes "
+          "(high-water mark %" PRIu16 " bytes)\n",
+          profile->peakBytes, profile->highWater);
+  fprintf(report, "  Heap in use now:     %" PRIu32 " bytes\n",
+          profile->liveBytes);
+  fprintf(report, "  Free memory now:     %" PRIu32 " bytes in %u chunks, "
+          "largest %" PRIu16 " (%.1f%% fragmented)\n",
+          freeBytes, nfree, largest,
+          freeBytes > 0 ?
+          100.0 * (1.0 - (double)largest / (double)freeBytes) : 0.0);
+
+  (void)libexec_ReportHeapSites(st, report, "Allocations (bytes requested)",
+                                 profile->sites);
+  if (!libexec_ReportHeapSites(st, report,
+                               "Not freed (bytes allocated)", leaks))
+    {
+      fprintf(report, "\nNot freed:  None\n");
+    }
+
+  libexec_ReleaseDebugInfo(phandle);
+  free(leaks);
+}
+#endif
+
+/****************************************************************************/
+
+#ifdef CONFIG_PASCAL_PROFILER
+void libexec_ReleaseHeapProfile(struct libexec_s *st)
+{
+  if (st->heapProfile != NULL)
+    {
+      free(st->heapProfile->sites);
+      free(st->heapProfile);
+      st->heapProfile = NULL;
+    }
+}
+#endif
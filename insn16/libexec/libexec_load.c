@@ -33,6 +33,7 @@
  *
  ****************************************************************************/
 
+
 /****************************************************************************
  * Included Files
  ****************************************************************************/
@@ -40,7 +41,8 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <errno.h>
+#include <string.h>
+#include <pthread.h>
 
 #include "pofflib.h"
 #include "execlib.h"
@@ -50,109 +52,340 @@
 #include "pas_error.h"
 
 #include "libexec.h"
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+#  include "libexec_predecode.h"
+#endif
 
 /****************************************************************************
- * Public Functions
+ * Pre-processor Definitions
  ****************************************************************************/
 
-EXEC_HANDLE_t libexec_Load(const char *filename, pasSize_t strSize,
-                           pasSize_t stkSize, pasSize_t hpSize)
+/* 32-bit FNV-1a hash parameters */
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The cache of loaded program images.  Every image in the list is in use
+ * by at least one reference; an image is removed from the list and freed
+ * when its last reference is released.
+ */
+
+static struct libexec_image_s *g_imageCache;
+static pthread_mutex_t g_imageLock = PTHREAD_MUTEX_INITIALIZER;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_Hash
+ *
+ * Description:
+ *   Continue the FNV-1a hash 'value' over 'size' bytes of data.
+ *
+ ****************************************************************************/
+
+static uint32_t libexec_Hash(uint32_t value, const uint8_t *data,
+                             uint32_t size)
 {
-  struct libexec_attr_s attr;
-  struct libexec_s *st;
-  poffHandle_t phandle;
-  FILE        *exe;
-  uint16_t     err;
-  uint8_t      ftype;
-  uint8_t      farch;
+  uint32_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      value = (value ^ data[i]) * FNV_PRIME;
+    }
+
+  return value;
+}
+
+/****************************************************************************
+ * Name: libexec_FreeImage
+ ****************************************************************************/
 
-  /* Create a handle to contain the executable data */
+static void libexec_FreeImage(struct libexec_image_s *image)
+{
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  libexec_ReleaseCode(image);
+#endif
+  poffUnmapFile(image->map);
+  free(image->fileName);
+  free(image);
+}
 
-  phandle = poffCreateHandle();
-  if (phandle == NULL) fatal(eNOMEMORY);
+/****************************************************************************
+ * Name: libexec_CreateImage
+ *
+ * Description:
+ *   Create a new program image from a mapped pascal executable.  The image
+ *   takes over the mapping.
+ *
+ ****************************************************************************/
 
-  /* Open the executable file */
+static struct libexec_image_s *
+libexec_CreateImage(const char *filename, poffMapHandle_t map)
+{
+  struct libexec_image_s *image;
 
-  if (!(exe = fopen(filename, "rb")))
+  image = (struct libexec_image_s *)calloc(1, sizeof(struct libexec_image_s));
+  if (image == NULL)
     {
-      dbg("ERROR: Error opening '%s': %d\n", filename, errno);
-      goto errout_with_handle;
+      return NULL;
     }
 
-  /* Load the POFF file into memory */
+  image->fileName = strdup(filename);
+  if (image->fileName == NULL)
+    {
+      free(image);
+      return NULL;
+    }
+
+  /* I-Space and the read-only data are used in place in the mapping */
+
+  image->map    = map;
+  image->entry  = poffMapGetEntryPoint(map);
+  image->maxpc  = poffMapGetProgramData(map, &image->ispace);
+  image->roSize = poffMapGetRoData(map, &image->rodata);
+
+  /* Verify I-Space.  A program that fails verification is still run, but
+   * with every program counter checked.
+   */
+
+  (void)libexec_Verify(image);
+
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  /* Expand I-Space into the fixed size records used by the dispatch loop */
+
+  if (libexec_Predecode(image) != eNOERROR)
+    {
+      free(image->fileName);
+      free(image);
+      return NULL;
+    }
+#endif
+
+  return image;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_LoadImage
+ *
+ * Description:
+ *   Return a reference to the program image of a pascal executable.  If the
+ *   same file, with the same program, is already loaded, its image is
+ *   shared; otherwise a new image is created.  The reference must be
+ *   released with libexec_ReleaseImage().
+ *
+ *   The file is mapped, not read.  Only the file header and the program and
+ *   read-only data sections are accessed; symbol, relocation, line number,
+ *   and debug information are ignored.
+ *
+ ****************************************************************************/
 
-  err = poffReadFile(phandle, exe);
+EXEC_IMAGE_t libexec_LoadImage(const char *filename)
+{
+  struct libexec_image_s *image;
+  poffMapHandle_t map;
+  const uint8_t  *progData;
+  const uint8_t  *roData;
+  uint32_t        progSize;
+  uint32_t        roSize;
+  uint32_t        entry;
+  uint32_t        hash;
+  uint16_t        err;
+  uint8_t         ftype;
+  uint8_t         farch;
+
+  /* Map the executable file */
+
+  err = poffMapFile(filename, &map);
   if (err != eNOERROR)
     {
-      dbg("ERROR: Could not read %s: %d\n", filename, err);
-      goto errout_with_file;
+      dbg("ERROR: Could not map %s: %d\n", filename, err);
+      return NULL;
     }
 
   /* Verify that the file is a pascal executable */
 
-  ftype = poffGetFileType(phandle);
+  ftype = poffMapGetFileType(map);
   if (ftype != FHT_EXEC)
     {
       dbg("ERROR: File is not a pascal executable: %d\n", ftype);
-      goto errout_with_file;
+      poffUnmapFile(map);
+      return NULL;
     }
 
-  farch = poffGetArchitecture(phandle);
+  farch = poffMapGetArchitecture(map);
   if (farch != FHA_PCODE_INSN16)
     {
       dbg("ERROR: File is not 16-bit pcode: %d\n", farch);
-      goto errout_with_file;
+      poffUnmapFile(map);
+      return NULL;
     }
 
-  /* Initialize the attribute structure */
+  /* Hash the parts of the file that make up the image */
 
-  attr.strSize  = strSize;
-  attr.stkSize  = stkSize;
-  attr.hpSize   = hpSize;
+  entry    = poffMapGetEntryPoint(map);
+  progSize = poffMapGetProgramData(map, &progData);
+  roSize   = poffMapGetRoData(map, &roData);
 
-  /* Extract the program entry point from the pascal executable */
+  hash     = libexec_Hash(FNV_OFFSET_BASIS, (const uint8_t *)&entry,
+                          sizeof(uint32_t));
+  hash     = libexec_Hash(hash, progData, progSize);
+  hash     = libexec_Hash(hash, roData, roSize);
 
-  attr.entry = poffGetEntryPoint(phandle);
+  /* The lock is held while a new image is created so that concurrent
+   * loads of the same file share one image.
+   */
 
-  /* Close the POFF file */
+  pthread_mutex_lock(&g_imageLock);
 
-  (void)fclose(exe);
+  for (image = g_imageCache; image != NULL; image = image->flink)
+    {
+      if (image->hash == hash && image->maxpc == progSize &&
+          image->roSize == roSize && strcmp(image->fileName, filename) == 0)
+        {
+          break;
+        }
+    }
 
-  /* Extract the program data from the POFF image */
+  if (image != NULL)
+    {
+      image->crefs++;
+      poffUnmapFile(map);
+    }
+  else
+    {
+      image = libexec_CreateImage(filename, map);
+      if (image != NULL)
+        {
+          image->hash     = hash;
+          image->crefs    = 1;
+          image->flink    = g_imageCache;
+          g_imageCache    = image;
+        }
+      else
+        {
+          poffUnmapFile(map);
+        }
+    }
 
-  attr.maxpc = poffExtractProgramData(phandle, &attr.ispace);
+  pthread_mutex_unlock(&g_imageLock);
+  return (EXEC_IMAGE_t)image;
+}
 
-  /* Extract the read-only data from the POFF image */
+/****************************************************************************
+ * Name: libexec_ReleaseImage
+ *
+ * Description:
+ *   Release a reference to a program image.  The image is freed when its
+ *   last reference is released.
+ *
+ ****************************************************************************/
 
-  attr.roSize = poffExtractRoData(phandle, &attr.rodata);
+void libexec_ReleaseImage(EXEC_IMAGE_t handle)
+{
+  struct libexec_image_s *image = (struct libexec_image_s *)handle;
+  struct libexec_image_s **pprev;
 
-  /* Destroy the POFF image */
+  pthread_mutex_lock(&g_imageLock);
 
-  poffDestroyHandle(phandle);
+  if (--image->crefs > 0)
+    {
+      image = NULL;
+    }
+  else
+    {
+      for (pprev = &g_imageCache; *pprev != NULL; pprev = &(*pprev)->flink)
+        {
+          if (*pprev == image)
+            {
+              *pprev = image->flink;
+              break;
+            }
+        }
+    }
 
-  /* Initialize the p-code interpreter */
+  pthread_mutex_unlock(&g_imageLock);
 
-  st = libexec_Initialize(&attr);
-  if (!st && attr.ispace)
+  if (image != NULL)
     {
-      /* Initialization failed, discard the allocated I-Space */
-
-      free(st->ispace);
+      libexec_FreeImage(image);
     }
+}
 
-  /* Discard the allocated RO data in any event */
+/****************************************************************************
+ * Name: libexec_Instantiate
+ *
+ * Description:
+ *   Create a new instance of the p-code interpreter that runs a loaded
+ *   program image.  Only the D-Space of the instance is allocated; I-Space
+ *   and the read-only data are shared with the image.  The instance holds
+ *   its own reference to the image.
+ *
+ ****************************************************************************/
 
-  if (attr.rodata)
+EXEC_HANDLE_t libexec_Instantiate(EXEC_IMAGE_t image, pasSize_t strSize,
+                                  pasSize_t stkSize, pasSize_t hpSize)
+{
+  struct libexec_attr_s attr;
+  struct libexec_s *st;
+
+  /* Take a reference to the image for the new instance */
+
+  pthread_mutex_lock(&g_imageLock);
+  ((struct libexec_image_s *)image)->crefs++;
+  pthread_mutex_unlock(&g_imageLock);
+
+  /* Initialize the attribute structure */
+
+  attr.image    = (struct libexec_image_s *)image;
+  attr.strSize  = strSize;
+  attr.stkSize  = stkSize;
+  attr.hpSize   = hpSize;
+
+  /* Initialize the p-code interpreter */
+
+  st = libexec_Initialize(&attr);
+  if (st == NULL)
     {
-      free(attr.rodata);
+      /* Initialization failed, drop the instance's reference */
+
+      libexec_ReleaseImage(image);
     }
 
   return (EXEC_HANDLE_t)st;
+}
+
+/****************************************************************************
+ * Name: libexec_Load
+ *
+ * Description:
+ *   Load a pascal executable and create an instance of the p-code
+ *   interpreter to run it.
+ *
+ ****************************************************************************/
 
- errout_with_file:
-  (void)fclose(exe);
+EXEC_HANDLE_t libexec_Load(const char *filename, pasSize_t strSize,
+                           pasSize_t stkSize, pasSize_t hpSize)
+{
+  EXEC_IMAGE_t image;
+  EXEC_HANDLE_t handle;
+
+  image = libexec_LoadImage(filename);
+  if (image == NULL)
+    {
+      return NULL;
+    }
 
- errout_with_handle:
-  poffDestroyHandle(phandle);
-  return NULL;
+  handle = libexec_Instantiate(image, strSize, stkSize, hpSize);
+  libexec_ReleaseImage(image);
+  return handle;
 }
@@ -0,0 +1,435 @@
+/****************************************************************************
+ * libexec_predecode.c
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "pas_debug.h"
+#include "pas_machine.h"
+#include "insn16.h"
+#include "pas_errcodes.h"
+
+#include "libexec.h"
+#include "libexec_predecode.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+/* Describes one superinstruction:  The dispatch code of the fused handler
+ * and the sequence of opcodes that it replaces.
+ */
+
+struct libexec_fusion_s
+{
+  uint16_t code;     /* Dispatch code of the fused handler */
+  uint8_t  nops;     /* Number of opcodes in the sequence */
+  uint8_t  ops[3];   /* The sequence of opcodes */
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+/* The fused sequences were selected from the dynamic opcode pair and triple
+ * counts measured over the programs in tests/src and tests/units.  The
+ * percentage is the share of all executed instructions that begin such a
+ * sequence.  Longer sequences must precede any shorter sequence with the
+ * same prefix since the first match wins.
+ *
+ *   LD PUSHB SLL   7.3%   Index scaling of a global array subscript
+ *   LD INC ST      1.9%   i := i + 1
+ *   LD PUSHB      15.3%   (including LD PUSHB SLL)
+ *   PUSHB SLL      7.4%   (including LD PUSHB SLL)
+ *   ST LD          5.2%
+ *   LD LD          4.8%
+ *   ADD ST         3.5%
+ *   PUSHB LDXM     3.3%   Load of an indexed set or record
+ *   PUSHB Jcc      4.8%   FOR and WHILE loop tests against a constant
+ *   INC ST         2.1%
+ *   PUSHB STXM     2.0%
+ *   LDS LDS        0.2%   Same as LD LD in a nested procedure
+ *   LDS LDI        0.1%   Dereference a VAR parameter
+ *
+ * PUSH Jcc is rare in the test programs but is the same handler as PUSHB
+ * Jcc for constants that do not fit in 8 bits.  LA SETIN and LAS SETIN
+ * test set membership directly in a set variable; popt generates the
+ * pair for every 'x IN s' on a global or local set.
+ */
+
+static const struct libexec_fusion_s g_fusion[] =
+{
+  { xLD_PUSHB_SLL, 3, { oLD,    oPUSHB, oSLL } },
+  { xLD_INC_ST,    3, { oLD,    oINC,   oST  } },
+  { xLD_PUSHB,     2, { oLD,    oPUSHB       } },
+  { xPUSHB_SLL,    2, { oPUSHB, oSLL         } },
+  { xST_LD,        2, { oST,    oLD          } },
+  { xLD_LD,        2, { oLD,    oLD          } },
+  { xADD_ST,       2, { oADD,   oST          } },
+  { xINC_ST,       2, { oINC,   oST          } },
+  { xPUSHB_LDXM,   2, { oPUSHB, oLDXM        } },
+  { xPUSHB_STXM,   2, { oPUSHB, oSTXM        } },
+  { xLDS_LDS,      2, { oLDS,   oLDS         } },
+  { xLDS_LDI,      2, { oLDS,   oLDI         } },
+  { xPUSHB_JEQU,   2, { oPUSHB, oJEQU        } },
+  { xPUSHB_JNEQ,   2, { oPUSHB, oJNEQ        } },
+  { xPUSHB_JLT,    2, { oPUSHB, oJLT         } },
+  { xPUSHB_JGTE,   2, { oPUSHB, oJGTE        } },
+  { xPUSHB_JGT,    2, { oPUSHB, oJGT         } },
+  { xPUSHB_JLTE,   2, { oPUSHB, oJLTE        } },
+  { xPUSH_JEQU,    2, { oPUSH,  oJEQU        } },
+  { xPUSH_JNEQ,    2, { oPUSH,  oJNEQ        } },
+  { xPUSH_JLT,     2, { oPUSH,  oJLT         } },
+  { xPUSH_JGTE,    2, { oPUSH,  oJGTE        } },
+  { xPUSH_JGT,     2, { oPUSH,  oJGT         } },
+  { xPUSH_JLTE,    2, { oPUSH,  oJLTE        } },
+  { xLA_SETIN,     2, { oLA,    oSETIN       } },
+  { xLAS_SETIN,    2, { oLAS,   oSETIN       } },
+};
+
+#define NUM_FUSIONS (sizeof(g_fusion) / sizeof(struct libexec_fusion_s))
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_InsnSize
+ *
+ * Description:
+ *   Return the size in bytes of the instruction with this opcode.
+ *
+ ****************************************************************************/
+
+static inline pasSize_t libexec_InsnSize(uint8_t opcode)
+{
+  pasSize_t size = 1;
+
+  if ((opcode & o8) != 0)
+    {
+      size += 1;
+    }
+
+  if ((opcode & o16) != 0)
+    {
+      size += 2;
+    }
+
+  return size;
+}
+
+/****************************************************************************
+ * Name: libexec_IsBranch
+ *
+ * Description:
+ *   Return true if the 16-bit immediate data of this opcode is an I-Space
+ *   label that the dispatch loop will branch to directly.
+ *
+ ****************************************************************************/
+
+static bool libexec_IsBranch(uint8_t opcode)
+{
+  switch (opcode)
+    {
+    case oJEQUZ :
+    case oJNEQZ :
+    case oJLTZ  :
+    case oJGTEZ :
+    case oJGTZ  :
+    case oJLTEZ :
+    case oJMP   :
+    case oJEQU  :
+    case oJNEQ  :
+    case oJLT   :
+    case oJGTE  :
+    case oJGT   :
+    case oJLTE  :
+    case oJULT  :
+    case oJUGTE :
+    case oJUGT  :
+    case oJULTE :
+    case oPCAL  :
+      return true;
+
+    default:
+      return false;
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_Fuse
+ *
+ * Description:
+ *   Replace the dispatch code of the first record of each fused sequence
+ *   with the dispatch code of its superinstruction.  Only the first record
+ *   is changed:  The following records are left intact so that a branch
+ *   into the middle of a sequence still executes correctly.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+static void libexec_Fuse(libexec_insn_t *code, uint32_t ninsn,
+                         const void *const *table)
+{
+  uint32_t index;
+  unsigned int i;
+  unsigned int j;
+
+  for (index = 0; index < ninsn; index++)
+    {
+      for (i = 0; i < NUM_FUSIONS; i++)
+        {
+          const struct libexec_fusion_s *fusion = &g_fusion[i];
+
+          if (index + fusion->nops > ninsn)
+            {
+              continue;
+            }
+
+          for (j = 0; j < fusion->nops; j++)
+            {
+              if (code[index + j].op != fusion->ops[j])
+                {
+                  break;
+                }
+            }
+
+          if (j == fusion->nops)
+            {
+              code[index].op      = fusion->code;
+              code[index].handler = table ? table[fusion->code] : NULL;
+              break;
+            }
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_Predecode
+ *
+ * Description:
+ *   Convert the variable length instructions in I-Space into an array of
+ *   fixed size instruction records.  One record is created for each
+ *   instruction, in the same order, plus one final record that represents
+ *   any address outside of I-Space.  Branch and call targets are remapped
+ *   to record indices; a target that is not the address of an instruction
+ *   is mapped to the final record.
+ *
+ *   A map from I-Space address to record index is also created.  It is used
+ *   to resume execution at st->pc and to locate the return address on oRET.
+ *
+ *   The records are part of the shared program image and are not modified
+ *   after they are created.  The image must already have been verified (see
+ *   libexec_Verify()):  Some instructions of a verified program are replaced
+ *   with faster forms that rely on the verification.
+ *
+ ****************************************************************************/
+
+int libexec_Predecode(struct libexec_image_s *image)
+{
+  const void *const *table = libexec_DispatchTable();
+  const uint8_t *ispace    = image->ispace;
+  pasSize_t maxpc          = image->maxpc;
+  libexec_insn_t *code;
+  libexec_insn_t *insn;
+  uint16_t *pcIndex;
+  uint32_t ninsn;
+  uint32_t pc;
+  uint8_t opcode;
+
+  /* Pass 1:  Count the instructions */
+
+  for (pc = 0, ninsn = 0; pc < maxpc; ninsn++)
+    {
+      pc += libexec_InsnSize(ispace[pc]);
+    }
+
+  /* Allocate the instruction records (plus one for the out-of-range
+   * record) and the address-to-record map.
+   */
+
+  code    = (libexec_insn_t *)malloc((ninsn + 1) * sizeof(libexec_insn_t));
+  pcIndex = (uint16_t *)malloc((maxpc + 1) * sizeof(uint16_t));
+  if (code == NULL || pcIndex == NULL)
+    {
+      free(code);
+      free(pcIndex);
+      return eNOMEMORY;
+    }
+
+  /* Any address that is not the start of an instruction maps to the final,
+   * out-of-range record.
+   */
+
+  for (pc = 0; pc <= maxpc; pc++)
+    {
+      pcIndex[pc] = ninsn;
+    }
+
+  for (pc = 0, ninsn = 0; pc < maxpc; ninsn++)
+    {
+      pcIndex[pc] = ninsn;
+      pc += libexec_InsnSize(ispace[pc]);
+    }
+
+  /* Pass 2:  Decode each instruction.  A truncated final instruction is
+   * decoded as if the missing bytes were zero.
+   */
+
+  for (pc = 0, insn = code; pc < maxpc; insn++)
+    {
+      uint8_t bytes[4] = {0, 0, 0, 0};
+      pasSize_t size;
+      pasSize_t i;
+
+      opcode = ispace[pc];
+      size   = libexec_InsnSize(opcode);
+
+      for (i = 0; i < size && pc + i < maxpc; i++)
+        {
+          bytes[i] = ispace[pc + i];
+        }
+
+      insn->op      = opcode;
+      insn->handler = table ? table[opcode] : NULL;
+      insn->pc      = pc;
+      insn->imm8    = 0;
+      insn->imm16   = 0;
+
+      if ((opcode & o8) != 0)
+        {
+          insn->imm8 = bytes[1];
+          if ((opcode & o16) != 0)
+            {
+              insn->imm16 = (uint16_t)bytes[2] << 8 | bytes[3];
+            }
+        }
+      else if ((opcode & o16) != 0)
+        {
+          insn->imm16 = (uint16_t)bytes[1] << 8 | bytes[2];
+        }
+
+      if (libexec_IsBranch(opcode))
+        {
+          insn->imm16 = insn->imm16 < maxpc ? pcIndex[insn->imm16] : ninsn;
+        }
+
+      /* The nesting level of every call in a verified program has been
+       * checked, so the call can be made without checking it again.
+       */
+
+      if (opcode == oPCAL && image->verified)
+        {
+          insn->op      = xPCAL;
+          insn->handler = table ? table[xPCAL] : NULL;
+        }
+
+      pc += size;
+    }
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+  /* Pass 3:  Replace hot instruction sequences with superinstructions */
+
+  libexec_Fuse(code, ninsn, table);
+#endif
+
+  /* The final record catches execution that leaves I-Space */
+
+  insn->op      = xBADPC;
+  insn->handler = table ? table[xBADPC] : NULL;
+  insn->pc      = maxpc;
+  insn->imm8    = 0;
+  insn->imm16   = 0;
+
+  image->code    = code;
+  image->pcIndex = pcIndex;
+  image->ninsn   = ninsn;
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_FusedLength
+ *
+ * Description:
+ *   Return the number of instructions that are executed by one dispatch of
+ *   a record with this dispatch code:  The length of the fused sequence for
+ *   a superinstruction, otherwise one.
+ *
+ ****************************************************************************/
+
+int libexec_FusedLength(uint16_t code)
+{
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+  int i;
+
+  for (i = 0; i < NUM_FUSIONS; i++)
+    {
+      if (g_fusion[i].code == code)
+        {
+          return g_fusion[i].nops;
+        }
+    }
+#endif
+
+  return 1;
+}
+
+/****************************************************************************
+ * Name: libexec_ReleaseCode
+ ****************************************************************************/
+
+void libexec_ReleaseCode(struct libexec_image_s *image)
+{
+  free(image->code);
+  free(image->pcIndex);
+
+  image->code    = NULL;
+  image->pcIndex = NULL;
+  image->ninsn   = 0;
+}
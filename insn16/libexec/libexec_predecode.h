@@ -0,0 +1,130 @@
+/***************************************************************************
+ * libexec_predecode.h
+ * Predecoded, fixed-width instruction stream used by the dispatch loop
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ***************************************************************************/
+
+#ifndef __LIBEXEC_PREDECODE_H
+#define __LIBEXEC_PREDECODE_H
+
+/***************************************************************************
+ * Included Files
+ ***************************************************************************/
+
+#include <stdint.h>
+
+#include "config.h"
+#include "libexec.h"
+
+/***************************************************************************
+ * Pre-processor Definitions
+ ***************************************************************************/
+
+/* Dispatch codes.  Values 0-255 are the insn16 opcodes themselves.  Values
+ * above that are internal to the run-time and never appear in I-Space.
+ */
+
+#define xBADPC           (256)  /* Execution left I-Space */
+#define xPCAL            (257)  /* oPCAL in a verified program */
+
+#ifdef CONFIG_PASCAL_SUPERINSTRUCTIONS
+/* Superinstructions.  The dispatch code of the first record of a fused
+ * sequence is replaced with one of these; the remaining records of the
+ * sequence are left untouched so that they may still be reached by a
+ * branch.  The fused handler takes its immediate data from the following
+ * records and then skips over them.
+ */
+
+#  define xLD_PUSHB_SLL  (258)  /* LD + PUSHB + SLL */
+#  define xLD_INC_ST     (259)  /* LD + INC + ST */
+#  define xLD_PUSHB      (260)  /* LD + PUSHB */
+#  define xPUSHB_SLL     (261)  /* PUSHB + SLL */
+#  define xST_LD         (262)  /* ST + LD */
+#  define xLD_LD         (263)  /* LD + LD */
+#  define xADD_ST        (264)  /* ADD + ST */
+#  define xINC_ST        (265)  /* INC + ST */
+#  define xPUSHB_LDXM    (266)  /* PUSHB + LDXM */
+#  define xPUSHB_STXM    (267)  /* PUSHB + STXM */
+#  define xLDS_LDS       (268)  /* LDS + LDS */
+#  define xLDS_LDI       (269)  /* LDS + LDI */
+#  define xPUSHB_JEQU    (270)  /* PUSHB + JEQU */
+#  define xPUSHB_JNEQ    (271)  /* PUSHB + JNEQ */
+#  define xPUSHB_JLT     (272)  /* PUSHB + JLT */
+#  define xPUSHB_JGTE    (273)  /* PUSHB + JGTE */
+#  define xPUSHB_JGT     (274)  /* PUSHB + JGT */
+#  define xPUSHB_JLTE    (275)  /* PUSHB + JLTE */
+#  define xPUSH_JEQU     (276)  /* PUSH + JEQU */
+#  define xPUSH_JNEQ     (277)  /* PUSH + JNEQ */
+#  define xPUSH_JLT      (278)  /* PUSH + JLT */
+#  define xPUSH_JGTE     (279)  /* PUSH + JGTE */
+#  define xPUSH_JGT      (280)  /* PUSH + JGT */
+#  define xPUSH_JLTE     (281)  /* PUSH + JLTE */
+#  define xLA_SETIN      (282)  /* LA + SETIN */
+#  define xLAS_SETIN     (283)  /* LAS + SETIN */
+#  define NUM_DISPATCH   (284)  /* Size of the dispatch table */
+#else
+#  define NUM_DISPATCH   (258)  /* Size of the dispatch table */
+#endif
+
+/***************************************************************************
+ * Public Types
+ ***************************************************************************/
+
+/* One predecoded instruction.  The variable-length instructions in I-Space
+ * are expanded once into an array of these fixed size records so that no
+ * decoding is needed at run time.  The immediate data of branch and call
+ * instructions holds the index of the target record, not the I-Space
+ * address.
+ */
+
+struct libexec_insn_s
+{
+  const void *handler;  /* Opcode handler (computed-goto dispatch only) */
+  uint16_t    op;       /* Dispatch code (see above) */
+  uint16_t    pc;       /* I-Space address of the instruction */
+  uint16_t    imm16;    /* 16-bit immediate data or target record index */
+  uint8_t     imm8;     /* 8-bit immediate data */
+};
+
+typedef struct libexec_insn_s libexec_insn_t;
+
+/***************************************************************************
+ * Public Function Prototypes
+ ***************************************************************************/
+
+const void *const *libexec_DispatchTable(void);
+int  libexec_Predecode(struct libexec_image_s *image);
+void libexec_ReleaseCode(struct libexec_image_s *image);
+int  libexec_FusedLength(uint16_t code);
+
+#endif /* __LIBEXEC_PREDECODE_H */
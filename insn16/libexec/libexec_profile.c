@@ -0,0 +1,1258 @@
+/****************************************************************************
+ * libexec_profile.c
+ * P-Code execution profiler
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "pofflib.h"
+#include "execlib.h"
+
+#include "pas_debug.h"
+#include "pas_machine.h"
+#include "pas_insn.h"
+#include "insn16.h"
+#include "pas_errcodes.h"
+
+#include "libexec.h"
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+#  include "libexec_predecode.h"
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Number of instructions listed in the hot instruction section */
+
+#define MAX_HOT_INSNS 20
+
+/* Percentage of the total */
+
+#define PERCENT(n, total) \
+  ((total) > 0 ? 100.0 * (double)(n) / (double)(total) : 0.0)
+
+/* Initial sizes of the call stack sampler tables */
+
+#define INITIAL_STACKS 64
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The execution count of one procedure */
+
+struct libexec_procProfile_s
+{
+  pasSize_t start;           /* I-Space address of the region */
+  pasSize_t entry;           /* I-Space address of the entry point */
+  uint64_t  count;           /* Instructions executed in the procedure */
+};
+
+/* The execution count of one source line */
+
+struct libexec_lineProfile_s
+{
+  const char *fileName;      /* Source file */
+  uint32_t    lineno;        /* Source line number */
+  uint64_t    count;         /* Instructions executed for the line */
+};
+
+/* One distinct call stack recorded by the sampler */
+
+struct libexec_stack_s
+{
+  uint32_t   hash;           /* Hash of the frames */
+  uint32_t   count;          /* Number of samples of this stack */
+  uint32_t   depth;          /* Number of frames */
+  pasSize_t *frames;         /* Procedure entry points, outermost first */
+};
+
+/* The state of the call stack sampler */
+
+struct libexec_sampler_s
+{
+  struct libexec_procProfile_s *procs;
+                             /* Procedure regions sorted by start */
+  unsigned int nregions;     /* Number of regions in procs[] */
+  struct libexec_stack_s *stacks;
+                             /* Distinct stacks in the order first seen */
+  uint32_t   nstacks;        /* Number of stacks in stacks[] */
+  uint32_t   maxStacks;      /* Allocated size of stacks[] */
+  uint32_t  *index;          /* Hash table of stacks[] index + 1 */
+  uint32_t   indexSize;      /* Size of index[] (a power of two) */
+  pasSize_t *scratch;        /* Frames of the sample being taken */
+  uint32_t   maxDepth;       /* Size of scratch[] */
+  uint32_t   seed;           /* State of the interval randomizer */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_InsnSize
+ ****************************************************************************/
+
+static inline pasSize_t libexec_InsnSize(uint8_t opcode)
+{
+  return 1 + ((opcode & o8) != 0 ? 1 : 0) + ((opcode & o16) != 0 ? 2 : 0);
+}
+
+/****************************************************************************
+ * Name: libexec_CompareProcStart
+ ****************************************************************************/
+
+static int libexec_CompareProcStart(const void *a, const void *b)
+{
+  const struct libexec_procProfile_s *pa = a;
+  const struct libexec_procProfile_s *pb = b;
+
+  return (int)pa->start - (int)pb->start;
+}
+
+/****************************************************************************
+ * Name: libexec_CompareProcEntry
+ ****************************************************************************/
+
+static int libexec_CompareProcEntry(const void *a, const void *b)
+{
+  const struct libexec_procProfile_s *pa = a;
+  const struct libexec_procProfile_s *pb = b;
+
+  return (int)pa->entry - (int)pb->entry;
+}
+
+/****************************************************************************
+ * Name: libexec_CompareProcCount
+ ****************************************************************************/
+
+static int libexec_CompareProcCount(const void *a, const void *b)
+{
+  const struct libexec_procProfile_s *pa = a;
+  const struct libexec_procProfile_s *pb = b;
+
+  return (pa->count < pb->count) - (pa->count > pb->count);
+}
+
+/****************************************************************************
+ * Name: libexec_CompareLineCount
+ ****************************************************************************/
+
+static int libexec_CompareLineCount(const void *a, const void *b)
+{
+  const struct libexec_lineProfile_s *pa = a;
+  const struct libexec_lineProfile_s *pb = b;
+
+  return (pa->count < pb->count) - (pa->count > pb->count);
+}
+
+/****************************************************************************
+ * Name: libexec_SourceLocation
+ *
+ * Description:
+ *   Print the source file and line of an I-Space address, if known.
+ *
+ ****************************************************************************/
+
+static void libexec_SourceLocation(FILE *report, pasSize_t pc)
+{
+  poffLibLineNumber_t *lineno = poffFindLineNumber(pc);
+
+  if (lineno != NULL)
+    {
+      fprintf(report, "%s:%" PRIu32, lineno->filename, lineno->lineno);
+    }
+  else
+    {
+      fprintf(report, "?");
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_ProcedureLocation
+ *
+ * Description:
+ *   Print the source location of the procedure body that begins at 'start'.
+ *   There is no line number for the set up code at the beginning of a
+ *   body, so this is the first line number within the body.
+ *
+ ****************************************************************************/
+
+static void libexec_ProcedureLocation(struct libexec_s *st, FILE *report,
+                                      pasSize_t start)
+{
+  poffLibLineNumber_t *lineno;
+  pasSize_t pc;
+  uint8_t opcode;
+
+  for (pc = start; pc < st->maxpc; pc += libexec_InsnSize(opcode))
+    {
+      lineno = poffFindLineNumber(pc);
+      if (lineno != NULL && lineno->offset >= start)
+        {
+          fprintf(report, "%s:%" PRIu32, lineno->filename, lineno->lineno);
+          return;
+        }
+
+      opcode = st->ispace[pc];
+      if (opcode == oRET)
+        {
+          break;
+        }
+    }
+
+  libexec_SourceLocation(report, start);
+}
+
+/****************************************************************************
+ * Name: libexec_GetCounts
+ *
+ * Description:
+ *   Return the number of times that the instruction at each I-Space address
+ *   was executed.  The profile counts dispatches; an execution of a
+ *   superinstruction is credited here to every instruction of its sequence.
+ *
+ ****************************************************************************/
+
+static uint64_t *libexec_GetCounts(struct libexec_s *st)
+{
+  uint64_t *counts;
+  pasSize_t pc;
+
+  counts = (uint64_t *)calloc(st->maxpc + 1, sizeof(uint64_t));
+  if (counts == NULL)
+    {
+      return NULL;
+    }
+
+  for (pc = 0; pc < st->maxpc; pc++)
+    {
+      counts[pc] = st->profile[pc];
+    }
+
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  {
+    pasSize_t index;
+    int       nops;
+    int       i;
+
+    for (index = 0; index < st->ninsn; index++)
+      {
+        nops = libexec_FusedLength(st->code[index].op);
+        for (i = 1; i < nops && index + i < st->ninsn; i++)
+          {
+            counts[st->code[index + i].pc] +=
+              st->profile[st->code[index].pc];
+          }
+      }
+  }
+#endif
+
+  return counts;
+}
+
+/****************************************************************************
+ * Name: libexec_ReportOpcodes
+ ****************************************************************************/
+
+static void libexec_ReportOpcodes(struct libexec_s *st, FILE *report,
+                                  const uint64_t *counts, uint64_t total)
+{
+  uint64_t opCounts[256];
+  uint8_t  order[256];
+  pasSize_t pc;
+  int i;
+  int j;
+
+  memset(opCounts, 0, sizeof(opCounts));
+  for (pc = 0; pc < st->maxpc; pc += libexec_InsnSize(st->ispace[pc]))
+    {
+      opCounts[st->ispace[pc]] += counts[pc];
+    }
+
+  /* Sort the opcodes by count (insertion sort of 256 entries) */
+
+  for (i = 0; i < 256; i++)
+    {
+      for (j = i; j > 0 && opCounts[order[j - 1]] < opCounts[i]; j--)
+        {
+          order[j] = order[j - 1];
+        }
+
+      order[j] = i;
+    }
+
+  fprintf(report, "\nOpcodes:\n");
+  fprintf(report, "%12s %7s  %s\n", "COUNT", "%", "OPCODE");
+
+  for (i = 0; i < 256 && opCounts[order[i]] > 0; i++)
+    {
+      fprintf(report, "%12" PRIu64 " %6.2f%%  %s\n",
+              opCounts[order[i]], PERCENT(opCounts[order[i]], total),
+              insn_GetOpCodeName(order[i]));
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_FindProcedures
+ *
+ * Description:
+ *   Return the code regions of the procedures sorted by start address, and
+ *   the number of regions in 'nregions'.  The procedure entry points are
+ *   the program entry point and the targets of all oPCAL instructions.  The
+ *   code of a procedure with nested procedures begins with a jump over the
+ *   nested procedures to the body, so the jump target also starts a region
+ *   of the procedure.  Each instruction belongs to the closest region start
+ *   at or below its address.
+ *
+ ****************************************************************************/
+
+static struct libexec_procProfile_s *
+libexec_FindProcedures(struct libexec_s *st, unsigned int *nregions)
+{
+  struct libexec_procProfile_s *procs;
+  unsigned int nprocs;
+  unsigned int i;
+  unsigned int j;
+  pasSize_t entry;
+  pasSize_t pc;
+  uint8_t opcode;
+
+  /* Count the procedures.  Each may have two regions. */
+
+  nprocs = 1;
+  for (pc = 0; pc < st->maxpc; pc += libexec_InsnSize(opcode))
+    {
+      opcode = st->ispace[pc];
+      if (opcode == oPCAL)
+        {
+          nprocs++;
+        }
+    }
+
+  procs = (struct libexec_procProfile_s *)
+    calloc(2 * nprocs, sizeof(struct libexec_procProfile_s));
+  if (procs == NULL)
+    {
+      return NULL;
+    }
+
+  /* Collect the entry points */
+
+  procs[0].start = st->entry;
+  procs[0].entry = st->entry;
+  nprocs = 1;
+
+  for (pc = 0; pc < st->maxpc; pc += libexec_InsnSize(opcode))
+    {
+      opcode = st->ispace[pc];
+      if (opcode == oPCAL && pc + 3 < st->maxpc)
+        {
+          entry = (pasSize_t)st->ispace[pc + 2] << 8 | st->ispace[pc + 3];
+          procs[nprocs].start   = entry;
+          procs[nprocs++].entry = entry;
+        }
+    }
+
+  /* Sort them and remove duplicates */
+
+  qsort(procs, nprocs, sizeof(struct libexec_procProfile_s),
+        libexec_CompareProcStart);
+
+  for (i = 1, j = 1; i < nprocs; i++)
+    {
+      if (procs[i].start != procs[j - 1].start)
+        {
+          procs[j++] = procs[i];
+        }
+    }
+
+  nprocs = j;
+
+  /* Add the body of each procedure that begins with a jump */
+
+  for (i = 0, j = nprocs; i < nprocs; i++)
+    {
+      entry = procs[i].entry;
+      if (entry + 2 < st->maxpc && st->ispace[entry] == oJMP)
+        {
+          procs[j].start   = (pasSize_t)st->ispace[entry + 1] << 8 |
+                             st->ispace[entry + 2];
+          procs[j++].entry = entry;
+        }
+    }
+
+  qsort(procs, j, sizeof(struct libexec_procProfile_s),
+        libexec_CompareProcStart);
+
+  *nregions = j;
+  return procs;
+}
+
+/****************************************************************************
+ * Name: libexec_FindRegion
+ *
+ * Description:
+ *   Return the index of the procedure region that holds 'pc'.
+ *
+ ****************************************************************************/
+
+static unsigned int
+libexec_FindRegion(const struct libexec_procProfile_s *procs,
+                   unsigned int nregions, pasSize_t pc)
+{
+  unsigned int lower = 0;
+  unsigned int upper = nregions;
+  unsigned int mid;
+
+  while (upper - lower > 1)
+    {
+      mid = (lower + upper) >> 1;
+      if (procs[mid].start <= pc)
+        {
+          lower = mid;
+        }
+      else
+        {
+          upper = mid;
+        }
+    }
+
+  return lower;
+}
+
+/****************************************************************************
+ * Name: libexec_MergeRegions
+ *
+ * Description:
+ *   Combine the regions of each procedure, adding their counts.  The
+ *   result is sorted by entry point and the start of each entry is that of
+ *   the procedure body.  Returns the number of procedures.
+ *
+ ****************************************************************************/
+
+static unsigned int
+libexec_MergeRegions(struct libexec_procProfile_s *procs,
+                     unsigned int nregions)
+{
+  unsigned int i;
+  unsigned int j;
+
+  if (nregions == 0)
+    {
+      return 0;
+    }
+
+  qsort(procs, nregions, sizeof(struct libexec_procProfile_s),
+        libexec_CompareProcEntry);
+
+  for (i = 1, j = 1; i < nregions; i++)
+    {
+      if (procs[i].entry != procs[j - 1].entry)
+        {
+          procs[j++] = procs[i];
+        }
+      else
+        {
+          procs[j - 1].count += procs[i].count;
+          if (procs[i].start > procs[j - 1].start)
+            {
+              procs[j - 1].start = procs[i].start;
+            }
+        }
+    }
+
+  return j;
+}
+
+/****************************************************************************
+ * Name: libexec_ReportProcedures
+ *
+ * Description:
+ *   Report the instructions executed in each procedure (not including the
+ *   procedures that it calls).
+ *
+ ****************************************************************************/
+
+static void libexec_ReportProcedures(struct libexec_s *st, FILE *report,
+                                     const uint64_t *counts, uint64_t total)
+{
+  struct libexec_procProfile_s *procs;
+  poffLibDebugFuncInfo_t *funcInfo;
+  unsigned int nprocs;
+  unsigned int i;
+  pasSize_t pc;
+
+  procs = libexec_FindProcedures(st, &nprocs);
+  if (procs == NULL)
+    {
+      return;
+    }
+
+  /* Credit each instruction to its region */
+
+  for (pc = 0; pc < st->maxpc; pc++)
+    {
+      if (counts[pc] != 0)
+        {
+          procs[libexec_FindRegion(procs, nprocs, pc)].count += counts[pc];
+        }
+    }
+
+  nprocs = libexec_MergeRegions(procs, nprocs);
+  qsort(procs, nprocs, sizeof(struct libexec_procProfile_s),
+        libexec_CompareProcCount);
+
+  fprintf(report, "\nProcedures:\n");
+  fprintf(report, "%12s %7s  %-6s  %s\n", "COUNT", "%", "ENTRY", "SOURCE");
+
+  for (i = 0; i < nprocs && procs[i].count > 0; i++)
+    {
+      fprintf(report, "%12" PRIu64 " %6.2f%%  0x%04x  ",
+              procs[i].count, PERCENT(procs[i].count, total),
+              procs[i].entry);
+      libexec_ProcedureLocation(st, report, procs[i].start);
+
+      if (procs[i].entry == st->entry)
+        {
+          fprintf(report, " (main program)");
+        }
+
+      funcInfo = poffFindDebugFuncInfo(procs[i].entry);
+      if (funcInfo != NULL)
+        {
+          fprintf(report, " (%" PRIu32 " parameters, %" PRIu32
+                  " byte result)", funcInfo->nparms, funcInfo->retsize);
+        }
+
+      fputc('\n', report);
+    }
+
+  free(procs);
+}
+
+/****************************************************************************
+ * Name: libexec_ReportLines
+ ****************************************************************************/
+
+static void libexec_ReportLines(struct libexec_s *st, FILE *report,
+                                const uint64_t *counts, uint64_t total)
+{
+  struct libexec_lineProfile_s *lines;
+  poffLibLineNumber_t *lineno;
+  unsigned int nlines;
+  unsigned int i;
+  pasSize_t pc;
+
+  lines = (struct libexec_lineProfile_s *)
+    calloc(st->maxpc + 1, sizeof(struct libexec_lineProfile_s));
+  if (lines == NULL)
+    {
+      return;
+    }
+
+  /* Credit each instruction to its source line */
+
+  nlines = 0;
+  for (pc = 0; pc < st->maxpc; pc++)
+    {
+      if (counts[pc] == 0)
+        {
+          continue;
+        }
+
+      lineno = poffFindLineNumber(pc);
+      if (lineno == NULL)
+        {
+          continue;
+        }
+
+      for (i = 0; i < nlines; i++)
+        {
+          if (lines[i].lineno == lineno->lineno &&
+              lines[i].fileName == lineno->filename)
+            {
+              break;
+            }
+        }
+
+      if (i == nlines)
+        {
+          lines[i].fileName = lineno->filename;
+          lines[i].lineno   = lineno->lineno;
+          nlines++;
+        }
+
+      lines[i].count += counts[pc];
+    }
+
+  qsort(lines, nlines, sizeof(struct libexec_lineProfile_s),
+        libexec_CompareLineCount);
+
+  fprintf(report, "\nSource lines:\n");
+  fprintf(report, "%12s %7s  %s\n", "COUNT", "%", "SOURCE");
+
+  for (i = 0; i < nlines; i++)
+    {
+      fprintf(report, "%12" PRIu64 " %6.2f%%  %s:%" PRIu32 "\n",
+              lines[i].count, PERCENT(lines[i].count, total),
+              lines[i].fileName, lines[i].lineno);
+    }
+
+  free(lines);
+}
+
+/****************************************************************************
+ * Name: libexec_ReportHotInsns
+ ****************************************************************************/
+
+static void libexec_ReportHotInsns(struct libexec_s *st, FILE *report,
+                                   const uint64_t *counts, uint64_t total)
+{
+  pasSize_t hot[MAX_HOT_INSNS];
+  opType_t op;
+  int nhot;
+  int i;
+  pasSize_t pc;
+
+  /* Keep the MAX_HOT_INSNS most executed addresses in order */
+
+  nhot = 0;
+  for (pc = 0; pc < st->maxpc; pc += libexec_InsnSize(st->ispace[pc]))
+    {
+      if (counts[pc] == 0 ||
+          (nhot == MAX_HOT_INSNS && counts[hot[nhot - 1]] >= counts[pc]))
+        {
+          continue;
+        }
+
+      if (nhot < MAX_HOT_INSNS)
+        {
+          nhot++;
+        }
+
+      for (i = nhot - 1; i > 0 && counts[hot[i - 1]] < counts[pc]; i--)
+        {
+          hot[i] = hot[i - 1];
+        }
+
+      hot[i] = pc;
+    }
+
+  fprintf(report, "\nHot instructions:\n");
+  fprintf(report, "%12s %7s  %-6s  %s\n", "COUNT", "%", "PC", "INSTRUCTION");
+
+  for (i = 0; i < nhot; i++)
+    {
+      pc      = hot[i];
+      op.op   = st->ispace[pc];
+      op.arg1 = 0;
+      op.arg2 = 0;
+
+      if ((op.op & o8) != 0)
+        {
+          op.arg1 = st->ispace[pc + 1];
+          if ((op.op & o16) != 0)
+            {
+              op.arg2 = (uint16_t)st->ispace[pc + 2] << 8 |
+                        st->ispace[pc + 3];
+            }
+        }
+      else if ((op.op & o16) != 0)
+        {
+          op.arg2 = (uint16_t)st->ispace[pc + 1] << 8 | st->ispace[pc + 2];
+        }
+
+      fprintf(report, "%12" PRIu64 " %6.2f%%  0x%04x",
+              counts[pc], PERCENT(counts[pc], total), pc);
+      insn_DisassemblePCode(report, &op);
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_HashFrames
+ ****************************************************************************/
+
+static uint32_t libexec_HashFrames(const pasSize_t *frames, uint32_t depth)
+{
+  uint32_t hash = 2166136261u;
+  uint32_t i;
+
+  for (i = 0; i < depth; i++)
+    {
+      hash = (hash ^ frames[i]) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: libexec_GrowIndex
+ *
+ * Description:
+ *   Double the size of the stack hash table and re-enter all stacks.
+ *
+ ****************************************************************************/
+
+static int libexec_GrowIndex(struct libexec_sampler_s *sampler)
+{
+  uint32_t newSize = sampler->indexSize << 1;
+  uint32_t *index;
+  uint32_t slot;
+  uint32_t i;
+
+  index = (uint32_t *)calloc(newSize, sizeof(uint32_t));
+  if (index == NULL)
+    {
+      return eNOMEMORY;
+    }
+
+  for (i = 0; i < sampler->nstacks; i++)
+    {
+      slot = sampler->stacks[i].hash & (newSize - 1);
+      while (index[slot] != 0)
+        {
+          slot = (slot + 1) & (newSize - 1);
+        }
+
+      index[slot] = i + 1;
+    }
+
+  free(sampler->index);
+  sampler->index     = index;
+  sampler->indexSize = newSize;
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_AddStack
+ *
+ * Description:
+ *   Count one sample of the call stack in sampler->scratch[].
+ *
+ ****************************************************************************/
+
+static void libexec_AddStack(struct libexec_sampler_s *sampler,
+                             uint32_t depth)
+{
+  struct libexec_stack_s *stack;
+  uint32_t hash;
+  uint32_t slot;
+
+  hash = libexec_HashFrames(sampler->scratch, depth);
+  slot = hash & (sampler->indexSize - 1);
+
+  while (sampler->index[slot] != 0)
+    {
+      stack = &sampler->stacks[sampler->index[slot] - 1];
+      if (stack->hash == hash && stack->depth == depth &&
+          memcmp(stack->frames, sampler->scratch,
+                 depth * sizeof(pasSize_t)) == 0)
+        {
+          stack->count++;
+          return;
+        }
+
+      slot = (slot + 1) & (sampler->indexSize - 1);
+    }
+
+  /* This is a new stack.  The sample is lost if there is no memory. */
+
+  if (sampler->nstacks >= sampler->maxStacks)
+    {
+      stack = (struct libexec_stack_s *)
+        realloc(sampler->stacks,
+                2 * sampler->maxStacks * sizeof(struct libexec_stack_s));
+      if (stack == NULL)
+        {
+          return;
+        }
+
+      sampler->stacks     = stack;
+      sampler->maxStacks *= 2;
+    }
+
+  stack         = &sampler->stacks[sampler->nstacks];
+  stack->frames = (pasSize_t *)malloc(depth * sizeof(pasSize_t));
+  if (stack->frames == NULL)
+    {
+      return;
+    }
+
+  memcpy(stack->frames, sampler->scratch, depth * sizeof(pasSize_t));
+  stack->hash  = hash;
+  stack->count = 1;
+  stack->depth = depth;
+
+  sampler->index[slot] = ++sampler->nstacks;
+
+  /* Keep the hash table no more than half full */
+
+  if (2 * sampler->nstacks >= sampler->indexSize)
+    {
+      (void)libexec_GrowIndex(sampler);
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_FreeSampler
+ ****************************************************************************/
+
+static void libexec_FreeSampler(struct libexec_sampler_s *sampler)
+{
+  uint32_t i;
+
+  if (sampler != NULL)
+    {
+      for (i = 0; i < sampler->nstacks; i++)
+        {
+          free(sampler->stacks[i].frames);
+        }
+
+      free(sampler->procs);
+      free(sampler->stacks);
+      free(sampler->index);
+      free(sampler->scratch);
+      free(sampler);
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_ReportFrame
+ *
+ * Description:
+ *   Write the name of a procedure in a collapsed stack.  The name is the
+ *   entry point and the source location of the procedure body.
+ *
+ ****************************************************************************/
+
+static void libexec_ReportFrame(struct libexec_s *st, FILE *report,
+                                const struct libexec_procProfile_s *procs,
+                                unsigned int nprocs, pasSize_t entry)
+{
+  unsigned int lower = 0;
+  unsigned int upper = nprocs;
+  unsigned int mid;
+
+  if (entry == st->entry)
+    {
+      fprintf(report, "main");
+    }
+  else
+    {
+      fprintf(report, "0x%04x", entry);
+    }
+
+  /* Find the procedure body (procs[] is sorted by entry point) */
+
+  while (lower < upper)
+    {
+      mid = (lower + upper) >> 1;
+      if (procs[mid].entry < entry)
+        {
+          lower = mid + 1;
+        }
+      else
+        {
+          upper = mid;
+        }
+    }
+
+  if (lower < nprocs && procs[lower].entry == entry)
+    {
+      fputc(' ', report);
+      libexec_ProcedureLocation(st, report, procs[lower].start);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_ReadDebugInfo
+ *
+ * Description:
+ *   Read the line number and debug function information, if any, from the
+ *   executable file into the global libpoff tables.  The returned handle
+ *   must be passed to libexec_ReleaseDebugInfo().
+ *
+ ****************************************************************************/
+
+poffHandle_t libexec_ReadDebugInfo(struct libexec_s *st)
+{
+  poffHandle_t phandle = NULL;
+  FILE *exe;
+
+  exe = fopen(st->image->fileName, "rb");
+  if (exe != NULL)
+    {
+      phandle = poffCreateHandle();
+      if (phandle != NULL && poffReadFile(phandle, exe) == eNOERROR)
+        {
+          poffReadLineNumberTable(phandle);
+          poffReadDebugFuncInfoTable(phandle);
+        }
+
+      fclose(exe);
+    }
+
+  return phandle;
+}
+
+/****************************************************************************
+ * Name: libexec_ReleaseDebugInfo
+ ****************************************************************************/
+
+void libexec_ReleaseDebugInfo(poffHandle_t phandle)
+{
+  if (phandle != NULL)
+    {
+      poffReleaseLineNumberTable();
+      poffReleaseDebugFuncInfoTable();
+      poffDestroyHandle(phandle);
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_EnableProfile
+ *
+ * Description:
+ *   Start counting the executions of each instruction.
+ *
+ ****************************************************************************/
+
+int libexec_EnableProfile(EXEC_HANDLE_t handle)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+
+  if (st->profile == NULL)
+    {
+      st->profile = (uint32_t *)calloc(st->maxpc + 1, sizeof(uint32_t));
+      if (st->profile == NULL)
+        {
+          return eNOMEMORY;
+        }
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_ProfileReport
+ *
+ * Description:
+ *   Write the execution profile collected since libexec_EnableProfile() to
+ *   'report'.  Execution counts are reported by opcode, by procedure, and
+ *   by source line, followed by the most executed instructions.  Procedure
+ *   and line information is read from the line number and debug function
+ *   sections of the executable file.
+ *
+ *   The libpoff line number and debug information tables are global, so
+ *   this must not be called concurrently from more than one thread.
+ *
+ ****************************************************************************/
+
+void libexec_ProfileReport(EXEC_HANDLE_t handle, FILE *report)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  poffHandle_t phandle;
+  uint64_t *counts;
+  uint64_t dispatches;
+  uint64_t total;
+  pasSize_t pc;
+
+  if (st->profile == NULL)
+    {
+      return;
+    }
+
+  counts = libexec_GetCounts(st);
+  if (counts == NULL)
+    {
+      return;
+    }
+
+  for (pc = 0, dispatches = 0, total = 0; pc < st->maxpc; pc++)
+    {
+      dispatches += st->profile[pc];
+      total      += counts[pc];
+    }
+
+  /* Read the line number and debug information, if any, from the
+   * executable file.
+   */
+
+  phandle = libexec_ReadDebugInfo(st);
+
+  fprintf(report, "Profile of %s\n", st->image->fileName);
+  fprintf(report, "  %" PRIu64 " instructions executed in %" PRIu64
+          " dispatches\n", total, dispatches);
+
+  libexec_ReportOpcodes(st, report, counts, total);
+  libexec_ReportProcedures(st, report, counts, total);
+  libexec_ReportLines(st, report, counts, total);
+  libexec_ReportHotInsns(st, report, counts, total);
+
+  libexec_ReleaseDebugInfo(phandle);
+  free(counts);
+}
+
+/****************************************************************************
+ * Name: libexec_EnableSampling
+ *
+ * Description:
+ *   Start sampling the Pascal call stack about every 'interval'
+ *   instructions executed by libexec_RunLoop().  The interval between
+ *   samples is varied randomly by up to a quarter of 'interval' in either
+ *   direction so that the samples do not fall in step with loops in the
+ *   program.
+ *
+ ****************************************************************************/
+
+int libexec_EnableSampling(EXEC_HANDLE_t handle, uint32_t interval)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  struct libexec_sampler_s *sampler;
+
+  if (st->sampler != NULL)
+    {
+      st->sampleInterval = interval > 0 ? interval : 1;
+      return eNOERROR;
+    }
+
+  sampler = (struct libexec_sampler_s *)
+    calloc(1, sizeof(struct libexec_sampler_s));
+  if (sampler == NULL)
+    {
+      return eNOMEMORY;
+    }
+
+  /* A frame is at least _FSIZE bytes, so that bounds the depth of the
+   * call stack.
+   */
+
+  sampler->maxDepth  = st->stkSize / _FSIZE + 1;
+  sampler->maxStacks = INITIAL_STACKS;
+  sampler->indexSize = 2 * INITIAL_STACKS;
+  sampler->seed      = 2463534242u;
+
+  sampler->procs     = libexec_FindProcedures(st, &sampler->nregions);
+  sampler->stacks    = (struct libexec_stack_s *)
+    malloc(INITIAL_STACKS * sizeof(struct libexec_stack_s));
+  sampler->index     = (uint32_t *)
+    calloc(2 * INITIAL_STACKS, sizeof(uint32_t));
+  sampler->scratch   = (pasSize_t *)
+    malloc(sampler->maxDepth * sizeof(pasSize_t));
+
+  if (sampler->procs == NULL || sampler->stacks == NULL ||
+      sampler->index == NULL || sampler->scratch == NULL)
+    {
+      libexec_FreeSampler(sampler);
+      return eNOMEMORY;
+    }
+
+  st->sampler        = sampler;
+  st->sampleInterval = interval > 0 ? interval : 1;
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_TakeSample
+ *
+ * Description:
+ *   Record the current Pascal call stack.  The stack is found by following
+ *   the dynamic links of the frames from the current frame out to the
+ *   frame of the main program.  Each frame is identified by the procedure
+ *   that holds the return address of the next inner frame, or the current
+ *   PC for the innermost frame.
+ *
+ * Returned Value:
+ *   The number of instructions to execute before the next sample.
+ *
+ ****************************************************************************/
+
+uint32_t libexec_TakeSample(struct libexec_s *st)
+{
+  struct libexec_sampler_s *sampler = st->sampler;
+  const ustack_t *frame;
+  pasSize_t outer;
+  pasSize_t fp;
+  pasSize_t pc;
+  pasSize_t tmp;
+  uint32_t interval;
+  uint32_t depth;
+  uint32_t i;
+
+  /* The frame of the main program lies just below the stack base */
+
+  outer = st->spb - _FSIZE;
+  fp    = st->fp;
+  pc    = st->pc;
+  depth = 0;
+
+  while (depth < sampler->maxDepth)
+    {
+      i = libexec_FindRegion(sampler->procs, sampler->nregions, pc);
+      sampler->scratch[depth++] = sampler->procs[i].entry;
+
+      /* Stop at the main program.  The dynamic links must lead outward. */
+
+      frame = &st->dstack.i[BTOISTACK(fp)];
+      if (fp <= outer || frame[BTOISTACK(_FDLINK)] >= fp)
+        {
+          break;
+        }
+
+      pc = frame[BTOISTACK(_FRET)] - 1;
+      fp = frame[BTOISTACK(_FDLINK)];
+    }
+
+  /* Put the outermost frame first */
+
+  for (i = 0; i < depth / 2; i++)
+    {
+      tmp                             = sampler->scratch[i];
+      sampler->scratch[i]             = sampler->scratch[depth - 1 - i];
+      sampler->scratch[depth - 1 - i] = tmp;
+    }
+
+  libexec_AddStack(sampler, depth);
+
+  /* Pick the next interval */
+
+  interval = st->sampleInterval;
+  if (interval >= 4)
+    {
+      sampler->seed ^= sampler->seed << 13;
+      sampler->seed ^= sampler->seed >> 17;
+      sampler->seed ^= sampler->seed << 5;
+
+      interval = interval - interval / 4 +
+                 sampler->seed % (interval / 2 + 1);
+    }
+
+  return interval;
+}
+
+/****************************************************************************
+ * Name: libexec_SampleReport
+ *
+ * Description:
+ *   Write the call stacks recorded since libexec_EnableSampling() to
+ *   'report' in the collapsed stack format used by flame graph tools:  one
+ *   line per distinct stack, with the procedures from the outermost to the
+ *   innermost separated by semicolons, followed by the number of samples.
+ *   The number of samples of a procedure on all stacks is proportional to
+ *   its inclusive execution time.
+ *
+ *   The libpoff line number and debug information tables are global, so
+ *   this must not be called concurrently from more than one thread.
+ *
+ ****************************************************************************/
+
+void libexec_SampleReport(EXEC_HANDLE_t handle, FILE *report)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  struct libexec_sampler_s *sampler = st->sampler;
+  struct libexec_procProfile_s *procs;
+  struct libexec_stack_s *stack;
+  poffHandle_t phandle;
+  unsigned int nprocs;
+  uint32_t i;
+  uint32_t j;
+
+  if (sampler == NULL)
+    {
+      return;
+    }
+
+  /* Get the body of each procedure for its source location */
+
+  procs = libexec_FindProcedures(st, &nprocs);
+  if (procs == NULL)
+    {
+      return;
+    }
+
+  nprocs  = libexec_MergeRegions(procs, nprocs);
+  phandle = libexec_ReadDebugInfo(st);
+
+  for (i = 0; i < sampler->nstacks; i++)
+    {
+      stack = &sampler->stacks[i];
+      for (j = 0; j < stack->depth; j++)
+        {
+          if (j > 0)
+            {
+              fputc(';', report);
+            }
+
+          libexec_ReportFrame(st, report, procs, nprocs, stack->frames[j]);
+        }
+
+      fprintf(report, " %" PRIu32 "\n", stack->count);
+    }
+
+  libexec_ReleaseDebugInfo(phandle);
+  free(procs);
+}
+
+/****************************************************************************
+ * Name: libexec_ReleaseProfile
+ *
+ * Description:
+ *   Free the execution profile, call stack samples, and heap profile of an
+ *   instance.
+ *
+ ****************************************************************************/
+
+void libexec_ReleaseProfile(struct libexec_s *st)
+{
+  free(st->profile);
+  libexec_FreeSampler(st->sampler);
+  libexec_ReleaseHeapProfile(st);
+
+  st->profile = NULL;
+  st->sampler = NULL;
+}
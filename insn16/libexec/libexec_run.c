@@ -64,203 +64,13 @@
 #include "libexec_stringlib.h"
 #include "libexec_oslib.h"
 #include "libexec_heap.h"
+#include "libexec_predecode.h"
 #include "libexec.h"
 
-/****************************************************************************
- * Pre-processor Definitions
- ****************************************************************************/
-
-/* Size of frame info at the beginning of each frame:
- *
- *        |  Base Address  | + 5 * BPERI
- *        +----------------+
- *        |  Nesting Level | + 4 * BPERI
- *        +----------------+
- *        |   Saved CSP    | + 3 * BPERI
- *        +----------------+
- *        | Return Address | + 2 * BPERI
- *        +----------------+
- *        |  Dynamic Link  | + BPERI
- *        +----------------+
- *  FP -> |  Static Link   | 0
- *        +----------------+
- */
-
-/* Offsets relative to the frame pointer */
-
-#define _FSLINK (0)
-#define _FDLINK (BPERI)
-#define _FRET   (2 * BPERI)
-#define _FCSP   (3 * BPERI)
-#define _FLEVEL (4 * BPERI)
-
-#define _FBASE  (5 * BPERI)
-#define _FSIZE  (5 * BPERI)
-
-/****************************************************************************
- * Private Function Prototypes
- ****************************************************************************/
-
-static int      libexec_ProcedureCall(struct libexec_s *st, level_t nestingLevel);
-static ustack_t libexec_GetBaseAddress(struct libexec_s *st, level_t levelOffset,
-                                       int32_t stackOffset);
-
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
-/****************************************************************************
- * Name: libexec_ProcedureCall
- *
- * Description:
- *   This function builds a new frame at the top of the stack as part of the
- *   procedure call logic.
- *
- ****************************************************************************/
-
-static int libexec_ProcedureCall(struct libexec_s *st, level_t nestingLevel)
-{
-  uint16_t *current;
-  uint16_t *previous;
-  uint16_t findLevel;
-  uint16_t frameAddr;
-  uint16_t prevLevel;
-  uint16_t newFP;
-
-  /* The nesting level should be some value greater than zero */
-
-  if (nestingLevel == 0)
-    {
-      return eNESTINGLEVEL;
-    }
-
-  /* We need to find the preceding nesting level */
-
-  findLevel = nestingLevel - 1;
-
-  /* Search back through the frames to find the correct frame for this static
-   * nesting level.  Normally this will be the previous frame, but we need
-   * to allow for support of recursion which forces us to search further back.
-   */
-
-  /* At this pointer st->fp refers to the calling frame. */
-
-  frameAddr = st->fp - _FSLINK;
-
-  for (; ; )
-    {
-      previous  = &st->dstack.i[BTOISTACK(frameAddr)];
-      prevLevel = previous[BTOISTACK(_FLEVEL)] & 0xff;
-
-      /* Protection against garbage (Stack corruption?) */
-
-      if (prevLevel > UINT8_MAX)
-        {
-          return eNESTINGLEVEL;
-        }
-
-      /* It would be an error if we went all the way to level 0 and never
-       * found the frame we are looking for.
-       */
-
-      else if (findLevel != 0 && prevLevel == 0)
-        {
-          return eNESTINGLEVEL;
-        }
-
-      /* Set up for the next time through the loop */
-
-      if (findLevel == prevLevel)
-        {
-          break;
-        }
-
-      frameAddr = previous[BTOISTACK(_FSLINK)] - _FSLINK;
-    }
-
-  /* Set up the new FRAME info.
-   *
-   *        |  Base Address  | + 5 * BPERI
-   *        +----------------+
-   *   lsp  |  Nesting Level | + 4 * BPERI
-   *        +----------------+
-   *        |   Saved CSP    | + 3 * BPERI
-   *        +----------------+
-   *        | Return Address | + 2 * BPERI
-   *        +----------------+
-   *        |  Dynamic Link  | + BPERI
-   *        +----------------+
-   *  FP -> |  Static Link   | 0
-   *        +----------------+
-   *  SP -> |  Caller TOS    |
-   */
-
-  st->sp                      += BPERI;
-  current                      = &st->dstack.i[BTOISTACK(st->sp)];
-  newFP                        = st->sp + _FSLINK;
-  st->sp                      += _FSIZE - BPERI;
-
-  current[BTOISTACK(_FSLINK)]  = frameAddr;
-  current[BTOISTACK(_FDLINK)]  = st->fp;
-  current[BTOISTACK(_FRET)]    = st->pc + 4;
-  current[BTOISTACK(_FCSP)]    = st->csp;
-  current[BTOISTACK(_FLEVEL)]  = st->lsp << 8 | nestingLevel;
-
-  st->lsp                      = nestingLevel;
-  st->fp                       = newFP;
-  return eNOERROR;
-}
-
-/****************************************************************************
- * Name: libexec_GetBaseAddress
- *
- * Description:
- *   This function binds the base address corresponding to a given level
- *   offset.  This establishes a static link that is used to access data
- *   in outer layers.
- *
- *   The static link is set on each procedure call.  It is accessed on load
- *   and store instructions as an offset from the current static nesting
- *   level.
- *
- ****************************************************************************/
-
-static ustack_t libexec_GetBaseAddress(struct libexec_s *st, level_t leveloffset,
-                                       int32_t stackOffset)
- {
-   /* Start with the base register of the current frame */
-
-  ustack_t frameBase = st->fp;
-
-  /* Search backware "leveloffset" frames until the correct frame is
-   * found
-   */
-
-   while (leveloffset > 0)
-     {
-       frameBase = st->dstack.i[BTOISTACK(frameBase)];
-       leveloffset--;
-     }
-
-   /* Offset that value to get the address of the stack region of interest.
-    * There are two disjoint regions:
-    *
-    *   1. At offset _FBASE 'above' the frame info.  Positive variable
-    *      offsets lie in this region.
-    *   2. 'Below" the frame is a return value areg of size sRETURN_SIZE
-    *      and then actual parameter values are below this.  Negative
-    *      stack offsets refer to this region.
-    */
-
-   frameBase += stackOffset;
-   if (stackOffset >= 0)
-     {
-       frameBase += _FBASE;
-     }
-
-   return frameBase;
-}
-
 /****************************************************************************
  * Name: pexec8
  *
@@ -665,14 +475,21 @@ static inline int pexec8(struct libexec_s *st, uint8_t opcode)
        *        |   Caller TOS   |
        */
 
+      uparm2 = st->fp;        /* The frame being released */
       POP(st, uparm1);        /* Restore the nesting level in the LSP */
       st->lsp = uparm1 >> 8;
+      RESTOREDISPLAY(st, uparm1 & 0xff, uparm2);
 
       POP(st, st->csp);       /* Restore the string stack pointer */
       POP(st, st->pc);        /* Set the PC to the return address */
       POP(st, st->fp);        /* Set the FP back to the dynamic link */
       DISCARD(st, 1);         /* Discard the static link */
-      return eNOERROR;
+
+      /* The return address is the one program counter value that is never
+       * verified.
+       */
+
+      return st->pc < st->maxpc ? eNOERROR : eBADPC;
 
       /* System Functions (No stack arguments) */
 
@@ -697,6 +514,9 @@ static inline int pexec8(struct libexec_s *st, uint8_t opcode)
 
 static inline int pexec16(struct libexec_s *st, uint8_t opcode, uint8_t imm8)
 {
+  ustack_t uparm1;
+  ustack_t uparm2;
+  ustack_t uparm3;
   int ret = eNOERROR;
 
   st->pc += 2;
@@ -728,6 +548,50 @@ static inline int pexec16(struct libexec_s *st, uint8_t opcode, uint8_t imm8)
       ret = libexec_OsOperations(st, imm8);
       break;
 
+      /* Set bit operations:  imm8 = set size in bytes.  The member is zero-
+       * based and must be less than the number of bits in the set.
+       */
+
+    case oSETIN :
+      POP(st, uparm1);               /* Set address */
+      uparm2 = TOS(st, 0);           /* Member */
+      if (uparm2 >= 8 * (ustack_t)imm8)
+        {
+          ret = eVALUERANGE;
+        }
+      else
+        {
+          uparm3     = GETSTACK(st, uparm1 + BPERI * (uparm2 >> 4));
+          TOS(st, 0) = ((uparm3 & (1 << (uparm2 & 0x0f))) != 0) ?
+                       PASCAL_TRUE : PASCAL_FALSE;
+        }
+      break;
+
+    case oSETINCL :
+    case oSETEXCL :
+      POP(st, uparm2);               /* Member */
+      POP(st, uparm1);               /* Set address */
+      if (uparm2 >= 8 * (ustack_t)imm8)
+        {
+          ret = eVALUERANGE;
+        }
+      else
+        {
+          uparm1 += BPERI * (uparm2 >> 4);
+          uparm3  = GETSTACK(st, uparm1);
+          if (opcode == oSETINCL)
+            {
+              uparm3 |= (1 << (uparm2 & 0x0f));
+            }
+          else
+            {
+              uparm3 &= ~(1 << (uparm2 & 0x0f));
+            }
+
+          PUTSTACK(st, uparm3, uparm1);
+        }
+      break;
+
     case oLONGOP8 :
       ret = libexec_LongOperation8(st, (enum longOp8_e)imm8);
       break;
@@ -1108,6 +972,13 @@ static inline int pexec24(struct libexec_s *st, uint8_t opcode,
 
     case oSYSIO :
       ret = libexec_sysio(st, imm16);
+
+      /* Repeat the operation on the next call if input is not available */
+
+      if (ret == eWOULDBLOCK)
+        {
+          return ret;
+        }
       break;
 
       /* Program control:  imm16 = unsigned data offset (no stack arguments) */
@@ -1365,12 +1236,135 @@ static int pexec32(struct libexec_s *st, uint8_t opcode, uint8_t imm8,
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: libexec_ProcedureCall
+ *
+ * Description:
+ *   This function builds a new frame at the top of the stack as part of the
+ *   procedure call logic.
+ *
+ ****************************************************************************/
+
+int libexec_ProcedureCall(struct libexec_s *st, level_t nestingLevel)
+{
+  uint16_t *current;
+  uint16_t frameAddr;
+  uint16_t newFP;
+
+  /* The nesting level should be some value greater than zero.  The called
+   * procedure must also be visible from the caller:  It may be nested at
+   * most one level deeper than the caller.
+   */
+
+  if (nestingLevel == 0 || nestingLevel > st->lsp + 1)
+    {
+      return eNESTINGLEVEL;
+    }
+
+  /* The static link is the frame of the preceding nesting level.  Normally
+   * this will be the previous frame, but recursion and calls to procedures
+   * in outer scopes may place it further back.  The display holds it
+   * regardless.
+   */
+
+  frameAddr = st->display[nestingLevel - 1];
+
+  /* Set up the new FRAME info.
+   *
+   *        |  Base Address  | + 5 * BPERI
+   *        +----------------+
+   *   lsp  |  Nesting Level | + 4 * BPERI
+   *        +----------------+
+   *        |   Saved CSP    | + 3 * BPERI
+   *        +----------------+
+   *        | Return Address | + 2 * BPERI
+   *        +----------------+
+   *        |  Dynamic Link  | + BPERI
+   *        +----------------+
+   *  FP -> |  Static Link   | 0
+   *        +----------------+
+   *  SP -> |  Caller TOS    |
+   */
+
+  st->sp                      += BPERI;
+  current                      = &st->dstack.i[BTOISTACK(st->sp)];
+  newFP                        = st->sp + _FSLINK;
+  st->sp                      += _FSIZE - BPERI;
+
+  current[BTOISTACK(_FSLINK)]  = frameAddr;
+  current[BTOISTACK(_FDLINK)]  = st->fp;
+  current[BTOISTACK(_FRET)]    = st->pc + 4;
+  current[BTOISTACK(_FCSP)]    = st->csp;
+  current[BTOISTACK(_FLEVEL)]  = st->lsp << 8 | nestingLevel;
+
+  st->lsp                      = nestingLevel;
+  st->fp                       = newFP;
+
+  /* Enter the new frame in the display.  The replaced entry is restored
+   * when the frame returns.
+   */
+
+  st->dsave[DSAVEINDEX(st, newFP)] = st->display[nestingLevel];
+  st->display[nestingLevel]        = newFP;
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_GetBaseAddress
+ *
+ * Description:
+ *   This function binds the base address corresponding to a given level
+ *   offset.  This establishes a static link that is used to access data
+ *   in outer layers.
+ *
+ *   The display is updated on each procedure call and return.  It is
+ *   accessed on load and store instructions as an offset from the current
+ *   static nesting level.
+ *
+ ****************************************************************************/
+
+ustack_t libexec_GetBaseAddress(struct libexec_s *st, level_t leveloffset,
+                                int32_t stackOffset)
+ {
+   /* Get the base register of the frame "leveloffset" levels out from the
+    * current frame.
+    */
+
+   ustack_t frameBase;
+
+   if (leveloffset > st->lsp)
+     {
+       leveloffset = st->lsp;
+     }
+
+   frameBase = st->display[st->lsp - leveloffset];
+
+   /* Offset that value to get the address of the stack region of interest.
+    * There are two disjoint regions:
+    *
+    *   1. At offset _FBASE 'above' the frame info.  Positive variable
+    *      offsets lie in this region.
+    *   2. 'Below" the frame is a return value areg of size sRETURN_SIZE
+    *      and then actual parameter values are below this.  Negative
+    *      stack offsets refer to this region.
+    */
+
+   frameBase += stackOffset;
+   if (stackOffset >= 0)
+     {
+       frameBase += _FBASE;
+     }
+
+   return frameBase;
+}
+
 /****************************************************************************
  * Name: libexec_Initialize
  ****************************************************************************/
 
 struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
 {
+  struct libexec_image_s *image;
   struct libexec_s *st;
   pasSize_t stackSize;
   pasSize_t adjustedStrSize;
@@ -1386,15 +1380,22 @@ struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
       return NULL;
     }
 
-  /* Set up I-Space */
+  /* Set up I-Space from the shared program image */
 
-  st->ispace = attr->ispace;
-  st->maxpc  = attr->maxpc;
+  image      = attr->image;
+  st->image  = image;
+  st->ispace = image->ispace;
+  st->maxpc  = image->maxpc;
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  st->code    = image->code;
+  st->pcIndex = image->pcIndex;
+  st->ninsn   = image->ninsn;
+#endif
 
   /* Align sizes of memory regions to 16-bit boundaries. */
 
   adjustedStrSize  = INT_ALIGNUP(attr->strSize);
-  adjustedRoSize   = INT_ALIGNUP(attr->roSize);
+  adjustedRoSize   = INT_ALIGNUP(image->roSize);
   adjustedStkSize  = INT_ALIGNUP(attr->stkSize);
   adjustedHpSize   = INT_ALIGNUP(attr->hpSize);
 
@@ -1411,11 +1412,39 @@ struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
       return NULL;
     }
 
+  /* Allocate one display save slot for each possible frame */
+
+  st->dsave = (pasSize_t *)malloc((stackSize / _FSIZE + 1) *
+                                  sizeof(pasSize_t));
+  if (st->dsave == NULL)
+    {
+      free(st->dstack.b);
+      free(st);
+      return NULL;
+    }
+
+  /* Allocate the initial file table.  It will grow as files are
+   * allocated.
+   */
+
+  st->fileTable = (execFileTable_t *)calloc(MAX_OPEN_FILES,
+                                            sizeof(execFileTable_t));
+  if (st->fileTable == NULL)
+    {
+      free(st->dsave);
+      free(st->dstack.b);
+      free(st);
+      return NULL;
+    }
+
+  st->nFiles   = MAX_OPEN_FILES;
+  st->mapFiles = false;
+
   /* Copy the rodata into the stack */
 
-  if (attr->rodata != NULL && attr->roSize > 0)
+  if (image->rodata != NULL && image->roSize > 0)
     {
-      memcpy(&st->dstack.b[attr->strSize], attr->rodata, attr->roSize);
+      memcpy(&st->dstack.b[attr->strSize], image->rodata, image->roSize);
     }
 
   /* Set up info needed to perform a simulated reset */
@@ -1426,11 +1455,17 @@ struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
   st->hpSize       = adjustedHpSize;
   st->stackSize    = stackSize;
 
-  st->entry        = attr->entry;
+  st->entry        = image->entry;
 
   /* Set certain critical variables to a known state */
 
-  st->freeChunks   = 0;
+  st->freeMap      = 0;
+#ifdef CONFIG_PASCAL_PROFILER
+  st->profile      = NULL;
+  st->sampler      = NULL;
+  st->sampleInterval = 0;
+  st->heapProfile  = NULL;
+#endif
 #ifdef CONFIG_PASCAL_DEBUGGER
   st->lastCmd      = eCMD_NONE;
   st->traceIndex   = 0;
@@ -1441,7 +1476,8 @@ struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
   st->bExecStop    = 0;
 #endif
 
-  memset(st->fileTable, 0, MAX_OPEN_FILES * sizeof(execFileTable_t));
+  st->input        = stdin;
+  st->output       = stdout;
 
   /* Then perform a simulated reset */
 
@@ -1450,66 +1486,88 @@ struct libexec_s *libexec_Initialize(struct libexec_attr_s *attr)
 }
 
 /****************************************************************************
- * Name: libexec_Execute
+ * Name: libexec_ExecuteVerified
+ *
+ * Description:
+ *   Execute one instruction of a verified program (see libexec_Verify()).
+ *   The program counter is not checked:  Verification guarantees that it
+ *   always holds the address of an instruction in I-Space.
+ *
  ****************************************************************************/
 
-int libexec_Execute(struct libexec_s *st)
+int libexec_ExecuteVerified(struct libexec_s *st)
 {
   uint8_t opcode;
-  int ret;
 
-  /* Make sure that the program counter is within range */
-
-  if (st->pc >= st->maxpc)
+#ifdef CONFIG_PASCAL_PROFILER
+  if (st->profile != NULL)
     {
-      ret = eBADPC;
+      st->profile[st->pc]++;
     }
-  else
-    {
-      /* Get the instruction to execute */
-
-      opcode = st->ispace[st->pc];
-      if ((opcode & o8) != 0)
-        {
-          /* Get the immediate, 8-bit value */
-
-          uint8_t imm8 = st->ispace[st->pc + 1];
-          if ((opcode & o16) != 0)
-            {
-              /* Get the immediate, big-endian 16-bit value */
-
-              uint16_t imm16  = ((st->ispace[st->pc + 2]) << 8) | st->ispace[st->pc + 3];
+#endif
 
-              /* Handle 32 bit instructions */
+  /* Get the instruction to execute */
 
-              ret = pexec32(st, opcode, imm8, imm16);
-            }
-          else
-            {
-              /* Handle 16-bit instructions */
+  opcode = st->ispace[st->pc];
+  if ((opcode & o8) != 0)
+    {
+      /* Get the immediate, 8-bit value */
 
-              ret = pexec16(st, opcode, imm8);
-            }
-        }
-      else if ((opcode & o16) != 0)
+      uint8_t imm8 = st->ispace[st->pc + 1];
+      if ((opcode & o16) != 0)
         {
           /* Get the immediate, big-endian 16-bit value */
 
-          uint16_t imm16  = ((st->ispace[st->pc + 1]) << 8) | st->ispace[st->pc + 2];
+          uint16_t imm16  = ((st->ispace[st->pc + 2]) << 8) | st->ispace[st->pc + 3];
 
-          /* Handle 24-bit instructions */
+          /* Handle 32 bit instructions */
 
-          ret = pexec24(st, opcode, imm16);
+          return pexec32(st, opcode, imm8, imm16);
         }
       else
         {
-          /* Handle 8-bit instructions */
+          /* Handle 16-bit instructions */
 
-          ret = pexec8(st, opcode);
+          return pexec16(st, opcode, imm8);
         }
     }
+  else if ((opcode & o16) != 0)
+    {
+      /* Get the immediate, big-endian 16-bit value */
+
+      uint16_t imm16  = ((st->ispace[st->pc + 1]) << 8) | st->ispace[st->pc + 2];
+
+      /* Handle 24-bit instructions */
+
+      return pexec24(st, opcode, imm16);
+    }
+  else
+    {
+      /* Handle 8-bit instructions */
 
-  return ret;
+      return pexec8(st, opcode);
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_Execute
+ *
+ * Description:
+ *   Execute one instruction, checking first that the program counter lies
+ *   within I-Space.
+ *
+ ****************************************************************************/
+
+int libexec_Execute(struct libexec_s *st)
+{
+  /* Make sure that the program counter is within range */
+
+  if (st->pc >= st->maxpc)
+    {
+      return eBADPC;
+    }
+
+  return libexec_ExecuteVerified(st);
 }
 
 /****************************************************************************
@@ -1567,7 +1625,12 @@ void libexec_Reset(struct libexec_s *st)
 
   st->spb               += _FSIZE;
 
+  /* The outermost frame is the only entry in the display */
+
+  st->display[0]         = st->fp;
+
   st->exitCode           = 0;
+  st->insnCount          = 0;
 
   /* [Re]-initialize the memory manager */
 
@@ -1592,11 +1655,17 @@ void libexec_Release(EXEC_HANDLE_t handle)
           free(st->dstack.i);
         }
 
-      if (st->ispace)
+      if (st->image)
         {
-          free(st->ispace);
+          libexec_ReleaseImage(st->image);
         }
 
+      free(st->dsave);
+      libexec_ReleaseFiles(st);
+#ifdef CONFIG_PASCAL_PROFILER
+      libexec_ReleaseProfile(st);
+#endif
+
       free(st);
     }
 }
@@ -37,6 +37,7 @@
  * Included Files
  ****************************************************************************/
 
+#include <stdint.h>
 #include <stdio.h>
 
 #include "execlib.h"
@@ -49,34 +50,202 @@
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: libexec_Run
+ *
+ * Description:
+ *   Execute at most 'maxInstructions' P-Code instructions.  Execution stops
+ *   early if the program terminates, if a run-time error occurs, or if a
+ *   read finds no input on a non-blocking file.  In the first and last
+ *   cases, execution resumes where it stopped on the next call.  Nothing is
+ *   printed.
+ *
+ * Returned Value:
+ *   The run-time error code:  eNOERROR if the budget was used up, eEXIT if
+ *   the program terminated, or the error that stopped execution.  The
+ *   reason is also returned in 'reason' if it is not NULL.
+ *
+ ****************************************************************************/
+
+int libexec_Run(EXEC_HANDLE_t handle, uint32_t maxInstructions,
+                runReason_t *reason)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+#ifndef CONFIG_PASCAL_THREADED_DISPATCH
+  int (*execute)(struct libexec_s *);
+#endif
+  int errcode;
+
+#ifdef CONFIG_PASCAL_THREADED_DISPATCH
+  /* Execute until an exceptional condition is encountered or until the
+   * budget is used up.
+   */
+
+  errcode = libexec_Dispatch(st, maxInstructions);
+#else
+  /* The program counter of a verified program need not be checked before
+   * each instruction.
+   */
+
+  execute = st->image->verified ? libexec_ExecuteVerified : libexec_Execute;
+  for (errcode = eNOERROR; maxInstructions > 0; maxInstructions--)
+    {
+      /* Execute the instruction; Check for exceptional conditions */
+
+      errcode = execute(st);
+      st->insnCount++;
+      if (errcode != eNOERROR)
+        {
+          break;
+        }
+    }
+#endif
+
+  if (reason != NULL)
+    {
+      switch (errcode)
+        {
+        case eNOERROR:
+          *reason = eRUN_BUDGET;
+          break;
+
+        case eEXIT:
+          *reason = eRUN_EXIT;
+          break;
+
+        case eWOULDBLOCK:
+          *reason = eRUN_BLOCKED;
+          break;
+
+        default:
+          *reason = eRUN_ERROR;
+          break;
+        }
+    }
+
+  return errcode;
+}
+
+/****************************************************************************
+ * Name: libexec_GetExitCode
+ *
+ * Description:
+ *   Return the exit code of a program that has terminated.
+ *
+ ****************************************************************************/
+
+int libexec_GetExitCode(EXEC_HANDLE_t handle)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  return st->exitCode;
+}
+
+/****************************************************************************
+ * Name: libexec_GetInstructionCount
+ *
+ * Description:
+ *   Return the number of P-Code instructions executed by libexec_Run()
+ *   since the program was loaded or reset.
+ *
+ ****************************************************************************/
+
+uint64_t libexec_GetInstructionCount(EXEC_HANDLE_t handle)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  return st->insnCount;
+}
+
+/****************************************************************************
+ * Name: libexec_GetVerifyResult
+ *
+ * Description:
+ *   Return the result of the verification of the program when it was
+ *   loaded:  eNOERROR if the program was verified and runs without checks
+ *   of the program counter, otherwise the reason that it was not verified.
+ *   In the latter case, the address of the offending instruction is also
+ *   returned in 'pc' if it is not NULL.
+ *
+ ****************************************************************************/
+
+int libexec_GetVerifyResult(EXEC_HANDLE_t handle, pasSize_t *pc)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+
+  if (pc != NULL)
+    {
+      *pc = st->image->verifyPC;
+    }
+
+  return st->image->verifyError;
+}
+
+/****************************************************************************
+ * Name: libexec_SetStdio
+ *
+ * Description:
+ *   Bind the standard files INPUT and OUTPUT to the streams 'input' and
+ *   'output'.  A NULL stream selects stdin or stdout.  The binding is kept
+ *   across a reset.  Instances that run concurrently in different threads
+ *   should each be given their own streams.
+ *
+ ****************************************************************************/
+
+void libexec_SetStdio(EXEC_HANDLE_t handle, FILE *input, FILE *output)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+
+  st->input  = (input  != NULL) ? input  : stdin;
+  st->output = (output != NULL) ? output : stdout;
+
+  st->fileTable[INPUT_FILE_NUMBER].stream  = st->input;
+  st->fileTable[OUTPUT_FILE_NUMBER].stream = st->output;
+}
+
 /****************************************************************************
  * Name: libexec_RunLoop
  *
  * Description:
  *   This function executes the P-Code program until a stopping condition
- *   is encountered.
+ *   is encountered.  The outcome is reported on the stream bound to OUTPUT.
  *
  ****************************************************************************/
 
 void libexec_RunLoop(EXEC_HANDLE_t handle)
 {
   struct libexec_s *st = (struct libexec_s *)handle;
+  uint32_t budget = UINT32_MAX;
   int errcode;
 
-  for (; ; )
+#ifdef CONFIG_PASCAL_PROFILER
+  /* If the call stack sampler is enabled, stop to take a sample each time
+   * that the sampler's budget is used up.
+   */
+
+  if (st->sampler != NULL)
     {
-      /* Execute the instruction; Check for exceptional conditions */
+      budget = st->sampleInterval;
+    }
+#endif
 
-      errcode = libexec_Execute(st);
-      if (errcode != eNOERROR) break;
+  do
+    {
+      errcode = libexec_Run(handle, budget, NULL);
+#ifdef CONFIG_PASCAL_PROFILER
+      if (errcode == eNOERROR && st->sampler != NULL)
+        {
+          budget = libexec_TakeSample(st);
+        }
+#endif
     }
+  while (errcode == eNOERROR);
 
   if (errcode == eEXIT)
     {
-      printf("Exit with code %d\n", st->exitCode);
+      fprintf(st->output, "Exit with code %d\n", st->exitCode);
     }
   else
     {
-      printf("Runtime error 0x%02x -- Execution Stopped\n", errcode);
+      fprintf(st->output, "Runtime error 0x%02x -- Execution Stopped\n",
+              errcode);
     }
 }
@@ -53,152 +53,184 @@
 
 #include "libexec_setops.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The set kernels operate on 64-bit blocks.  Every set size is a multiple
+ * of sSET_SIZE, the size of one block.
+ */
+
+#define SET_BLOCK_WORDS (sSET_SIZE / sINT_SIZE)
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
 /* Receive two sets, return one */
 
-static int libexec_intersection(const uint16_t *src, uint16_t *dest);
-static int libexec_union(const uint16_t *src, uint16_t *dest);
-static int libexec_difference(const uint16_t *src, uint16_t *dest);
-static int libexec_symmetricdiff(const uint16_t *src, uint16_t *dest);
+static int libexec_intersection(const uint16_t *src, uint16_t *dest,
+                                int nBlocks);
+static int libexec_union(const uint16_t *src, uint16_t *dest, int nBlocks);
+static int libexec_difference(const uint16_t *src, uint16_t *dest,
+                              int nBlocks);
+static int libexec_symmetricdiff(const uint16_t *src, uint16_t *dest,
+                                 int nBlocks);
 
 /* Receive two sets, returns a boolean */
 
 static int libexec_equality(const uint16_t *src1, const uint16_t *src2,
-             uint16_t *result);
+             uint16_t *result, int nBlocks);
 static int libexec_nonequality(const uint16_t *src1, const uint16_t *src2,
-             uint16_t *result);
+             uint16_t *result, int nBlocks);
 static int libexec_contains(const uint16_t *src1, const uint16_t *src2,
-                          uint16_t *result);
+                          uint16_t *result, int nBlocks);
 
 /* Receive a set member and one set, returns a boolean */
 
 static int libexec_member(int16_t member, const uint16_t *src,
-                        uint16_t *result);
+                        uint16_t *result, int nElements);
 
 /* Receive one set and a set member, returns the modified set */
 
-static int libexec_include(int16_t member, uint16_t *dest);
-static int libexec_exclude(int16_t member, uint16_t *dest);
-static int libexec_card(const uint16_t *src, uint16_t *dest);
+static int libexec_include(int16_t member, uint16_t *dest, int nElements);
+static int libexec_exclude(int16_t member, uint16_t *dest, int nElements);
+static int libexec_card(const uint16_t *src, uint16_t *dest, int nBlocks);
 static int libexec_singleton(int16_t minValue, int16_t member,
-             uint16_t *dest);
+             uint16_t *dest, int nElements);
 static int libexec_subrange(int16_t minValue, int16_t member1,
-             int16_t member2, uint16_t *dest);
+             int16_t member2, uint16_t *dest, int nElements);
 
-static uint16_t libexec_BitsInWord(uint16_t word);
-static uint16_t libexec_BitsInByte(uint8_t byte);
-static uint16_t libexec_BitsInNibble(uint8_t nibble);
+static inline uint64_t libexec_GetSetBlock(const uint16_t *set, int index);
+static inline void libexec_PutSetBlock(uint16_t *set, int index,
+                                       uint64_t block);
+static uint16_t libexec_BitsInBlock(uint64_t block);
 
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#if !defined(__GNUC__)
 static const uint8_t g_bitsInNibble[16] =
 {
 /* 00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f */
    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
 };
+#endif
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
-static int libexec_intersection(const uint16_t *src, uint16_t *dest)
+static int libexec_intersection(const uint16_t *src, uint16_t *dest,
+                                int nBlocks)
 {
-  dest[0] &= src[0];
-  dest[1] &= src[1];
-  dest[2] &= src[2];
-  dest[3] &= src[3];
+  int i;
+
+  for (i = 0; i < nBlocks; i++)
+    {
+      libexec_PutSetBlock(dest, i, libexec_GetSetBlock(dest, i) &
+                                   libexec_GetSetBlock(src, i));
+    }
+
   return eNOERROR;
 }
 
-static int libexec_union(const uint16_t *src, uint16_t *dest)
+static int libexec_union(const uint16_t *src, uint16_t *dest, int nBlocks)
 {
-  dest[0] |= src[0];
-  dest[1] |= src[1];
-  dest[2] |= src[2];
-  dest[3] |= src[3];
+  int i;
+
+  for (i = 0; i < nBlocks; i++)
+    {
+      libexec_PutSetBlock(dest, i, libexec_GetSetBlock(dest, i) |
+                                   libexec_GetSetBlock(src, i));
+    }
+
   return eNOERROR;
 }
 
-static int libexec_difference(const uint16_t *src, uint16_t *dest)
+static int libexec_difference(const uint16_t *src, uint16_t *dest,
+                              int nBlocks)
 {
-  dest[0] &= ~src[0];
-  dest[1] &= ~src[1];
-  dest[2] &= ~src[2];
-  dest[3] &= ~src[3];
+  int i;
+
+  for (i = 0; i < nBlocks; i++)
+    {
+      libexec_PutSetBlock(dest, i, libexec_GetSetBlock(dest, i) &
+                                   ~libexec_GetSetBlock(src, i));
+    }
+
   return eNOERROR;
 }
 
-static int libexec_symmetricdiff(const uint16_t *src, uint16_t *dest)
+static int libexec_symmetricdiff(const uint16_t *src, uint16_t *dest,
+                                 int nBlocks)
 {
-  dest[0] ^= src[0];
-  dest[1] ^= src[1];
-  dest[2] ^= src[2];
-  dest[3] ^= src[3];
+  int i;
+
+  for (i = 0; i < nBlocks; i++)
+    {
+      libexec_PutSetBlock(dest, i, libexec_GetSetBlock(dest, i) ^
+                                   libexec_GetSetBlock(src, i));
+    }
+
   return eNOERROR;
 }
 
 static int libexec_equality(const uint16_t *src1, const uint16_t *src2,
-                            uint16_t *result)
+                            uint16_t *result, int nBlocks)
 {
-  uint16_t same = PASCAL_FALSE;
+  uint64_t diff = 0;
+  int i;
 
-  if (src1[0] == src2[0] &&
-      src1[1] == src2[1] &&
-      src1[2] == src2[2] &&
-      src1[3] == src2[3])
+  for (i = 0; i < nBlocks; i++)
     {
-      same = PASCAL_TRUE;
+      diff |= libexec_GetSetBlock(src1, i) ^ libexec_GetSetBlock(src2, i);
     }
 
-  *result = same;
+  *result = (diff == 0) ? PASCAL_TRUE : PASCAL_FALSE;
   return eNOERROR;
 }
 
 static int libexec_nonequality(const uint16_t *src1, const uint16_t *src2,
-                               uint16_t *result)
+                               uint16_t *result, int nBlocks)
 {
-  uint16_t different = PASCAL_FALSE;
+  uint64_t diff = 0;
+  int i;
 
-  if (src1[0] != src2[0] ||
-      src1[1] != src2[1] ||
-      src1[2] != src2[2] ||
-      src1[3] != src2[3])
+  for (i = 0; i < nBlocks; i++)
     {
-      different = PASCAL_TRUE;
+      diff |= libexec_GetSetBlock(src1, i) ^ libexec_GetSetBlock(src2, i);
     }
 
-  *result = different;
+  *result = (diff != 0) ? PASCAL_TRUE : PASCAL_FALSE;
   return eNOERROR;
 }
 
 static int libexec_contains(const uint16_t *src1, const uint16_t *src2,
-                            uint16_t *result)
+                            uint16_t *result, int nBlocks)
 {
-  uint16_t contains = PASCAL_FALSE;
+  uint64_t missing = 0;
+  int i;
 
-  if ((src1[0] & src2[0]) == src2[0] &&
-      (src1[1] & src2[1]) == src2[1] &&
-      (src1[2] & src2[2]) == src2[2] &&
-      (src1[3] & src2[3]) == src2[3])
+  /* Collect the members of src2 that are not in src1 */
+
+  for (i = 0; i < nBlocks; i++)
     {
-      contains = PASCAL_TRUE;
+      missing |= libexec_GetSetBlock(src2, i) &
+                 ~libexec_GetSetBlock(src1, i);
     }
 
-  *result = contains;
+  *result = (missing == 0) ? PASCAL_TRUE : PASCAL_FALSE;
   return eNOERROR;
 }
 
 static int libexec_member(int16_t member, const uint16_t *src,
-                          uint16_t *result)
+                          uint16_t *result, int nElements)
 {
   int errorCode = eNOERROR;
 
-  if (member < 0 || member > 8 * sSET_SIZE)
+  if (member < 0 || member >= nElements)
     {
       errorCode = eVALUERANGE;
     }
@@ -214,47 +246,62 @@ static int libexec_member(int16_t member, const uint16_t *src,
   return errorCode;
 }
 
-static int libexec_include(int16_t member, uint16_t *dest)
+static int libexec_include(int16_t member, uint16_t *dest, int nElements)
 {
   uint16_t wordIndex = member >> 4;
   uint16_t bitIndex  = member & 0x0f;
 
+  if (member < 0 || member >= nElements)
+    {
+      return eVALUERANGE;
+    }
+
   dest[wordIndex] |= (1 << bitIndex);
   return eNOERROR;
 }
 
-static int libexec_exclude(int16_t member, uint16_t *dest)
+static int libexec_exclude(int16_t member, uint16_t *dest, int nElements)
 {
   uint16_t wordIndex = member >> 4;
   uint16_t bitIndex  = member & 0x0f;
 
+  if (member < 0 || member >= nElements)
+    {
+      return eVALUERANGE;
+    }
+
   dest[wordIndex] &= ~(1 << bitIndex);
   return eNOERROR;
 }
 
-static int libexec_card(const uint16_t *src, uint16_t *dest)
+static int libexec_card(const uint16_t *src, uint16_t *dest, int nBlocks)
 {
-  *dest = libexec_BitsInWord(src[0]) + libexec_BitsInWord(src[1]) +
-          libexec_BitsInWord(src[2]) + libexec_BitsInWord(src[3]);
+  uint16_t nBits = 0;
+  int i;
+
+  for (i = 0; i < nBlocks; i++)
+    {
+      nBits += libexec_BitsInBlock(libexec_GetSetBlock(src, i));
+    }
+
+  *dest = nBits;
   return eNOERROR;
 }
 
-static int libexec_singleton(int16_t minValue, int16_t member, uint16_t *dest)
+static int libexec_singleton(int16_t minValue, int16_t member,
+                             uint16_t *dest, int nElements)
 {
   int wordIndex;
   int bitIndex;
 
   /* Initialize the result */
 
-  dest[0] = 0;
-  dest[1] = 0;
-  dest[2] = 0;
-  dest[3] = 0;
+  memset(dest, 0, nElements >> 3);
 
-  /* Check that subrange values are in order and in range */
+  /* Check that the member is in range */
 
   member -= minValue;
-  if (member < 0 || member >= sSET_MAXELEM)
+  if (member < 0 || member >= nElements)
     {
       return eVALUERANGE;
     }
@@ -266,24 +313,23 @@ static int libexec_singleton(int16_t minValue, int16_t member, uint16_t *dest)
   return eNOERROR;
 }
 
-static int libexec_subrange(int16_t minValue, int16_t member1, int16_t member2,
-                          uint16_t *dest)
+static int libexec_subrange(int16_t minValue, int16_t member1,
+                            int16_t member2, uint16_t *dest, int nElements)
 {
   uint16_t leadMask;
   uint16_t tailMask;
+  int      firstWord;
+  int      lastWord;
   int      wordIndex;
 
   /* Initialize the result */
 
-  dest[0] = 0;
-  dest[1] = 0;
-  dest[2] = 0;
-  dest[3] = 0;
+  memset(dest, 0, nElements >> 3);
 
   /* Check that subrange values are in order and in range */
 
   member2 -= minValue;
-  if (member2 < 0 || member2 >= sSET_MAXELEM)
+  if (member2 < 0 || member2 >= nElements)
     {
       return eVALUERANGE;
     }
@@ -296,69 +342,66 @@ static int libexec_subrange(int16_t minValue, int16_t member1, int16_t member2,
 
   /* Set all bits from member1 through member2. */
 
-  leadMask = (0xffff << (member1 & 0x0f));
-  tailMask = (0xffff >> ((BITS_IN_INTEGER - 1) - (member2 & 0x0f)));
+  leadMask  = (0xffff << (member1 & 0x0f));
+  tailMask  = (0xffff >> ((BITS_IN_INTEGER - 1) - (member2 & 0x0f)));
+  firstWord = member1 >> 4;
+  lastWord  = member2 >> 4;
 
   /* Special case:  The entire sub-range fits in one word */
 
-  wordIndex = member1 >> 4;
-  if (wordIndex == (member2 >> 4))
+  if (firstWord == lastWord)
     {
-      dest[wordIndex] = (leadMask & tailMask);
+      dest[firstWord] = (leadMask & tailMask);
     }
 
   /* No, the last bit lies in a different word than the first */
 
   else
     {
-      uint16_t bitMask;
-      int      nBits;
-      int      leadBits;
-      int      tailBits;
-      int      bitsInWord;
-
-      nBits    = member2 - member1 + 1;
-      leadBits = BITS_IN_INTEGER - member1;
-      tailBits = (member2 & 0x0f) + 1;
-
-      /* Loop for each word */
-
-      for (bitMask = leadMask, bitsInWord = leadBits;
-           nBits > 0;
-           wordIndex++)
+      dest[firstWord] = leadMask;
+      for (wordIndex = firstWord + 1; wordIndex < lastWord; wordIndex++)
         {
-          dest[wordIndex] = bitMask;
-          nBits          -= bitsInWord;
-
-          if (nBits >= BITS_IN_INTEGER)
-            {
-              bitsInWord = BITS_IN_INTEGER;
-              bitMask    = 0xffff;
-            }
-          else if (nBits > 0)
-            {
-              nBits   = tailBits;
-              bitMask = tailMask;
-            }
+          dest[wordIndex] = 0xffff;
         }
+
+      dest[lastWord] = tailMask;
     }
 
   return eNOERROR;
 }
 
-static uint16_t libexec_BitsInWord(uint16_t word)
+/* The set words on the stack are only 16-bit aligned.  memcpy() lets the
+ * compiler use whatever unaligned 64-bit access the host supports.
+ */
+
+static inline uint64_t libexec_GetSetBlock(const uint16_t *set, int index)
 {
-  return libexec_BitsInByte(word >> 8) + libexec_BitsInByte(word & 0xff);
+  uint64_t block;
+
+  memcpy(&block, &set[index * SET_BLOCK_WORDS], sizeof(uint64_t));
+  return block;
 }
 
-static uint16_t libexec_BitsInByte(uint8_t byte)
+static inline void libexec_PutSetBlock(uint16_t *set, int index,
+                                       uint64_t block)
 {
-  return libexec_BitsInNibble(byte >> 4) + libexec_BitsInNibble(byte & 0x0f);
+  memcpy(&set[index * SET_BLOCK_WORDS], &block, sizeof(uint64_t));
 }
 
-static uint16_t libexec_BitsInNibble(uint8_t nibble)
+static uint16_t libexec_BitsInBlock(uint64_t block)
 {
-  return (uint16_t)g_bitsInNibble[nibble & 0x0f];
+#if defined(__GNUC__)
+  return (uint16_t)__builtin_popcountll(block);
+#else
+  uint16_t nBits = 0;
+
+  for (; block != 0; block >>= 4)
+    {
+      nBits += g_bitsInNibble[block & 0x0f];
+    }
+
+  return nBits;
+#endif
 }
 
 /****************************************************************************
@@ -369,7 +412,9 @@ static uint16_t libexec_BitsInNibble(uint8_t nibble)
  * Name: libexec_SetOperations
  *
  * Description:
- *   This function handles operations on SETs.
+ *   This function handles operations on SETs.  The sub-function encodes
+ *   both the operation and the size of the set operands (see
+ *   pas_setops.h).  Below, setWords is the size of one set in words.
  *
  ****************************************************************************/
 
@@ -382,143 +427,145 @@ int libexec_SetOperations(struct libexec_s *st, uint8_t subfunc)
   int16_t member2;
   int16_t minValue;
   int16_t offset;
-  int errorCode = eNOERROR;
+  uint16_t setSize  = SETOP_SETSIZE(subfunc);
+  uint16_t setWords = setSize / sINT_SIZE;
+  int nBlocks       = setSize / sSET_SIZE;
+  int nElements     = 8 * setSize;
+  int errorCode     = eNOERROR;
 
-  switch (subfunc)
+  switch (SETOP_OPCODE(subfunc))
     {
       /* No inputs, generate an empty set */
 
       case setEMPTY:
-        PUSH(st, 0);
-        PUSH(st, 0);
-        PUSH(st, 0);
-        PUSH(st, 0);
+        st->sp += setSize;
+        memset(&TOS(st, setWords - 1), 0, setSize);
         break;
 
       /* Receive two sets, return one.  On entry:
        *
        * On entry:
-       *   TOS[0-(sSET_WORDS - 1)]   = Set2
-       *   TOS[X-(2*sSET_WORDS - 1)] = Set1
+       *   TOS[0-(setWords - 1)]   = Set2
+       *   TOS[X-(2*setWords - 1)] = Set1
        * On return:
-       *   TOS[0-(sSET_WORDS - 1)]   = Resulting set.
+       *   TOS[0-(setWords - 1)]   = Resulting set.
        */
 
       case setINTERSECTION :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_intersection(src1, dest);
-        DISCARD(st, sSET_WORDS);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_intersection(src1, dest, nBlocks);
+        DISCARD(st, setWords);
         break;
 
       case setUNION :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_union(src1, dest);
-        DISCARD(st, sSET_WORDS);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_union(src1, dest, nBlocks);
+        DISCARD(st, setWords);
         break;
 
       case setDIFFERENCE :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_difference(src1, dest);
-        DISCARD(st, sSET_WORDS);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_difference(src1, dest, nBlocks);
+        DISCARD(st, setWords);
         break;
 
       case setSYMMETRICDIFF :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_symmetricdiff(src1, dest);
-        DISCARD(st, sSET_WORDS);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_symmetricdiff(src1, dest, nBlocks);
+        DISCARD(st, setWords);
         break;
 
       /* Receive two sets, return a boolean.
        *
        * On entry:
-       *   TOS[0-(sSET_WORDS - 1)]   = Set2
-       *   TOS[X-(2*sSET_WORDS - 1)] = Set1
+       *   TOS[0-(setWords - 1)]   = Set2
+       *   TOS[X-(2*setWords - 1)] = Set1
        * On return:
-       *   TOS[0]                    = Boolean result
+       *   TOS[0]                  = Boolean result
        */
 
       case setEQUALITY :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        src2 = (const uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_equality(src1, src2, dest);
-        DISCARD(st, 2 * sSET_WORDS  - 1);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        src2 = (const uint16_t *)&TOS(st, 2 * setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_equality(src1, src2, dest, nBlocks);
+        DISCARD(st, 2 * setWords  - 1);
         break;
 
       case setNONEQUALITY :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        src2 = (const uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_nonequality(src1, src2, dest);
-        DISCARD(st, 2 * sSET_WORDS  - 1);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        src2 = (const uint16_t *)&TOS(st, 2 * setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_nonequality(src1, src2, dest, nBlocks);
+        DISCARD(st, 2 * setWords  - 1);
         break;
 
       case setCONTAINS :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        src2 = (const uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, 2 * sSET_WORDS - 1);
-        errorCode = libexec_contains(src1, src2, dest);
-        DISCARD(st, 2 * sSET_WORDS  - 1);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        src2 = (const uint16_t *)&TOS(st, 2 * setWords - 1);
+        dest = (uint16_t *)&TOS(st, 2 * setWords - 1);
+        errorCode = libexec_contains(src1, src2, dest, nBlocks);
+        DISCARD(st, 2 * setWords  - 1);
         break;
 
       /* Receives a set member, one set, and an offset.  Returns a boolean.
        *
        * On entry:
        *   TOS(0)            = offset value
-       *   TOS(1-sSET_WORDS) = set value
-       *   TOS(sSET_WORDS+1) = member to test
+       *   TOS(1-setWords)   = set value
+       *   TOS(setWords+1)   = member to test
        * On return:
        *   TOS[0]            = Boolean result
        */
 
       case setMEMBER :
         offset    = TOS(st, 0);
-        src1      = (const uint16_t *)&TOS(st, sSET_WORDS);
-        member1   = TOS(st, sSET_WORDS + 1);
-        dest      = (uint16_t *)&TOS(st, sSET_WORDS + 1);
+        src1      = (const uint16_t *)&TOS(st, setWords);
+        member1   = TOS(st, setWords + 1);
+        dest      = (uint16_t *)&TOS(st, setWords + 1);
         errorCode = libexec_member((int16_t)member1 - (int16_t)offset,
-                                   src1, dest);
-        DISCARD(st, sSET_WORDS + 1);
+                                   src1, dest, nElements);
+        DISCARD(st, setWords + 1);
         break;
 
       /* Receive one set and a set member1, returns the modified set.
        *
        * On entry:
-       *   TOS(0)                = member to test
-       *   TOS(1-sSET_WORDS)     = set value
+       *   TOS(0)              = member to test
+       *   TOS(1-setWords)     = set value
        * On return:
-       *   TOS[0-(sSET_WORDS-1)] = Set result
+       *   TOS[0-(setWords-1)] = Set result
        */
 
       case setINCLUDE :
         POP(st, member1);
-        dest = (uint16_t *)&TOS(st, sSET_WORDS - 1);
-        errorCode = libexec_include(member1, dest);
+        dest = (uint16_t *)&TOS(st, setWords - 1);
+        errorCode = libexec_include(member1, dest, nElements);
         break;
 
       case setEXCLUDE :
         POP(st, member1);
-        dest = (uint16_t *)&TOS(st, sSET_WORDS - 1);
-        errorCode = libexec_exclude(member1, dest);
+        dest = (uint16_t *)&TOS(st, setWords - 1);
+        errorCode = libexec_exclude(member1, dest, nElements);
         break;
 
       /* Reveives on set, returns the cardinality of the set.
        *
        * On entry:
-       *   TOS(0-(sSET_WORDS-1)) = Set value
+       *   TOS(0-(setWords-1)) = Set value
        * On return:
-       *   TOS[0]                = Cardinality of set
+       *   TOS[0]              = Cardinality of set
        */
 
       case setCARD :
-        src1 = (const uint16_t *)&TOS(st, sSET_WORDS - 1);
-        dest = (uint16_t *)&TOS(st, sSET_WORDS - 1);
-        errorCode = libexec_card(src1, dest);
-        DISCARD(st, sSET_WORDS  - 1);
+        src1 = (const uint16_t *)&TOS(st, setWords - 1);
+        dest = (uint16_t *)&TOS(st, setWords - 1);
+        errorCode = libexec_card(src1, dest, nBlocks);
+        DISCARD(st, setWords  - 1);
         break;
 
       /* Receives one integer value, returns a set representing the subrange:
@@ -527,15 +574,15 @@ int libexec_SetOperations(struct libexec_s *st, uint8_t subfunc)
        *   TOS(0)               = minimum value of a member
        *   TOS(2)               = member
        * On return:
-       *   TOS(0-(sSET_WORDS-1) = Set result
+       *   TOS(0-(setWords-1)   = Set result
        */
 
       case setSINGLETON :
         POP(st, minValue);
         POP(st, member1);
-        st->sp += sSET_SIZE;
-        dest = (uint16_t *)&TOS(st, sSET_WORDS - 1);
-        errorCode = libexec_singleton(minValue, member1, dest);
+        st->sp += setSize;
+        dest = (uint16_t *)&TOS(st, setWords - 1);
+        errorCode = libexec_singleton(minValue, member1, dest, nElements);
         break;
 
       /* Receives two integer values, returns a set representing the subrange:
@@ -545,16 +592,17 @@ int libexec_SetOperations(struct libexec_s *st, uint8_t subfunc)
        *   TOS(1)               = member2
        *   TOS(2)               = member1
        * On return:
-       *   TOS(0-(sSET_WORDS-1) = Set result
+       *   TOS(0-(setWords-1)   = Set result
        */
 
       case setSUBRANGE :
         POP(st, minValue);
         POP(st, member2);
         POP(st, member1);
-        st->sp += sSET_SIZE;
-        dest = (uint16_t *)&TOS(st, sSET_WORDS - 1);
-        errorCode = libexec_subrange(minValue, member1, member2, dest);
+        st->sp += setSize;
+        dest = (uint16_t *)&TOS(st, setWords - 1);
+        errorCode = libexec_subrange(minValue, member1, member2, dest,
+                                     nElements);
         break;
 
       case setINVALID :
@@ -50,8 +50,10 @@
 #include "pas_machine.h"
 #include "pas_stringlib.h"
 #include "pas_errcodes.h"
+#include "paslib.h"
 
 #include "libexec.h"
+#include "libexec_format.h"
 #include "libexec_heap.h"
 #include "libexec_longops.h"   /* For libexec_UPop32() */
 #include "libexec_sysio.h"     /* For libexec_GetFormat() */
@@ -79,8 +81,12 @@ static int      libexec_StrCat(struct libexec_s *st, uint16_t srcStringAddr,
 static int      libexec_StrCatC(struct libexec_s *st, char srcChar,
                    uint16_t destStringAddr, uint16_t *pDestStringSize,
                    uint16_t destStrAlloc);
+static void     libexec_StrNumber(struct libexec_s *st, uint16_t *strPtr,
+                  const char *number, int len, uint16_t fieldWidth);
 static int      libexec_FillChar(struct libexec_s *st, ustack_t *sptr,
                    uint16_t count, uint8_t value);
+static int      libexec_FindSubStr(const char *str, uint16_t strSize,
+                   const char *subStr, uint16_t subStrSize);
 
 /****************************************************************************
  * Private Functions
@@ -372,6 +378,36 @@ static int libexec_StrCatC(struct libexec_s *st, char srcChar,
   return errorCode;
 }
 
+/* Append a formatted number to a string, right justified in the field width
+ * in the upper byte of fieldWidth.  The result is truncated if the string
+ * allocation is too small.
+ */
+
+static void libexec_StrNumber(struct libexec_s *st, uint16_t *strPtr,
+                              const char *number, int len,
+                              uint16_t fieldWidth)
+{
+  uint16_t strAlloc = strPtr[BTOISTACK(sSTRING_ALLOC_OFFSET)] & HEAP_SIZE_MASK;
+  uint16_t strAddr  = strPtr[BTOISTACK(sSTRING_DATA_OFFSET)];
+  uint16_t strSize  = strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)];
+  char *dest        = (char *)ATSTACK(st, strAddr);
+  int padding;
+
+  for (padding = (int)(fieldWidth >> 8) - len;
+       padding > 0 && strSize < strAlloc;
+       padding--)
+    {
+      dest[strSize++] = ' ';
+    }
+
+  for (; len > 0 && strSize < strAlloc; len--)
+    {
+      dest[strSize++] = *number++;
+    }
+
+  strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)] = strSize;
+}
+
 /* Fill string s with character value until s is count-1 char long. */
 
 static int libexec_FillChar(struct libexec_s *st, ustack_t *sptr, uint16_t count,
@@ -415,6 +451,56 @@ static int libexec_FillChar(struct libexec_s *st, ustack_t *sptr, uint16_t count
   return eNOERROR;
 }
 
+/* Return the (0-based) offset of the first occurrence of a substring in a
+ * string, or -1 if the substring is not present.  Neither string is NUL
+ * terminated.  Candidate positions are found with memchr() on the first
+ * character of the substring and are then screened on the last character
+ * before the whole substring is compared.
+ */
+
+static int libexec_FindSubStr(const char *str, uint16_t strSize,
+                              const char *subStr, uint16_t subStrSize)
+{
+  const char *next;
+  const char *last;
+  char first;
+  char final;
+
+  if (subStrSize == 0)
+    {
+      return 0;
+    }
+
+  if (subStrSize > strSize)
+    {
+      return -1;
+    }
+
+  first = subStr[0];
+  final = subStr[subStrSize - 1];
+  next  = str;
+  last  = str + strSize - subStrSize;   /* Last possible match position */
+
+  while (next <= last)
+    {
+      next = (const char *)memchr(next, first, last - next + 1);
+      if (next == NULL)
+        {
+          break;
+        }
+
+      if (next[subStrSize - 1] == final &&
+          memcmp(next + 1, subStr + 1, subStrSize - 1) == 0)
+        {
+          return next - str;
+        }
+
+      next++;
+    }
+
+  return -1;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1114,19 +1200,16 @@ uint16_t libexec_StringOperations(struct libexec_s *st, uint16_t subfunc)
 
     case lbFINDSUBSTR :
       {
-        uint16_t saveCsp;
+        const char *strPtr;
+        const char *subStrPtr;
         uint16_t pos;
-        char *strStack;
-        char *cStr;
-        char *subStrStack;
-        char *cSubStr;
-        char *result;
         uint16_t strAlloc;
         uint16_t strAddr;
         uint16_t strSize;
         uint16_t subStrAlloc;
         uint16_t subStrAddr;
         uint16_t subStrSize;
+        int index;
 
         POP(st, pos);
 
@@ -1138,41 +1221,31 @@ uint16_t libexec_StringOperations(struct libexec_s *st, uint16_t subfunc)
         POP(st, subStrAddr);
         POP(st, subStrSize);
 
-        /* Convert strings to C strings */
+        /* Search the string buffers in place */
 
-        saveCsp     = st->csp;
-        strStack    = (char *)ATSTACK(st, strAddr);
-        cStr        = libexec_MkCString(st, strStack, strSize, true);
-
-        subStrStack = (char *)ATSTACK(st, subStrAddr);
-        cSubStr     = libexec_MkCString(st, subStrStack, subStrSize, false);
-        offset      = 0;
+        strPtr    = (const char *)ATSTACK(st, strAddr);
+        subStrPtr = (const char *)ATSTACK(st, subStrAddr);
+        offset    = 0;
 
         if (pos < 1)
           {
             errorCode = eVALUERANGE;
           }
-        else if (cStr == NULL || cSubStr == NULL)
-          {
-            errorCode = eNOMEMORY;
-          }
-        else
+        else if (pos <= strSize + 1)
           {
-            /* Find the substring in the string */
-
-            result = strstr(&cStr[pos - 1], cSubStr);
-
-            /* strstr will return NULL if the stubstring is not found but,
-             * oddly, will return result == str if substr is 0.
+            /* Find the substring in the string at or after the start
+             * position.  An empty substring is found at the start
+             * position.
              */
 
-            if (result != NULL)
+            index = libexec_FindSubStr(&strPtr[pos - 1], strSize - (pos - 1),
+                                       subStrPtr, subStrSize);
+            if (index >= 0)
               {
-                offset = (uintptr_t)result - (uintptr_t)cStr + 1;
+                offset = pos + index;
               }
           }
 
-        st->csp = saveCsp;
         PUSH(st, offset);
 
         /* We consumed two temporary strings and probably need to free
@@ -1431,125 +1504,76 @@ uint16_t libexec_StringOperations(struct libexec_s *st, uint16_t subfunc)
     case lbINTSTR :
     case lbWORDSTR :
       {
-        const char *fmt;
-        const char *fmtCh;
-        char       *destPtr;
+        char        number[FORMAT_NUMSIZE];
         uint16_t   *strPtr;
         uint16_t    strStack;
         uint16_t    fieldWidth;
         uint16_t    value;
-        uint16_t    strAddr;
-        uint16_t    strAlloc;
-        uint16_t    strSize;
+        int         len;
 
         POP(st, strStack);   /* Stack address of string */
         POP(st, fieldWidth); /* Field width data */
         POP(st, value);      /* Numeric value of the integer */
 
-        /* Get the physical address of the string to be modified and the
-         * allocation size.
-         */
+        /* Get the physical address of the string to be modified */
 
-        strPtr   = (ustack_t *)ATSTACK(st, strStack);
-        strAlloc = strPtr[BTOISTACK(sSTRING_ALLOC_OFFSET)];
+        strPtr = (ustack_t *)ATSTACK(st, strStack);
 
-        /* Get the appropriate format string */
+        /* Now we can perform the conversion */
 
         if (subfunc == lbINTSTR)
           {
-            fmtCh = "d";
+            len = libexec_FormatSigned(number, (int16_t)value);
           }
         else /* if (subfunc == lbWORDSTR) */
           {
-            fmtCh = "u";
+            len = libexec_FormatUnsigned(number, value);
           }
 
-        fmt = libexec_GetFormat(fmtCh, fieldWidth >> 8, 0);
-
-        /* Now we can perform the conversion */
-
-        strAddr  = strPtr[BTOISTACK(sSTRING_DATA_OFFSET)];
-        strSize  = strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)];
-
-        if (strSize < strAlloc)
-          {
-            /* Convert the string to a numeric value */
-
-            destPtr  = (char *)ATSTACK(st, strAddr) + strSize;
-            strSize += snprintf(destPtr, strAlloc - strSize, fmt, value);
-
-            /* Save the updated size of the string */
-
-            strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)] = strSize;
-          }
+        libexec_StrNumber(st, strPtr, number, len, fieldWidth);
       }
       break;
 
     case lbLONGSTR :
     case lbULONGSTR :
       {
-        const char *fmt;
-        const char *fmtCh;
-        uint16_t   *stPtr;
-        uint16_t    value;
+        char        number[FORMAT_NUMSIZE];
+        uint16_t   *strPtr;
+        uint32_t    value;
         uint16_t    fieldWidth;
-        uint16_t    strAddr;
-        uint16_t    strAlloc;
-        uint16_t    strSize;
+        int         len;
 
         POP(st, addr1);           /* Stack address of string */
         POP(st, fieldWidth);      /* Field width data */
         value = libexec_UPop32(st); /* Numeric value of the long integer */
 
-        /* Get the physical address of the string to be modified and the
-         * allocation size.
-         */
+        /* Get the physical address of the string to be modified */
 
-        stPtr     = (uint16_t *)ATSTACK(st, addr1);
-        strAlloc  = stPtr[BTOISTACK(sSTRING_ALLOC_OFFSET)] & HEAP_SIZE_MASK;
+        strPtr = (uint16_t *)ATSTACK(st, addr1);
 
-        /* Get the appropriate format string */
+        /* Now we can perform the conversion */
 
         if (subfunc == lbLONGSTR)
           {
-            fmtCh = PRId32;
+            len = libexec_FormatSigned(number, (int32_t)value);
           }
         else /* if (subfunc == lbULONGSTR) */
           {
-            fmtCh = PRIu32;
+            len = libexec_FormatUnsigned(number, value);
           }
 
-        fmt = libexec_GetFormat(fmtCh, fieldWidth >> 8, 0);
-
-        /* Now we can perform the conversion */
-
-        strAddr = stPtr[BTOISTACK(sSTRING_DATA_OFFSET)];
-        strSize = stPtr[BTOISTACK(sSTRING_SIZE_OFFSET)];
-
-        if (strSize < strAlloc)
-          {
-            /* Convert the string at the end of the string */
-
-            dest     = (char *)ATSTACK(st, strAddr) + strSize;
-            strSize += snprintf(dest, strAlloc - strSize, fmt, value);
-
-            /* Save the updated size of the string */
-
-            stPtr[BTOISTACK(sSTRING_SIZE_OFFSET)] = strSize;
-          }
+        libexec_StrNumber(st, strPtr, number, len, fieldWidth);
       }
       break;
 
     case lbREALSTR :
       {
-        const char *fmt;
+        char        number[FORMAT_NUMSIZE];
         uint16_t   *strPtr;
         fparg_t     value;
         uint16_t    strStack;
         uint16_t    fieldWidth;
-        uint16_t    strAddr;
-        uint16_t    strAlloc;
-        uint16_t    strSize;
+        int         len;
 
         POP(st, strStack);     /* Stack address of string */
         POP(st, fieldWidth);   /* Field width data */
@@ -1558,32 +1582,36 @@ uint16_t libexec_StringOperations(struct libexec_s *st, uint16_t subfunc)
         POP(st, value.hw[1]);
         POP(st, value.hw[0]);
 
-        /* Get the physical address of the string to be modified and the
-         * allocation size.
-         */
-
-        strPtr   = (uint16_t *)ATSTACK(st, strStack);
-        strAlloc = strPtr[BTOISTACK(sSTRING_ALLOC_OFFSET)] & HEAP_SIZE_MASK;
+        /* Get the physical address of the string to be modified */
 
-        /* Get the appropriate format string */
-
-        fmt = libexec_GetFormat("f", fieldWidth >> 8, fieldWidth & 0xff);
+        strPtr = (uint16_t *)ATSTACK(st, strStack);
 
         /* Now we can perform the conversion */
 
-        strAddr  = strPtr[BTOISTACK(sSTRING_DATA_OFFSET)];
-        strSize  = strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)];
-
-        if (strSize < strAlloc)
+        len = libexec_FormatReal(number, value.f, fieldWidth >> 8,
+                                 fieldWidth & 0xff);
+        if (len >= 0)
           {
-            /* Convert the string at the end of the string */
+            libexec_StrNumber(st, strPtr, number, len, fieldWidth);
+          }
+        else
+          {
+            /* Very large values, infinities, NaNs, and very high
+             * precisions are left to printf.
+             */
 
-            dest     = (char *)ATSTACK(st, strAddr) + strSize;
-            strSize += snprintf(dest, strAlloc - strSize, fmt, value.f);
+            const char *fmt = libexec_GetFormat(st, "f", fieldWidth >> 8,
+                                                fieldWidth & 0xff);
 
-            /* Save the updated size of the string */
+            len = snprintf((char *)st->ioBuffer, LINE_SIZE + 1, fmt,
+                           value.f);
+            if (len > LINE_SIZE)
+              {
+                len = LINE_SIZE;
+              }
 
-            strPtr[BTOISTACK(sSTRING_SIZE_OFFSET)] = strSize;
+            libexec_StrNumber(st, strPtr, (const char *)st->ioBuffer, len,
+                              0);
           }
       }
       break;
@@ -1668,6 +1696,212 @@ uint16_t libexec_StringOperations(struct libexec_s *st, uint16_t subfunc)
       }
       break;
 
+      /* Convert a string to a real value
+       *   procedure val(const s : string; var v : real; var code : word);
+       *
+       * ON INPUT
+       *   TOS(0) = Address of Code
+       *   TOS(1) = Address of v
+       *   TOS(2) = Source string buffer size
+       *   TOS(3) = Pointer to source string buffer
+       *   TOS(4) = Length of source string
+       * ON RETURN: actual parameters released
+       */
+
+    case lbVALREAL :
+      {
+        char    *strPtr;
+        char    *endptr;
+        uint16_t codeAddr;
+        uint16_t valueAddr;
+        uint16_t strAlloc;
+        uint16_t strAddr;
+        uint16_t strSize;
+        uint16_t code;
+        fparg_t  value;
+        int      i;
+
+        POP(st, codeAddr);  /* Address of error code */
+        POP(st, valueAddr); /* Address of real value */
+
+        POP(st, strAlloc);  /* String buffer allocation size */
+        POP(st, strAddr);   /* Address of string buffer */
+        POP(st, strSize);   /* Size of string */
+
+        /* Make a C string out of the pascal string */
+
+        strPtr = (char *)ATSTACK(st, strAddr);
+        name   = libexec_MkCString(st, strPtr, strSize, false);
+
+        if (name == NULL)
+          {
+            errorCode = eNOMEMORY;
+          }
+        else
+          {
+            /* Skip leading spaces, then convert the rest of the string */
+
+            strPtr = name;
+            while (*strPtr == ' ')
+              {
+                strPtr++;
+              }
+
+            value.f = pstrtod(strPtr, &endptr);
+
+            if (endptr == strPtr || *endptr != '\0')
+              {
+                /* Report the 1-based position of the bad character */
+
+                code = (uint16_t)(endptr - name) + 1;
+              }
+            else
+              {
+                for (i = 0; i < 4; i++)
+                  {
+                    PUTSTACK(st, value.hw[i], valueAddr + i * BPERI);
+                  }
+
+                code = 0;
+              }
+
+            PUTSTACK(st, code, codeAddr);
+          }
+
+        /* We consumed a temporary string and probably need to free
+         * the temporary string's heap allocations.
+         */
+
+        libexec_FreeTmpString(st, strAddr, strAlloc);
+      }
+      break;
+
+      /* Concatenate a list of strings and characters into a new string.
+       *
+       *   function strcatn(s1, s2, ..., sn : string or char) : string;
+       *
+       * ON INPUT
+       *   TOS(0) = Number of operands, n
+       *   TOS(1) = Operand types:  Bit i is set if operand i is a character
+       *   TOS(2) = The last operand, sn (one word for a character, three
+       *            words for a string)
+       *   ...    = The preceding operands, down to s1
+       * ON RETURN:
+       *   TOS(0) = Allocation size of the new string
+       *   TOS(1) = Pointer to the new string
+       *   TOS(2) = Length of the new string
+       */
+
+    case lbSTRCATN :
+      {
+        uint16_t operand[MAX_STRCATN];  /* TOS index of each operand */
+        uint16_t nOperands;
+        uint16_t charMask;
+        uint16_t nWords;
+        uint32_t totalSize;
+        uint16_t strAlloc;
+        uint16_t strAddr;
+        uint16_t strSize;
+        uint16_t size;
+        int i;
+
+        POP(st, nOperands);
+        POP(st, charMask);
+
+        if (nOperands < 1 || nOperands > MAX_STRCATN)
+          {
+            errorCode = eBADSYSLIBCALL;
+            break;
+          }
+
+        /* Locate the operands and get the length of the result */
+
+        nWords    = 0;
+        totalSize = 0;
+
+        for (i = nOperands - 1; i >= 0; i--)
+          {
+            operand[i] = nWords;
+            if ((charMask & (1 << i)) != 0)
+              {
+                totalSize += sCHAR_SIZE;
+                nWords    += 1;
+              }
+            else
+              {
+                totalSize += TOS(st, nWords + 2);
+                nWords    += 3;
+              }
+          }
+
+        /* Allocate one buffer for the result.  It is at least the default
+         * size so that the result can be appended to like any other
+         * temporary string.
+         */
+
+        if (totalSize > STRING_BUFFER_MAX)
+          {
+            totalSize = STRING_BUFFER_MAX;
+          }
+
+        strAddr = libexec_AllocTmpString(st,
+                                         totalSize > STRING_BUFFER_SIZE ?
+                                         totalSize : STRING_BUFFER_SIZE,
+                                         &strAlloc);
+        if (strAddr == 0)
+          {
+            errorCode = eNOMEMORY;
+            break;
+          }
+
+        /* Copy the operands into the result, left to right */
+
+        dest    = (char *)ATSTACK(st, strAddr);
+        strSize = 0;
+
+        for (i = 0; i < nOperands; i++)
+          {
+            if ((charMask & (1 << i)) != 0)
+              {
+                if (strSize < totalSize)
+                  {
+                    dest[strSize++] = TOS(st, operand[i]);
+                  }
+              }
+            else
+              {
+                size = TOS(st, operand[i] + 2);
+                if (size > totalSize - strSize)
+                  {
+                    size = totalSize - strSize;
+                  }
+
+                memcpy(&dest[strSize],
+                       ATSTACK(st, TOS(st, operand[i] + 1)), size);
+                strSize += size;
+              }
+          }
+
+        /* Free any temporary operands, most recent first */
+
+        for (i = nOperands - 1; i >= 0; i--)
+          {
+            if ((charMask & (1 << i)) == 0)
+              {
+                libexec_FreeTmpString(st, TOS(st, operand[i] + 1),
+                                      TOS(st, operand[i]));
+              }
+          }
+
+        /* Replace the operands with the result */
+
+        DISCARD(st, nWords);
+        PUSH(st, strSize);
+        PUSH(st, strAddr);
+        PUSH(st, strAlloc);
+      }
+      break;
+
     default :
       errorCode = eBADSYSLIBCALL;
       break;
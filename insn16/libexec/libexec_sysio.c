@@ -39,12 +39,14 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <dirent.h>
 #include <string.h>
 #include <ctype.h>
@@ -60,7 +62,10 @@
 #include "pas_sysio.h"
 #include "pas_errcodes.h"
 #include "pas_error.h"
+#include "paslib.h"
+#include "execlib.h"
 
+#include "libexec_format.h"
 #include "libexec_heap.h"
 #include "libexec_longops.h"
 #include "libexec_stringlib.h"
@@ -76,6 +81,12 @@
 #  define GETS(b,s,f) fgets(b,s,f)
 #endif
 
+/* The mapping of a memory mapped file that is written grows in multiples
+ * of this size.
+ */
+
+#define MAP_GROW_SIZE (64 * 1024)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -91,20 +102,42 @@ union uWord_u
 
 typedef union uWord_u uWord_t;
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Used to pad right justified fields */
+
+static const char g_blanks[] = "                                ";
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
 
-static ustack_t libexec_ConvertInteger(uint16_t fileNumber, uint8_t *ioPtr);
+static int      libexec_SkipBlanks(FILE *stream);
+static int      libexec_SkipToken(FILE *stream, int ch);
+static void     libexec_EndToken(struct libexec_s *st, uint16_t fileNumber,
+                  int ch);
+static int      libexec_ScanInteger(FILE *stream, int ch, ustack_t *dest);
+static int      libexec_ScanReal(FILE *stream, int ch, char *buffer,
+                  int size);
 static void     libexec_ConvertReal(uint16_t *dest, uint8_t *ioPtr);
 static void     libexec_CheckEoln(struct libexec_s *st, uint16_t fileNumber,
                   char *buffer);
+static int      libexec_ReadError(FILE *stream);
 static ustack_t libexec_AllocateFile(struct libexec_s *st);
 static int      libexec_FreeFile(struct libexec_s *st, uint16_t fileNumber);
 static int      libexec_AssignFile(struct libexec_s *st, uint16_t fileNumber,
                   bool text, const char *fileName, uint16_t size);
 static int      libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
                   openMode_t openMode);
+static void     libexec_MapFile(execFileTable_t *file);
+static void     libexec_UnmapFile(execFileTable_t *file);
+static int      libexec_MapReserve(execFileTable_t *file, size_t size);
+static size_t   libexec_MapRead(execFileTable_t *file, uint8_t *dest,
+                  size_t size);
+static int      libexec_MapWrite(execFileTable_t *file, const uint8_t *src,
+                  size_t size);
 static int      libexec_CloseFile(struct libexec_s *st, uint16_t fileNumber);
 static int      libexec_RecordSize(struct libexec_s *st, uint16_t fileNumber,
                   uint16_t size);
@@ -122,11 +155,20 @@ static int      libexec_ReadString(struct libexec_s *st, uint16_t fileNumber,
                   uint16_t *stringVarPtr);
 static int      libexec_ReadReal(struct libexec_s *st, uint16_t fileNumber,
                   uint16_t *dest);
+static int      libexec_BlockRead(struct libexec_s *st, uint16_t fileNumber,
+                  uint8_t *dest, uint16_t recordSize, uint16_t count,
+                  uint16_t *result);
 
 static int      libexec_CheckWriteAccess(struct libexec_s *st,
                   uint16_t fileNumber);
+static int      libexec_WritePadding(FILE *stream, int count);
+static int      libexec_WriteField(struct libexec_s *st, uint16_t fileNumber,
+                  const char *buffer, int len, uint16_t fieldWidth);
 static int      libexec_WriteBinary(struct libexec_s *st, uint16_t fileNumber,
                   const uint8_t *src, uint16_t size);
+static int      libexec_BlockWrite(struct libexec_s *st, uint16_t fileNumber,
+                  const uint8_t *src, uint16_t recordSize, uint16_t count,
+                  uint16_t *result);
 static int      libexec_WriteInteger(struct libexec_s *st, uint16_t fileNumber,
                   int16_t value, uint16_t fieldWidth);
 static int      libexec_WriteLongInteger(struct libexec_s *st,
@@ -159,45 +201,120 @@ static int      libexec_SeekEoln(struct libexec_s *st, uint16_t fileNumber);
  ****************************************************************************/
 
 /****************************************************************************
- * Name: libexec_ConvertInteger
+ * Name: libexec_SkipBlanks
  *
  * Description:
- *   This function parses a decimal integer from ioPtr
+ *   Skip over the white space, including line breaks, that precedes a
+ *   numeric value in a text file.  Returns the first non-blank character
+ *   or EOF.
+ *
  ****************************************************************************/
 
-static ustack_t libexec_ConvertInteger(uint16_t fileNumber, uint8_t *ioPtr)
+static int libexec_SkipBlanks(FILE *stream)
 {
-  long int value = 0;
-  bool negative = false;
+  int ch;
 
-  /* Skip over leading spaces */
+  do
+    {
+      ch = getc(stream);
+    }
+  while (ch != EOF && isspace(ch));
 
-  while (isspace(*ioPtr))
+  return ch;
+}
+
+/****************************************************************************
+ * Name: libexec_SkipToken
+ *
+ * Description:
+ *   Discard a token that is not a number.  ch is its first character.  The
+ *   characters up to the next white space are consumed so that each READ
+ *   makes progress through malformed input.  Returns the character that
+ *   terminated the token.
+ *
+ ****************************************************************************/
+
+static int libexec_SkipToken(FILE *stream, int ch)
+{
+  while (ch != EOF && !isspace(ch))
     {
-      ioPtr++;
+      ch = getc(stream);
     }
 
-  /* Check for a sign */
+  return ch;
+}
 
-  if (*ioPtr == '+' || *ioPtr == '-')
+/****************************************************************************
+ * Name: libexec_EndToken
+ *
+ * Description:
+ *   Dispose of the character that terminated a numeric value.  A newline
+ *   is consumed and remembered in the eoln flag, just as when a complete
+ *   line is read.  Any other character is returned to the stream so that
+ *   the remainder of the line is available to the next READ.
+ *
+ ****************************************************************************/
+
+static void libexec_EndToken(struct libexec_s *st, uint16_t fileNumber,
+                             int ch)
+{
+  if (ch == '\n' || ch == EOF)
     {
-      negative = (*ioPtr == '-');
-      ioPtr++;
+      st->fileTable[fileNumber].eoln = true;
     }
+  else
+    {
+      (void)ungetc(ch, st->fileTable[fileNumber].stream);
+      st->fileTable[fileNumber].eoln = false;
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_ScanInteger
+ *
+ * Description:
+ *   Parse one decimal integer from the stream.  ch is the first character
+ *   of the value (see libexec_SkipBlanks).  All of the digits are consumed,
+ *   even if the value overflows.  A value out of the INTEGER range
+ *   saturates to -32768 or 32767.  Input that is not a number is skipped
+ *   (see libexec_SkipToken) and reads as zero.  Returns the character that
+ *   terminated the value.
+ *
+ ****************************************************************************/
 
+static int libexec_ScanInteger(FILE *stream, int ch, ustack_t *dest)
+{
+  int32_t value = 0;
+  bool negative = false;
+  bool digits = false;
+
+  /* Check for a sign */
 
-  while (*ioPtr >= '0' && *ioPtr <= '9')
+  if (ch == '+' || ch == '-')
     {
-      value = 10 * value + (sstack_t)(*ioPtr) - (sstack_t)'0';
-      ioPtr++;
+      negative = (ch == '-');
+      ch       = getc(stream);
+    }
 
-      if (value > INT16_MAX)
+  while (ch >= '0' && ch <= '9')
+    {
+      if (value <= INT16_MAX)
         {
-          /* errorCode = eINTEGEROVERFLOW; */
-
-          value = negative ? INT16_MAX : INT16_MAX + 1;
-          break;
+          value = 10 * value + (int32_t)ch - (int32_t)'0';
         }
+
+      digits = true;
+      ch     = getc(stream);
+    }
+
+  if (!digits)
+    {
+      ch = libexec_SkipToken(stream, ch);
+    }
+
+  if (value > INT16_MAX)
+    {
+      value = negative ? INT16_MAX + 1 : INT16_MAX;
     }
 
   if (negative)
@@ -205,62 +322,104 @@ static ustack_t libexec_ConvertInteger(uint16_t fileNumber, uint8_t *ioPtr)
       value = -value;
     }
 
-  return (ustack_t)value;
+  *dest = (ustack_t)value;
+  return ch;
 }
 
 /****************************************************************************
- * Name: libexec_ConvertReal
+ * Name: libexec_ScanReal
  *
  * Description:
- *    This function parses a decimal integer from ioPtr.
+ *   Copy the characters of one real value from the stream into buffer so
+ *   that it can be converted by libexec_ConvertReal.  ch is the first
+ *   character of the value (see libexec_SkipBlanks).  Characters that do
+ *   not fit in the buffer are consumed but discarded.  Input that is not a
+ *   number is skipped (see libexec_SkipToken) and reads as zero.  Returns
+ *   the character that terminated the value.
  *
  ****************************************************************************/
 
-static void libexec_ConvertReal(uint16_t *dest, uint8_t *inPtr)
+static int libexec_ScanReal(FILE *stream, int ch, char *buffer, int size)
 {
-  int32_t  intpart;
-  fparg_t  result;
-  double   fraction;
-  uint8_t  unaryop;
+  bool digits = false;
+  int len = 0;
 
-  intpart = 0;
-  unaryop = '+';
+#define SCANCHAR() \
+  do \
+    { \
+      if (len < size - 1) \
+        { \
+          buffer[len++] = ch; \
+        } \
+      ch = getc(stream); \
+    } \
+  while (0)
 
-  /* Check for a leading unary - */
+  /* [sign] digits [. digits] [(e|E) [sign] digits] */
 
-  if (*inPtr == '-' || *inPtr == '+')
+  if (ch == '+' || ch == '-')
     {
-      unaryop = *inPtr++;
+      SCANCHAR();
     }
 
-  /* Get the integer part of the real */
+  while (ch >= '0' && ch <= '9')
+    {
+      SCANCHAR();
+      digits = true;
+    }
 
-  while (*inPtr >= '0' && *inPtr <= '9')
+  if (ch == '.')
     {
-      intpart = 10*intpart + ((int32_t)*inPtr++) - ((int32_t)'0');
+      SCANCHAR();
+      while (ch >= '0' && ch <= '9')
+        {
+          SCANCHAR();
+          digits = true;
+        }
     }
 
-  result.f = ((double)intpart);
+  /* There must be at least one digit before the exponent */
 
-  /* Check for the a fractional part */
+  if (!digits)
+    {
+      ch  = libexec_SkipToken(stream, ch);
+      len = 0;
+    }
 
-  if (*inPtr == '.')
+  else if (ch == 'e' || ch == 'E')
     {
-      inPtr++;
-      fraction = 0.1;
-      while (*inPtr >= '0' && *inPtr <= '9')
+      SCANCHAR();
+      if (ch == '+' || ch == '-')
+        {
+          SCANCHAR();
+        }
+
+      while (ch >= '0' && ch <= '9')
         {
-          result.f += fraction * (double)(((int32_t)*inPtr++) - ((int32_t)'0'));
-          fraction /= 10.0;
+          SCANCHAR();
         }
     }
 
-  /* Correct the sign of the result */
+#undef SCANCHAR
 
-  if (unaryop == '-')
-    {
-      result.f = -result.f;
-    }
+  buffer[len] = '\0';
+  return ch;
+}
+
+/****************************************************************************
+ * Name: libexec_ConvertReal
+ *
+ * Description:
+ *    This function converts the real number in inPtr (see libexec_ScanReal)
+ *    and returns it in the P-Machine stack at dest.
+ *
+ ****************************************************************************/
+
+static void libexec_ConvertReal(uint16_t *dest, uint8_t *inPtr)
+{
+  fparg_t result;
+
+  result.f = pstrtod((const char *)inPtr, NULL);
 
   /* Return the value into the P-Machine stack */
 
@@ -297,11 +456,37 @@ static void libexec_CheckEoln(struct libexec_s *st, uint16_t fileNumber,
 
 /****************************************************************************/
 
+static int libexec_ReadError(FILE *stream)
+{
+  int errorCode;
+
+  /* A read from a non-blocking file that found no data is not a failure.
+   * The caller will undo the SYSIO operation so that it may be repeated
+   * when input is available.
+   */
+
+  if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+      errorCode = eWOULDBLOCK;
+    }
+  else
+    {
+      errorCode = eREADFAILED;
+    }
+
+  clearerr(stream);
+  return errorCode;
+}
+
+/****************************************************************************/
+
 static ustack_t libexec_AllocateFile(struct libexec_s *st)
 {
+  execFileTable_t *newTable;
   uint16_t fileNumber;
+  uint16_t nFiles;
 
-  for (fileNumber = 0; fileNumber < MAX_OPEN_FILES; fileNumber++)
+  for (fileNumber = 0; fileNumber < st->nFiles; fileNumber++)
     {
       if (!st->fileTable[fileNumber].inUse)
         {
@@ -310,7 +495,34 @@ static ustack_t libexec_AllocateFile(struct libexec_s *st)
         }
     }
 
-  return fileNumber;  /* Return the out-of-range file number */
+  /* All entries are in use.  Double the size of the file table. */
+
+  if (st->nFiles >= MAX_FILE_NUMBER)
+    {
+      return fileNumber;  /* Return the out-of-range file number */
+    }
+
+  nFiles = 2 * st->nFiles;
+  if (nFiles > MAX_FILE_NUMBER)
+    {
+      nFiles = MAX_FILE_NUMBER;
+    }
+
+  newTable = (execFileTable_t *)
+    realloc(st->fileTable, nFiles * sizeof(execFileTable_t));
+  if (newTable == NULL)
+    {
+      return fileNumber;  /* Return the out-of-range file number */
+    }
+
+  memset(&newTable[st->nFiles], 0,
+         (nFiles - st->nFiles) * sizeof(execFileTable_t));
+
+  st->fileTable = newTable;
+  st->nFiles    = nFiles;
+
+  st->fileTable[fileNumber].inUse = true;
+  return fileNumber;
 }
 
 /****************************************************************************/
@@ -319,7 +531,7 @@ static int libexec_FreeFile(struct libexec_s *st, uint16_t fileNumber)
 {
   int errorCode = eNOERROR;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -338,6 +550,7 @@ static int libexec_FreeFile(struct libexec_s *st, uint16_t fileNumber)
 
       /* Reset the entire file entry */
 
+      free(st->fileTable[fileNumber].fileName);
       memset(&st->fileTable[fileNumber], 0, sizeof(execFileTable_t));
     }
 
@@ -353,23 +566,29 @@ static int libexec_AssignFile(struct libexec_s *st, uint16_t fileNumber,
 
   /* Verify the fileNumber */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
-  else if (size > FNAME_SIZE) /* include NUL terminator */
-    {
-      errorCode = eBADFILENAME;
-    }
   else
     {
-      /* Copy the file name into the file table */
+      char *newName;
 
-      memcpy(st->fileTable[fileNumber].fileName, fileName, size);
+      /* Copy the file name into a new allocation.  NUL terminate the
+       * fileName so that we can use it like a C string.
+       */
 
-      /* NUL terminate the fileName so that we can use it like a C string */
+      newName = (char *)malloc(size + 1);
+      if (newName == NULL)
+        {
+          return eNOMEMORY;
+        }
+
+      memcpy(newName, fileName, size);
+      newName[size] = '\0';
 
-      st->fileTable[fileNumber].fileName[size] = '\0';
+      free(st->fileTable[fileNumber].fileName);
+      st->fileTable[fileNumber].fileName = newName;
 
       /* The set the file type */
 
@@ -379,6 +598,197 @@ static int libexec_AssignFile(struct libexec_s *st, uint16_t fileNumber,
   return errorCode;
 }
 
+/****************************************************************************/
+/* Map a typed file that was just opened.  If the file cannot be mapped,
+ * it is left unmapped and is accessed through its stream.
+ */
+
+static void libexec_MapFile(execFileTable_t *file)
+{
+  struct stat buf;
+  int prot;
+  int fd;
+
+  fd = fileno(file->stream);
+  if (fd < 0 || fstat(fd, &buf) < 0 || !S_ISREG(buf.st_mode))
+    {
+      return;
+    }
+
+  file->map      = NULL;
+  file->mapSize  = 0;
+  file->fileSize = buf.st_size;
+  file->diskSize = buf.st_size;
+  file->filePos  = 0;
+
+  /* An empty file has no mapping until it is written */
+
+  if (file->fileSize > 0)
+    {
+      prot = PROT_READ;
+      if (file->openMode != eOPEN_READ)
+        {
+          prot |= PROT_WRITE;
+        }
+
+      file->map = (uint8_t *)mmap(NULL, file->fileSize, prot, MAP_SHARED,
+                                  fd, 0);
+      if (file->map == MAP_FAILED)
+        {
+          file->map = NULL;
+          return;
+        }
+
+      file->mapSize = file->fileSize;
+    }
+
+  if (file->openMode == eOPEN_APPEND)
+    {
+      file->filePos = file->fileSize;
+    }
+
+  file->mapped = true;
+}
+
+/****************************************************************************/
+
+static void libexec_UnmapFile(execFileTable_t *file)
+{
+  if (file->map != NULL)
+    {
+      (void)munmap(file->map, file->mapSize);
+    }
+
+  /* Remove the unused space at the end of a file that was written */
+
+  if (file->diskSize != file->fileSize)
+    {
+      (void)ftruncate(fileno(file->stream), file->fileSize);
+    }
+
+  file->mapped   = false;
+  file->map      = NULL;
+  file->mapSize  = 0;
+  file->diskSize = 0;
+  file->fileSize = 0;
+  file->filePos  = 0;
+}
+
+/****************************************************************************/
+/* Make sure that the first 'size' bytes of a mapped file are both on disk
+ * and in the mapping.  The file grows ahead of the data so that a
+ * sequence of writes does not resize it each time.
+ */
+
+static int libexec_MapReserve(execFileTable_t *file, size_t size)
+{
+  size_t newSize;
+  int fd;
+
+  if (size <= file->diskSize && size <= file->mapSize)
+    {
+      return eNOERROR;
+    }
+
+  newSize = file->mapSize;
+  if (size > newSize)
+    {
+      newSize = MAP_GROW_SIZE;
+      while (newSize < size)
+        {
+          newSize <<= 1;
+        }
+    }
+
+  fd = fileno(file->stream);
+  if (ftruncate(fd, newSize) < 0)
+    {
+      return eWRITEFAILED;
+    }
+
+  file->diskSize = newSize;
+
+  if (newSize != file->mapSize)
+    {
+      if (file->map != NULL)
+        {
+          (void)munmap(file->map, file->mapSize);
+        }
+
+      file->map = (uint8_t *)mmap(NULL, newSize, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, fd, 0);
+      if (file->map == MAP_FAILED)
+        {
+          file->map     = NULL;
+          file->mapSize = 0;
+          return eWRITEFAILED;
+        }
+
+      file->mapSize = newSize;
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************/
+/* Copy up to 'size' bytes from the current position of a mapped file.
+ * Returns the number of bytes copied.
+ */
+
+static size_t libexec_MapRead(execFileTable_t *file, uint8_t *dest,
+                              size_t size)
+{
+  size_t avail = 0;
+
+  if (file->filePos < file->fileSize)
+    {
+      avail = file->fileSize - file->filePos;
+    }
+
+  if (size > avail)
+    {
+      size = avail;
+    }
+
+  if (size > 0)
+    {
+      memcpy(dest, &file->map[file->filePos], size);
+      file->filePos += size;
+    }
+
+  return size;
+}
+
+/****************************************************************************/
+
+static int libexec_MapWrite(execFileTable_t *file, const uint8_t *src,
+                            size_t size)
+{
+  size_t endPos;
+  int errorCode;
+
+  /* Like stdio, a file opened for append is always written at the end */
+
+  if (file->openMode == eOPEN_APPEND)
+    {
+      file->filePos = file->fileSize;
+    }
+
+  endPos    = file->filePos + size;
+  errorCode = libexec_MapReserve(file, endPos);
+  if (errorCode == eNOERROR && size > 0)
+    {
+      memcpy(&file->map[file->filePos], src, size);
+      file->filePos = endPos;
+      if (endPos > file->fileSize)
+        {
+          file->fileSize = endPos;
+        }
+    }
+
+  return errorCode;
+}
+
 /****************************************************************************/
 
 static int libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
@@ -388,7 +798,7 @@ static int libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
 
   const char *modeString;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -396,8 +806,18 @@ static int libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
     {
       errorCode = eFILEALREADYOPEN;
     }
+  else if (st->fileTable[fileNumber].fileName == NULL)
+    {
+      errorCode = eOPENFAILED;  /* File was never assigned */
+    }
   else
     {
+      /* A typed file may be memory mapped.  A writable mapping requires
+       * that the file be opened for both reading and writing.
+       */
+
+      bool mapFile = st->mapFiles && !st->fileTable[fileNumber].text;
+
       switch (openMode)
         {
           case eOPEN_READ :
@@ -405,11 +825,11 @@ static int libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
             break;
 
           case eOPEN_WRITE :
-            modeString = "w";
+            modeString = mapFile ? "w+" : "w";
             break;
 
           case eOPEN_APPEND :
-            modeString = "a";
+            modeString = mapFile ? "a+" : "a";
             break;
 
           default :
@@ -425,6 +845,10 @@ static int libexec_OpenFile(struct libexec_s *st, uint16_t fileNumber,
       else
         {
           st->fileTable[fileNumber].openMode = openMode;
+          if (mapFile)
+            {
+              libexec_MapFile(&st->fileTable[fileNumber]);
+            }
         }
     }
 
@@ -437,7 +861,7 @@ static int libexec_CloseFile(struct libexec_s *st, uint16_t fileNumber)
 {
   int errorCode = eNOERROR;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -447,6 +871,11 @@ static int libexec_CloseFile(struct libexec_s *st, uint16_t fileNumber)
     }
   else
     {
+      if (st->fileTable[fileNumber].mapped)
+        {
+          libexec_UnmapFile(&st->fileTable[fileNumber]);
+        }
+
       (void)fclose(st->fileTable[fileNumber].stream);
       st->fileTable[fileNumber].stream = NULL;
     }
@@ -461,7 +890,7 @@ static int libexec_RecordSize(struct libexec_s *st, uint16_t fileNumber,
 {
   int errorCode = eNOERROR;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -479,7 +908,7 @@ static int libexec_CheckReadAccess(struct libexec_s *st, uint16_t fileNumber)
 {
   int errorCode;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -516,6 +945,19 @@ static int libexec_ReadLn(struct libexec_s *st, uint16_t fileNumber)
               ch = fgetc(st->fileTable[fileNumber].stream);
             }
           while (ch != EOF && ch != '\n');
+
+          /* If input ran out on a non-blocking file, the rest of the line
+           * will be skipped when the operation is repeated.
+           */
+
+          if (ch == EOF && ferror(st->fileTable[fileNumber].stream))
+            {
+              errorCode = libexec_ReadError(st->fileTable[fileNumber].stream);
+              if (errorCode != eWOULDBLOCK)
+                {
+                  errorCode = eNOERROR;
+                }
+            }
         }
     }
 
@@ -528,10 +970,18 @@ static int libexec_ReadBinary(struct libexec_s *st, uint16_t fileNumber,
                               uint8_t *dest, uint16_t size)
 {
   int errorCode = libexec_CheckReadAccess(st, fileNumber);
-  if (errorCode == eNOERROR)
+  if (errorCode == eNOERROR && st->fileTable[fileNumber].mapped)
+    {
+      (void)libexec_MapRead(&st->fileTable[fileNumber], dest, size);
+    }
+  else if (errorCode == eNOERROR)
     {
       size_t nitems = fread(dest, 1, size, st->fileTable[fileNumber].stream);
-      if (nitems < size && ferror(st->fileTable[fileNumber].stream))
+      if (nitems == 0 && ferror(st->fileTable[fileNumber].stream))
+        {
+          errorCode = libexec_ReadError(st->fileTable[fileNumber].stream);
+        }
+      else if (nitems < size && ferror(st->fileTable[fileNumber].stream))
         {
           errorCode = eREADFAILED;
           clearerr(st->fileTable[fileNumber].stream);
@@ -543,24 +993,80 @@ static int libexec_ReadBinary(struct libexec_s *st, uint16_t fileNumber,
 
 /****************************************************************************/
 
+static int libexec_BlockRead(struct libexec_s *st, uint16_t fileNumber,
+                             uint8_t *dest, uint16_t recordSize,
+                             uint16_t count, uint16_t *result)
+{
+  int errorCode = libexec_CheckReadAccess(st, fileNumber);
+
+  *result = 0;
+  if (errorCode == eNOERROR && recordSize > 0 && count > 0 &&
+      st->fileTable[fileNumber].mapped)
+    {
+      execFileTable_t *file = &st->fileTable[fileNumber];
+      size_t nitems = 0;
+
+      /* Only whole records are transferred */
+
+      if (file->filePos < file->fileSize)
+        {
+          nitems = (file->fileSize - file->filePos) / recordSize;
+        }
+
+      if (nitems > count)
+        {
+          nitems = count;
+        }
+
+      (void)libexec_MapRead(file, dest, nitems * recordSize);
+      *result = (uint16_t)nitems;
+    }
+  else if (errorCode == eNOERROR && recordSize > 0 && count > 0)
+    {
+      FILE *stream  = st->fileTable[fileNumber].stream;
+      size_t nitems = fread(dest, recordSize, count, stream);
+
+      if (nitems == 0 && ferror(stream))
+        {
+          errorCode = libexec_ReadError(stream);
+        }
+      else if (nitems < count && ferror(stream))
+        {
+          errorCode = eREADFAILED;
+          clearerr(stream);
+        }
+
+      *result = (uint16_t)nitems;
+    }
+
+  return errorCode;
+}
+
+/****************************************************************************/
+
 static int libexec_ReadInteger(struct libexec_s *st, uint16_t fileNumber,
                                ustack_t *dest)
 {
   int errorCode = libexec_CheckReadAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      char *ptr = GETS((char *)st->ioBuffer, LINE_SIZE,
-                       st->fileTable[fileNumber].stream);
+      FILE *stream = st->fileTable[fileNumber].stream;
+      int ch;
 
-      if (ptr == NULL && ferror(st->fileTable[fileNumber].stream))
+      /* Consume exactly one value, leaving the rest of the line in the
+       * stream for the next READ.
+       */
+
+      ch = libexec_SkipBlanks(stream);
+      ch = libexec_ScanInteger(stream, ch, dest);
+
+      if (ch == EOF && ferror(stream))
         {
-          errorCode = eREADFAILED;
-          clearerr(st->fileTable[fileNumber].stream);
+          errorCode = libexec_ReadError(stream);
         }
       else
         {
-          libexec_CheckEoln(st, fileNumber, (char *)st->ioBuffer);
-          *dest = libexec_ConvertInteger(fileNumber, st->ioBuffer);
+          libexec_EndToken(st, fileNumber, ch);
         }
     }
 
@@ -580,8 +1086,7 @@ static int libexec_ReadChar(struct libexec_s *st, uint16_t fileNumber,
 
       if (ptr == NULL && ferror(st->fileTable[fileNumber].stream))
         {
-          errorCode = eREADFAILED;
-          clearerr(st->fileTable[fileNumber].stream);
+          errorCode = libexec_ReadError(st->fileTable[fileNumber].stream);
         }
       else
         {
@@ -618,8 +1123,7 @@ static int libexec_ReadString(struct libexec_s *st, uint16_t fileNumber,
 
       if (ptr == NULL && ferror(st->fileTable[fileNumber].stream))
         {
-          errorCode = eREADFAILED;
-          clearerr(st->fileTable[fileNumber].stream);
+          errorCode = libexec_ReadError(st->fileTable[fileNumber].stream);
         }
       else
         {
@@ -637,17 +1141,19 @@ static int libexec_ReadReal(struct libexec_s *st, uint16_t fileNumber,
   int errorCode = libexec_CheckReadAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      char *ptr = GETS((char*)st->ioBuffer, LINE_SIZE,
-                       st->fileTable[fileNumber].stream);
+      FILE *stream = st->fileTable[fileNumber].stream;
+      int ch;
 
-      if (ptr == NULL && ferror(st->fileTable[fileNumber].stream))
+      ch = libexec_SkipBlanks(stream);
+      ch = libexec_ScanReal(stream, ch, (char *)st->ioBuffer, LINE_SIZE);
+
+      if (ch == EOF && ferror(stream))
         {
-          errorCode = eREADFAILED;
-          clearerr(st->fileTable[fileNumber].stream);
+          errorCode = libexec_ReadError(stream);
         }
       else
         {
-          libexec_CheckEoln(st, fileNumber, (char *)st->ioBuffer);
+          libexec_EndToken(st, fileNumber, ch);
           libexec_ConvertReal(dest, st->ioBuffer);
         }
     }
@@ -661,7 +1167,7 @@ static int libexec_CheckWriteAccess(struct libexec_s *st, uint16_t fileNumber)
 {
   int errorCode;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -679,13 +1185,79 @@ static int libexec_CheckWriteAccess(struct libexec_s *st, uint16_t fileNumber)
   return errorCode;
 }
 
+/****************************************************************************
+ * Name: libexec_WritePadding
+ *
+ * Description:
+ *   Write count spaces to the stream.  Nothing is written if count is
+ *   zero or negative.
+ *
+ ****************************************************************************/
+
+static int libexec_WritePadding(FILE *stream, int count)
+{
+  while (count > 0)
+    {
+      int nblanks = count;
+
+      if (nblanks > sizeof(g_blanks) - 1)
+        {
+          nblanks = sizeof(g_blanks) - 1;
+        }
+
+      if (fwrite(g_blanks, 1, nblanks, stream) < nblanks)
+        {
+          return eWRITEFAILED;
+        }
+
+      count -= nblanks;
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_WriteField
+ *
+ * Description:
+ *   Write a formatted value right justified in the field width provided
+ *   in the upper byte of fieldWidth.  The data goes directly into the
+ *   stream's buffer.
+ *
+ ****************************************************************************/
+
+static int libexec_WriteField(struct libexec_s *st, uint16_t fileNumber,
+                              const char *buffer, int len,
+                              uint16_t fieldWidth)
+{
+  FILE *stream = st->fileTable[fileNumber].stream;
+  int errorCode;
+
+  errorCode = libexec_WritePadding(stream, (int)(fieldWidth >> 8) - len);
+  if (errorCode == eNOERROR && fwrite(buffer, 1, len, stream) < len)
+    {
+      errorCode = eWRITEFAILED;
+    }
+
+  if (errorCode != eNOERROR)
+    {
+      clearerr(stream);
+    }
+
+  return errorCode;
+}
+
 /****************************************************************************/
 
 static int libexec_WriteBinary(struct libexec_s *st, uint16_t fileNumber,
                                const uint8_t *src, uint16_t size)
 {
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
-  if (errorCode == eNOERROR)
+  if (errorCode == eNOERROR && st->fileTable[fileNumber].mapped)
+    {
+      errorCode = libexec_MapWrite(&st->fileTable[fileNumber], src, size);
+    }
+  else if (errorCode == eNOERROR)
     {
       ssize_t nitems = fwrite(src, 1, size, st->fileTable[fileNumber].stream);
       if (nitems < 0 && ferror(st->fileTable[fileNumber].stream))
@@ -700,18 +1272,53 @@ static int libexec_WriteBinary(struct libexec_s *st, uint16_t fileNumber,
 
 /****************************************************************************/
 
-static int libexec_WriteInteger(struct libexec_s *st, uint16_t fileNumber,
-                                int16_t value, uint16_t fieldWidth)
+static int libexec_BlockWrite(struct libexec_s *st, uint16_t fileNumber,
+                              const uint8_t *src, uint16_t recordSize,
+                              uint16_t count, uint16_t *result)
 {
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
-  if (errorCode == eNOERROR)
+
+  *result = 0;
+  if (errorCode == eNOERROR && recordSize > 0 && count > 0 &&
+      st->fileTable[fileNumber].mapped)
+    {
+      errorCode = libexec_MapWrite(&st->fileTable[fileNumber], src,
+                                   (size_t)recordSize * count);
+      if (errorCode == eNOERROR)
+        {
+          *result = count;
+        }
+    }
+  else if (errorCode == eNOERROR && recordSize > 0 && count > 0)
     {
-      const char *fmt = libexec_GetFormat("d", fieldWidth >> 8, 0);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
+      FILE *stream  = st->fileTable[fileNumber].stream;
+      size_t nitems = fwrite(src, recordSize, count, stream);
+
+      if (nitems < count)
         {
           errorCode = eWRITEFAILED;
+          clearerr(stream);
         }
+
+      *result = (uint16_t)nitems;
+    }
+
+  return errorCode;
+}
+
+/****************************************************************************/
+
+static int libexec_WriteInteger(struct libexec_s *st, uint16_t fileNumber,
+                                int16_t value, uint16_t fieldWidth)
+{
+  int errorCode = libexec_CheckWriteAccess(st, fileNumber);
+  if (errorCode == eNOERROR)
+    {
+      char buffer[FORMAT_NUMSIZE];
+      int len = libexec_FormatSigned(buffer, value);
+
+      errorCode = libexec_WriteField(st, fileNumber, buffer, len,
+                                     fieldWidth);
     }
 
   return errorCode;
@@ -726,12 +1333,11 @@ static int libexec_WriteLongInteger(struct libexec_s *st,
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      const char *fmt = libexec_GetFormat(PRId32, fieldWidth >> 8, 0);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
-        {
-          errorCode = eWRITEFAILED;
-        }
+      char buffer[FORMAT_NUMSIZE];
+      int len = libexec_FormatSigned(buffer, value);
+
+      errorCode = libexec_WriteField(st, fileNumber, buffer, len,
+                                     fieldWidth);
     }
 
   return errorCode;
@@ -745,12 +1351,11 @@ static int libexec_WriteWord(struct libexec_s *st, uint16_t fileNumber,
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      const char *fmt = libexec_GetFormat("u", fieldWidth >> 8, 0);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
-        {
-          errorCode = eWRITEFAILED;
-        }
+      char buffer[FORMAT_NUMSIZE];
+      int len = libexec_FormatUnsigned(buffer, value);
+
+      errorCode = libexec_WriteField(st, fileNumber, buffer, len,
+                                     fieldWidth);
     }
 
   return errorCode;
@@ -764,12 +1369,11 @@ static int libexec_WriteLongWord(struct libexec_s *st, uint16_t fileNumber,
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      const char *fmt = libexec_GetFormat(PRIu32, fieldWidth >> 8, 0);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
-        {
-          errorCode = eWRITEFAILED;
-        }
+      char buffer[FORMAT_NUMSIZE];
+      int len = libexec_FormatUnsigned(buffer, value);
+
+      errorCode = libexec_WriteField(st, fileNumber, buffer, len,
+                                     fieldWidth);
     }
 
   return errorCode;
@@ -783,13 +1387,8 @@ static int libexec_WriteChar(struct libexec_s *st, uint16_t fileNumber,
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      const char *fmt = libexec_GetFormat("c", fieldWidth >> 8, 0);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
-        {
-          errorCode = eWRITEFAILED;
-          clearerr(st->fileTable[fileNumber].stream);
-        }
+      errorCode = libexec_WriteField(st, fileNumber, (const char *)&value,
+                                     1, fieldWidth);
     }
 
   return errorCode;
@@ -803,12 +1402,28 @@ static int libexec_WriteReal(struct libexec_s *st, uint16_t fileNumber,
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
   if (errorCode == eNOERROR)
     {
-      const char *fmt = libexec_GetFormat("f", fieldWidth >> 8,
-                                          fieldWidth & 0x00ff);
-      int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt, value);
-      if (nbytes < 0)
+      char buffer[FORMAT_NUMSIZE];
+      int len = libexec_FormatReal(buffer, value, fieldWidth >> 8,
+                                   fieldWidth & 0x00ff);
+      if (len >= 0)
         {
-          errorCode = eWRITEFAILED;
+          errorCode = libexec_WriteField(st, fileNumber, buffer, len,
+                                         fieldWidth);
+        }
+      else
+        {
+          /* Very large values, infinities, NaNs, and very high precisions
+           * are left to printf.
+           */
+
+          const char *fmt = libexec_GetFormat(st, "f", fieldWidth >> 8,
+                                              fieldWidth & 0x00ff);
+          int nbytes = fprintf(st->fileTable[fileNumber].stream, fmt,
+                               value);
+          if (nbytes < 0)
+            {
+              errorCode = eWRITEFAILED;
+            }
         }
     }
 
@@ -830,10 +1445,8 @@ static int libexec_WriteString(struct libexec_s *st, uint16_t fileNumber,
 
       /* Right justify */
 
-      for (fieldWidth >>= 8; fieldWidth > strSize; fieldWidth--)
-        {
-          fputc(' ', st->fileTable[fileNumber].stream);
-        }
+      libexec_WritePadding(st->fileTable[fileNumber].stream,
+                           (int)(fieldWidth >> 8) - strSize);
 
       /* Then write the string */
 
@@ -859,7 +1472,21 @@ static int libexec_WriteString(struct libexec_s *st, uint16_t fileNumber,
 static int libexec_Flush(struct libexec_s *st, uint16_t fileNumber)
 {
   int errorCode = libexec_CheckWriteAccess(st, fileNumber);
-  if (errorCode == eNOERROR)
+  if (errorCode == eNOERROR && st->fileTable[fileNumber].mapped)
+    {
+      execFileTable_t *file = &st->fileTable[fileNumber];
+
+      /* The written data is already in the file.  Trim the space reserved
+       * for more writes so that the file has its true size.
+       */
+
+      if (file->diskSize != file->fileSize &&
+          ftruncate(fileno(file->stream), file->fileSize) == 0)
+        {
+          file->diskSize = file->fileSize;
+        }
+    }
+  else if (errorCode == eNOERROR)
     {
       /* Flush the write data */
 
@@ -923,7 +1550,7 @@ static int libexec_Eof(struct libexec_s *st, uint16_t fileNumber)
   int errorCode = eNOERROR;
   uint16_t eof = PASCAL_FALSE;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
       eof       = PASCAL_TRUE;
@@ -933,14 +1560,43 @@ static int libexec_Eof(struct libexec_s *st, uint16_t fileNumber)
       errorCode = eFILENOTOPEN;
       eof       = PASCAL_TRUE;
     }
+  else if (st->fileTable[fileNumber].mapped)
+    {
+      if (st->fileTable[fileNumber].filePos >=
+          st->fileTable[fileNumber].fileSize)
+        {
+          eof = PASCAL_TRUE;
+        }
+    }
   else if (feof(st->fileTable[fileNumber].stream))
     {
       eof = PASCAL_TRUE;
     }
 
-  /* ftell not meaningful on stdin (or pipes or sockets, etc.) */
+  /* ftell not meaningful on stdin (or pipes or sockets, etc.).  Instead,
+   * peek at the next character so that EOF becomes true as soon as the last
+   * value has been read, not only after a READ has failed.
+   */
+
+  else if (fileNumber == INPUT_FILE_NUMBER)
+    {
+      int ch = getc(st->fileTable[fileNumber].stream);
+      if (ch != EOF)
+        {
+          (void)ungetc(ch, st->fileTable[fileNumber].stream);
+        }
+      else if (ferror(st->fileTable[fileNumber].stream))
+        {
+          /* No input available yet on a non-blocking file */
 
-  else if (fileNumber != 0)
+          clearerr(st->fileTable[fileNumber].stream);
+        }
+      else
+        {
+          eof = PASCAL_TRUE;
+        }
+    }
+  else
     {
       off_t fileSize;
       off_t filePos;
@@ -978,7 +1634,7 @@ static int libexec_Eoln(struct libexec_s *st, uint16_t fileNumber)
   int errorCode = eNOERROR;
   uint16_t eoln;
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
       eoln      = PASCAL_TRUE;
@@ -1006,7 +1662,7 @@ static int libexec_FilePos(struct libexec_s *st, uint16_t fileNumber)
    *   TOS(0)   - fileNumber
    */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -1014,6 +1670,10 @@ static int libexec_FilePos(struct libexec_s *st, uint16_t fileNumber)
     {
       errorCode = eFILENOTOPEN;
     }
+  else if (st->fileTable[fileNumber].mapped)
+    {
+      libexec_UPush32(st, (uint32_t)st->fileTable[fileNumber].filePos);
+    }
   else
     {
       off_t pos = ftell(st->fileTable[fileNumber].stream);
@@ -1043,7 +1703,7 @@ static int libexec_FileSize(struct libexec_s *st, uint16_t fileNumber)
    *   TOS(0)   - fileNumber
    */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -1051,6 +1711,10 @@ static int libexec_FileSize(struct libexec_s *st, uint16_t fileNumber)
     {
       errorCode = eFILENOTOPEN;
     }
+  else if (st->fileTable[fileNumber].mapped)
+    {
+      libexec_UPush32(st, (uint32_t)st->fileTable[fileNumber].fileSize);
+    }
   else
     {
       off_t fileSize;
@@ -1076,13 +1740,13 @@ static int libexec_Seek(struct libexec_s *st, uint16_t fileNumber, uint32_t file
   /* FORM: procedure Seek(var f : file; Pos : Int64);
    *
    * Entry:
-   *   TOS(0)   - fileNumber
-   *   TOS(1-3) - filePos
+   *   TOS(0-1) - filePos
+   *   TOS(2)   - fileNumber
    *
    * REVISIT:  Int64 not yet implemented; substituting LongInteger.
    */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -1090,6 +1754,10 @@ static int libexec_Seek(struct libexec_s *st, uint16_t fileNumber, uint32_t file
     {
       errorCode = eFILENOTOPEN;
     }
+  else if (st->fileTable[fileNumber].mapped)
+    {
+      st->fileTable[fileNumber].filePos = filePos;
+    }
   else
     {
       int ret = fseek(st->fileTable[fileNumber].stream, filePos, SEEK_SET);
@@ -1121,7 +1789,7 @@ static int libexec_SeekEof(struct libexec_s *st, uint16_t fileNumber)
    *            False: Non-white space character found before EOF.
    */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -1171,7 +1839,7 @@ static int libexec_SeekEoln(struct libexec_s *st, uint16_t fileNumber)
    *            False: Non-white space character found before EOLN.
    */
 
-  if (fileNumber >= MAX_OPEN_FILES)
+  if (fileNumber >= st->nFiles)
     {
       errorCode = eBADFILE;
     }
@@ -1209,35 +1877,84 @@ void libexec_InitializeFile(struct libexec_s *st)
 {
   int fileNumber;
 
-  /* Close all open files (except INPUT and OUTPUT). */
+  /* Close all open files (except INPUT and OUTPUT) and free the file
+   * names.
+   */
 
-  for (fileNumber = 2; fileNumber < MAX_OPEN_FILES; fileNumber++)
+  for (fileNumber = 0; fileNumber < st->nFiles; fileNumber++)
     {
-      if (st->fileTable[fileNumber].stream != NULL)
+      if (fileNumber > OUTPUT_FILE_NUMBER &&
+          st->fileTable[fileNumber].stream != NULL)
         {
-          (void)fclose(st->fileTable[fileNumber].stream);
+          (void)libexec_CloseFile(st, fileNumber);
         }
+
+      free(st->fileTable[fileNumber].fileName);
     }
 
   /* Then Re-initalize INPUT and OUTPUT */
 
-  memset(st->fileTable, 0, MAX_OPEN_FILES * sizeof(execFileTable_t));
+  memset(st->fileTable, 0, st->nFiles * sizeof(execFileTable_t));
 
-  strcpy(st->fileTable[INPUT_FILE_NUMBER].fileName, "INPUT");
+  st->fileTable[INPUT_FILE_NUMBER].fileName    = strdup("INPUT");
   st->fileTable[INPUT_FILE_NUMBER].inUse       = true;
   st->fileTable[INPUT_FILE_NUMBER].text        = true;
   st->fileTable[INPUT_FILE_NUMBER].recordSize  = 1;
-  st->fileTable[INPUT_FILE_NUMBER].stream      = stdin;
+  st->fileTable[INPUT_FILE_NUMBER].stream      = st->input;
   st->fileTable[INPUT_FILE_NUMBER].openMode    = eOPEN_READ;
 
-  strcpy(st->fileTable[OUTPUT_FILE_NUMBER].fileName, "OUTPUT");
+  st->fileTable[OUTPUT_FILE_NUMBER].fileName   = strdup("OUTPUT");
   st->fileTable[OUTPUT_FILE_NUMBER].inUse      = true;
   st->fileTable[OUTPUT_FILE_NUMBER].text       = true;
   st->fileTable[OUTPUT_FILE_NUMBER].recordSize = 1;
-  st->fileTable[OUTPUT_FILE_NUMBER].stream     = stdout;
+  st->fileTable[OUTPUT_FILE_NUMBER].stream     = st->output;
   st->fileTable[OUTPUT_FILE_NUMBER].openMode   = eOPEN_WRITE;
 }
 
+/****************************************************************************/
+
+void libexec_ReleaseFiles(struct libexec_s *st)
+{
+  int fileNumber;
+
+  for (fileNumber = 0; fileNumber < st->nFiles; fileNumber++)
+    {
+      if (fileNumber > OUTPUT_FILE_NUMBER &&
+          st->fileTable[fileNumber].stream != NULL)
+        {
+          (void)libexec_CloseFile(st, fileNumber);
+        }
+
+      free(st->fileTable[fileNumber].fileName);
+    }
+
+  free(st->fileTable);
+  st->fileTable = NULL;
+  st->nFiles    = 0;
+}
+
+/****************************************************************************
+ * Name: libexec_SetFileMapping
+ *
+ * Description:
+ *   Select whether typed files (FILE OF) are memory mapped when they are
+ *   opened.  SEEK, READ, WRITE, BLOCKREAD, BLOCKWRITE, FILEPOS, FILESIZE
+ *   and EOF on a mapped file are then memory operations with no system
+ *   call.  A file that cannot be mapped, such as a pipe, is accessed
+ *   through stdio as before.  Files that are already open are not
+ *   affected.
+ *
+ *   The mapping of a file is shared with other processes.  If another
+ *   process truncates the file while it is mapped, the program may fail.
+ *
+ ****************************************************************************/
+
+void libexec_SetFileMapping(EXEC_HANDLE_t handle, bool enable)
+{
+  struct libexec_s *st = (struct libexec_s *)handle;
+  st->mapFiles = enable;
+}
+
 /****************************************************************************
  * Name: libexec_sysio
  *
@@ -1248,6 +1965,7 @@ void libexec_InitializeFile(struct libexec_s *st)
 
 int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
 {
+  pasSize_t savedSp = st->sp;
   fparg_t  fp;
   uint16_t fileNumber;
   uint16_t fieldWidth;
@@ -1259,11 +1977,11 @@ int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
 
   switch (subfunc)
     {
-    /* ALLOCFILE: No stack arguments */
+    /* ALLOCFILE: No stack arguments.  The file table grows if needed. */
 
     case xALLOCFILE :
        fileNumber = libexec_AllocateFile(st);
-       if (fileNumber >= MAX_OPEN_FILES)
+       if (fileNumber >= st->nFiles)
          {
            errorCode = eTOOMANYFILES;
          }
@@ -1306,8 +2024,8 @@ int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
       errorCode = libexec_FileSize(st, fileNumber);
       break;
 
-    /* SEEK: TOS(0) = File number
-     *       TOS(2-3) = Int64 file position
+    /* SEEK: TOS(0-1) = Int64 file position
+     *       TOS(2)   = File number
      *
      * REVISIT:  Int64 not yet implemented; substituting LongInteger.
      */
@@ -1316,8 +2034,8 @@ int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
       {
         uint32_t filePos;
 
-        POP(st, fileNumber); /* File number */
         filePos = libexec_UPop32(st);
+        POP(st, fileNumber); /* File number */
         errorCode = libexec_Seek(st, fileNumber, filePos);
       }
       break;
@@ -1344,14 +2062,27 @@ int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
      */
 
     case xASSIGNFILE :
-      DISCARD(st, 1);       /* Discard the strung buffer allocation size */
-      POP(st, address);     /* File name string address */
-      POP(st, dataSize);    /* File name string size */
-      POP(st, uValue);      /* Binary/text boolean from stack */
-      POP(st, fileNumber);  /* File number from stack */
-      errorCode = libexec_AssignFile(st, fileNumber, (uValue != 0),
-                                     (const char *)&st->dstack.b[address],
-                                     dataSize);
+      {
+        uint16_t allocSize;
+
+        POP(st, allocSize);   /* String buffer allocation size */
+        POP(st, address);     /* File name string address */
+        POP(st, dataSize);    /* File name string size */
+        POP(st, uValue);      /* Binary/text boolean from stack */
+        POP(st, fileNumber);  /* File number from stack */
+        errorCode = libexec_AssignFile(st, fileNumber, (uValue != 0),
+                                       (const char *)&st->dstack.b[address],
+                                       dataSize);
+
+        /* The file table holds its own copy of the name.  Release the
+         * string buffer if it is a temporary.
+         */
+
+        if (errorCode == eNOERROR)
+          {
+            errorCode = libexec_FreeTmpString(st, address, allocSize);
+          }
+      }
       break;
 
     /* RESET: TOS(0) = File number */
@@ -2085,35 +2816,94 @@ int libexec_sysio(struct libexec_s *st, uint16_t subfunc)
       }
       break;
 
+    /* BLOCKREAD:  TOS(0) = Number of records to transfer
+     *             TOS(1) = Size of the buffer in bytes
+     *             TOS(2) = Buffer address
+     *             TOS(3) = Record size
+     *             TOS(4) = File number
+     * BLOCKWRITE: Same
+     *
+     * On return, TOS(0) = Number of records actually transferred
+     */
+
+    case xBLOCKREAD :
+    case xBLOCKWRITE :
+      {
+        uint16_t recordSize;
+        uint16_t bufferSize;
+        uint16_t count;
+        uint16_t result = 0;
+        uint32_t nbytes;
+
+        POP(st, count);       /* Number of records */
+        POP(st, bufferSize);  /* Size of the buffer */
+        POP(st, address);     /* Buffer address */
+        POP(st, recordSize);  /* Size of one record */
+        POP(st, fileNumber);  /* File number from stack */
+
+        /* The whole transfer must lie within the buffer variable */
+
+        nbytes = (uint32_t)count * (uint32_t)recordSize;
+        if (nbytes > bufferSize ||
+            (uint32_t)address + nbytes > st->stackSize)
+          {
+            errorCode = eVALUERANGE;
+          }
+        else if (subfunc == xBLOCKREAD)
+          {
+            errorCode = libexec_BlockRead(st, fileNumber,
+                                          &st->dstack.b[address],
+                                          recordSize, count, &result);
+          }
+        else
+          {
+            errorCode = libexec_BlockWrite(st, fileNumber,
+                                           &st->dstack.b[address],
+                                           recordSize, count, &result);
+          }
+
+        PUSH(st, result);
+      }
+      break;
+
     default :
       errorCode = eBADSYSIOFUNC;
       break;
     }
 
+  /* If a read would block, restore the stack arguments.  Reads do not push
+   * anything before they fail, so the arguments are still in place.
+   */
+
+  if (errorCode == eWOULDBLOCK)
+    {
+      st->sp = savedSp;
+    }
+
   return errorCode;
 }
 
 /****************************************************************************/
 
-const char *libexec_GetFormat(const char *baseFormat, uint8_t fieldWidth,
-                              uint8_t precision)
+const char *libexec_GetFormat(struct libexec_s *st, const char *baseFormat,
+                              uint8_t fieldWidth, uint8_t precision)
 {
-  static char fmt[20];
+  char *fmt = st->fmtBuffer;
 
   if (fieldWidth > 0)
     {
       if (precision > 0)
         {
-          snprintf(fmt, 20, "%%%u.%u%s", fieldWidth, precision, baseFormat);
+          snprintf(fmt, FORMAT_SIZE, "%%%u.%u%s", fieldWidth, precision, baseFormat);
         }
       else
         {
-          snprintf(fmt, 20, "%%%u%s", fieldWidth, baseFormat);
+          snprintf(fmt, FORMAT_SIZE, "%%%u%s", fieldWidth, baseFormat);
         }
     }
   else
     {
-      snprintf(fmt, 20, "%%%s", baseFormat);
+      snprintf(fmt, FORMAT_SIZE, "%%%s", baseFormat);
     }
 
   return fmt;
@@ -49,8 +49,9 @@
  ***************************************************************************/
 
 void libexec_InitializeFile(struct libexec_s *st);
+void libexec_ReleaseFiles(struct libexec_s *st);
 int  libexec_sysio(struct libexec_s *st, uint16_t subfunc);
-const char *libexec_GetFormat(const char *baseFormat, uint8_t fieldWidth,
-                              uint8_t precision);
+const char *libexec_GetFormat(struct libexec_s *st, const char *baseFormat,
+                              uint8_t fieldWidth, uint8_t precision);
 
 #endif /* __LIBEXEC_SYSIO_H */
@@ -0,0 +1,809 @@
+/****************************************************************************
+ * libexec_verify.c
+ * Load-time verification of I-Space
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "paslib.h"
+#include "pas_machine.h"
+#include "insn16.h"
+#include "longops.h"
+#include "pas_errcodes.h"
+
+#include "libexec.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Stack effects that are not a number of words */
+
+#define SE_ILLEGAL     (INT32_MIN)     /* Not a legal instruction */
+#define SE_UNKNOWN     (INT32_MIN + 1) /* Cannot be determined statically */
+
+/* The stack depth of an instruction whose depth is not known */
+
+#define DEPTH_UNKNOWN  (INT16_MIN)
+
+/* The constant at the top of the stack is not known */
+
+#define NO_CONST       (-1)
+
+/* Instruction state flags */
+
+#define VF_INSN        (1 << 0)  /* First byte of an instruction */
+#define VF_VISITED     (1 << 1)  /* Reached by the flow analysis */
+#define VF_QUEUED      (1 << 2)  /* Waiting in the work list */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* What is known about the state of the machine at the start of one
+ * instruction.  The depth is the number of words pushed since entry into
+ * the enclosing procedure (or program).  The constant is the value of the
+ * word at the top of the stack if it was pushed by the immediately
+ * preceding instruction on every path; the LDM and STM families take
+ * their size from it.
+ */
+
+struct libexec_vstate_s
+{
+  int16_t  depth;     /* Stack depth in words or DEPTH_UNKNOWN */
+  uint8_t  level;     /* Static nesting level of the enclosing procedure */
+  uint8_t  flags;     /* See VF_* definitions */
+  int32_t  tosConst;  /* Constant at the top of the stack or NO_CONST */
+};
+
+/* The state of one verification */
+
+struct libexec_verify_s
+{
+  const uint8_t *ispace;              /* I-Space being verified */
+  pasSize_t maxpc;                    /* Size of I-Space */
+  struct libexec_vstate_s *state;     /* One entry per I-Space address */
+  uint16_t *work;                     /* Work list of I-Space addresses */
+  pasSize_t nwork;                    /* Number of entries in work[] */
+  pasSize_t errpc;                    /* Address of the first failure */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_InsnSize
+ ****************************************************************************/
+
+static inline pasSize_t libexec_InsnSize(uint8_t opcode)
+{
+  pasSize_t size = 1;
+
+  if ((opcode & o8) != 0)
+    {
+      size += 1;
+    }
+
+  if ((opcode & o16) != 0)
+    {
+      size += 2;
+    }
+
+  return size;
+}
+
+/****************************************************************************
+ * Name: libexec_LongStackEffect
+ *
+ * Description:
+ *   Return the change in stack depth, in words, caused by a LONGOP8
+ *   operation.
+ *
+ ****************************************************************************/
+
+static int32_t libexec_LongStackEffect(uint8_t longop)
+{
+  switch (longop)
+    {
+    case oDNOP  :
+    case oDNEG  :
+    case oDABS  :
+    case oDINC  :
+    case oDDEC  :
+    case oDNOT  :
+    case oDXCHG :
+      return 0;
+
+    case oDADD  :
+    case oDSUB  :
+    case oDMUL  :
+    case oDDIV  :
+    case oDMOD  :
+    case oDOR   :
+    case oDAND  :
+    case oDXOR  :
+    case oDUMUL :
+    case oDUDIV :
+    case oDUMOD :
+      return -2;
+
+    case oDSLL  :  /* 16-bit shift count */
+    case oDSRL  :
+    case oDSRA  :
+    case oDEQUZ :
+    case oDNEQZ :
+    case oDLTZ  :
+    case oDGTEZ :
+    case oDGTZ  :
+    case oDLTEZ :
+    case oDCNV  :
+      return -1;
+
+    case oDEQU  :
+    case oDNEQ  :
+    case oDLT   :
+    case oDGTE  :
+    case oDGT   :
+    case oDLTE  :
+    case oDULT  :
+    case oDUGTE :
+    case oDUGT  :
+    case oDULTE :
+      return -3;
+
+    case oCNVD  :
+    case oUCNVD :
+      return 1;
+
+    case oDDUP  :
+      return 2;
+
+    default:
+      return SE_ILLEGAL;
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_StackEffect
+ *
+ * Description:
+ *   Return the change in stack depth, in words, caused by the instruction
+ *   at 'pc'.  'tosConst' is the constant at the top of the stack before the
+ *   instruction, if it is known.  Returns SE_ILLEGAL if the instruction can
+ *   never execute, or SE_UNKNOWN if its effect depends on run-time data.
+ *
+ *   The FLOAT, SETOP, OSOP, STRLIB, and SYSIO sub-functions each take a
+ *   varying number of arguments.  Their effect is not tracked and their
+ *   sub-function codes are checked when they execute.
+ *
+ ****************************************************************************/
+
+static int32_t libexec_StackEffect(const uint8_t *ispace, pasSize_t pc,
+                                   int32_t tosConst)
+{
+  uint8_t  opcode = ispace[pc];
+  int32_t  words  = ROUNDBTOI(tosConst);
+  uint16_t imm16;
+
+  switch (opcode)
+    {
+      /* No stack arguments */
+
+    case oNOP    :
+    case oNEG    :
+    case oABS    :
+    case oINC    :
+    case oDEC    :
+    case oNOT    :
+    case oEQUZ   :
+    case oNEQZ   :
+    case oLTZ    :
+    case oGTEZ   :
+    case oGTZ    :
+    case oLTEZ   :
+    case oLDI    :
+    case oLDIB   :
+    case oULDIB  :
+    case oXCHG   :
+    case oJMP    :
+    case oLDX    :
+    case oLDXB   :
+    case oULDXB  :
+    case oLAX    :
+    case oINCS   :
+    case oLDSX   :
+    case oLDSXB  :
+    case oULDSXB :
+    case oLASX   :
+    case oPCAL   :  /* The frame is removed by oRET */
+    case oRET    :
+    case oEND    :
+      return 0;
+
+      /* Net effect of one word pushed */
+
+    case oDUP    :
+    case oPUSHB  :
+    case oUPUSHB :
+    case oPUSH   :
+    case oLD     :
+    case oLDB    :
+    case oULDB   :
+    case oLA     :
+    case oLAC    :
+    case oLAR    :
+    case oLDS    :
+    case oLDSB   :
+    case oULDSB  :
+    case oLAS    :
+      return 1;
+
+      /* Net effect of one word popped */
+
+    case oADD    :
+    case oSUB    :
+    case oMUL    :
+    case oDIV    :
+    case oMOD    :
+    case oSLL    :
+    case oSRL    :
+    case oSRA    :
+    case oOR     :
+    case oAND    :
+    case oXOR    :
+    case oUMUL   :
+    case oUDIV   :
+    case oUMOD   :
+    case oEQU    :
+    case oNEQ    :
+    case oLT     :
+    case oGTE    :
+    case oGT     :
+    case oLTE    :
+    case oULT    :
+    case oUGTE   :
+    case oUGT    :
+    case oULTE   :
+    case oJEQUZ  :
+    case oJNEQZ  :
+    case oJLTZ   :
+    case oJGTEZ  :
+    case oJGTZ   :
+    case oJLTEZ  :
+    case oST     :
+    case oSTB    :
+    case oSTS    :
+    case oSTSB   :
+    case oSETIN  :
+      return -1;
+
+      /* Net effect of two words popped */
+
+    case oSTI    :
+    case oSTIB   :
+    case oJEQU   :
+    case oJNEQ   :
+    case oJLT    :
+    case oJGTE   :
+    case oJGT    :
+    case oJLTE   :
+    case oJULT   :
+    case oJUGTE  :
+    case oJUGT   :
+    case oJULTE  :
+    case oSTX    :
+    case oSTXB   :
+    case oSTSX   :
+    case oSTSXB  :
+    case oSETINCL :
+    case oSETEXCL :
+      return -2;
+
+      /* Multiple word loads and stores.  The size in bytes is at the top
+       * of the stack.
+       */
+
+    case oLDM    :
+    case oLDSM   :
+      return tosConst == NO_CONST ? SE_UNKNOWN : words - 1;
+
+    case oLDIM   :
+    case oLDXM   :
+    case oLDSXM  :
+      return tosConst == NO_CONST ? SE_UNKNOWN : words - 2;
+
+    case oSTM    :
+    case oSTSM   :
+      return tosConst == NO_CONST ? SE_UNKNOWN : -words - 1;
+
+    case oSTIM   :
+    case oSTXM   :
+    case oSTSXM  :
+      return tosConst == NO_CONST ? SE_UNKNOWN : -words - 2;
+
+      /* imm16 = signed byte count */
+
+    case oINDS   :
+      imm16 = (uint16_t)ispace[pc + 1] << 8 | ispace[pc + 2];
+      if ((imm16 & 1) != 0)
+        {
+          return SE_UNKNOWN;
+        }
+
+      return signExtend16(imm16) / BPERI;
+
+      /* imm8 = long integer sub-function */
+
+    case oLONGOP8 :
+      return libexec_LongStackEffect(ispace[pc + 1]);
+
+      /* Run-time library calls */
+
+    case oFLOAT  :
+    case oSETOP  :
+    case oOSOP   :
+    case oSTRLIB :
+    case oSYSIO  :
+      return SE_UNKNOWN;
+
+      /* oLONGOP24 is encoded with the o16 bit clear and so cannot carry the
+       * label that the long branches require.  oLABEL and oLINE are pseudo-
+       * operations that must not appear in an executable.
+       */
+
+    case oLONGOP24 :
+    case oLABEL  :
+    case oLINE   :
+    default:
+      return SE_ILLEGAL;
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_IsBranch
+ *
+ * Description:
+ *   Return true if the 16-bit immediate data of this opcode is an I-Space
+ *   label.
+ *
+ ****************************************************************************/
+
+static bool libexec_IsBranch(uint8_t opcode)
+{
+  switch (opcode)
+    {
+    case oJEQUZ :
+    case oJNEQZ :
+    case oJLTZ  :
+    case oJGTEZ :
+    case oJGTZ  :
+    case oJLTEZ :
+    case oJMP   :
+    case oJEQU  :
+    case oJNEQ  :
+    case oJLT   :
+    case oJGTE  :
+    case oJGT   :
+    case oJLTE  :
+    case oJULT  :
+    case oJUGTE :
+    case oJUGT  :
+    case oJULTE :
+    case oPCAL  :
+      return true;
+
+    default:
+      return false;
+    }
+}
+
+/****************************************************************************
+ * Name: libexec_Target
+ *
+ * Description:
+ *   Return the label of a branch or call instruction.
+ *
+ ****************************************************************************/
+
+static inline pasSize_t libexec_Target(const uint8_t *ispace, pasSize_t pc)
+{
+  pasSize_t offset = (ispace[pc] & o8) != 0 ? 2 : 1;
+  return (pasSize_t)ispace[pc + offset] << 8 | ispace[pc + offset + 1];
+}
+
+/****************************************************************************
+ * Name: libexec_Merge
+ *
+ * Description:
+ *   Merge the state on one path into the state of the instruction at 'pc'
+ *   and queue the instruction if what is known about it changed.  A depth
+ *   that is known on one path is taken as the depth on all paths; two
+ *   known depths that disagree are an error.
+ *
+ ****************************************************************************/
+
+static int libexec_Merge(struct libexec_verify_s *vfy, pasSize_t pc,
+                         int32_t depth, uint8_t level, int32_t tosConst)
+{
+  struct libexec_vstate_s *state = &vfy->state[pc];
+  bool changed = false;
+
+  if ((state->flags & VF_VISITED) == 0)
+    {
+      state->depth    = depth;
+      state->level    = level;
+      state->tosConst = tosConst;
+      state->flags   |= VF_VISITED;
+      changed         = true;
+    }
+  else
+    {
+      if (state->level != level)
+        {
+          return eNESTINGLEVEL;
+        }
+
+      if (depth != DEPTH_UNKNOWN)
+        {
+          if (state->depth == DEPTH_UNKNOWN)
+            {
+              state->depth = depth;
+              changed      = true;
+            }
+          else if (state->depth != depth)
+            {
+              return eBADSP;
+            }
+        }
+
+      if (state->tosConst != tosConst && state->tosConst != NO_CONST)
+        {
+          state->tosConst = NO_CONST;
+          changed         = true;
+        }
+    }
+
+  if (changed && (state->flags & VF_QUEUED) == 0)
+    {
+      state->flags |= VF_QUEUED;
+      vfy->work[vfy->nwork++] = pc;
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_CheckCode
+ *
+ * Description:
+ *   Mark the start of each instruction and check that every instruction
+ *   is legal and lies entirely within I-Space.
+ *
+ ****************************************************************************/
+
+static int libexec_CheckCode(struct libexec_verify_s *vfy)
+{
+  pasSize_t pc;
+  pasSize_t size;
+
+  for (pc = 0; pc < vfy->maxpc; pc += size)
+    {
+      vfy->errpc = pc;
+      size       = libexec_InsnSize(vfy->ispace[pc]);
+
+      if (pc + size > vfy->maxpc)
+        {
+          return eBADPC;
+        }
+
+      vfy->state[pc].flags = VF_INSN;
+
+      if (libexec_StackEffect(vfy->ispace, pc, NO_CONST) == SE_ILLEGAL)
+        {
+          return eILLEGALOPCODE;
+        }
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_CheckLabels
+ *
+ * Description:
+ *   Check that every branch and call target is the start of an instruction
+ *   and queue each called procedure, and the program entry point, for the
+ *   flow analysis.  A procedure is entered with an empty stack at the
+ *   nesting level given in the call; every call to it must agree.
+ *
+ ****************************************************************************/
+
+static int libexec_CheckLabels(struct libexec_verify_s *vfy, pasSize_t entry)
+{
+  const uint8_t *ispace = vfy->ispace;
+  pasSize_t pc;
+  pasSize_t target;
+  int ret;
+
+  vfy->errpc = entry;
+  if (entry >= vfy->maxpc || (vfy->state[entry].flags & VF_INSN) == 0)
+    {
+      return eBADPC;
+    }
+
+  ret = libexec_Merge(vfy, entry, 0, 0, NO_CONST);
+  if (ret != eNOERROR)
+    {
+      return ret;
+    }
+
+  for (pc = 0; pc < vfy->maxpc; pc += libexec_InsnSize(ispace[pc]))
+    {
+      if (!libexec_IsBranch(ispace[pc]))
+        {
+          continue;
+        }
+
+      vfy->errpc = pc;
+      target     = libexec_Target(ispace, pc);
+
+      if (target >= vfy->maxpc || (vfy->state[target].flags & VF_INSN) == 0)
+        {
+          return eBADPC;
+        }
+
+      if (ispace[pc] == oPCAL)
+        {
+          if (ispace[pc + 1] == 0)
+            {
+              return eNESTINGLEVEL;
+            }
+
+          ret = libexec_Merge(vfy, target, 0, ispace[pc + 1], NO_CONST);
+          if (ret != eNOERROR)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Name: libexec_CheckFlow
+ *
+ * Description:
+ *   Follow every path from each procedure entry, computing the stack depth
+ *   and nesting level at each instruction.  The depth must agree where
+ *   paths merge, must not fall below the depth on entry, and must return
+ *   to it at oRET.  A call may be made only to a procedure at most one
+ *   level deeper than the caller.  No path may run off the end of I-Space.
+ *
+ ****************************************************************************/
+
+static int libexec_CheckFlow(struct libexec_verify_s *vfy)
+{
+  const uint8_t *ispace = vfy->ispace;
+  struct libexec_vstate_s *state;
+  pasSize_t pc;
+  pasSize_t next;
+  int32_t effect;
+  int32_t depth;
+  int32_t tosConst;
+  uint8_t opcode;
+  int ret;
+
+  while (vfy->nwork > 0)
+    {
+      pc          = vfy->work[--vfy->nwork];
+      state       = &vfy->state[pc];
+      state->flags &= ~VF_QUEUED;
+
+      vfy->errpc  = pc;
+      opcode      = ispace[pc];
+      next        = pc + libexec_InsnSize(opcode);
+      effect      = libexec_StackEffect(ispace, pc, state->tosConst);
+      depth       = state->depth;
+
+      if (depth != DEPTH_UNKNOWN)
+        {
+          if (effect == SE_UNKNOWN)
+            {
+              depth = DEPTH_UNKNOWN;
+            }
+          else
+            {
+              depth += effect;
+              if (depth < 0 || depth > INT16_MAX)
+                {
+                  return eBADSP;
+                }
+            }
+        }
+
+      /* Only the immediate data of a push is a known constant */
+
+      switch (opcode)
+        {
+        case oPUSHB  :
+          tosConst = (uint16_t)signExtend8(ispace[pc + 1]);
+          break;
+
+        case oUPUSHB :
+          tosConst = ispace[pc + 1];
+          break;
+
+        case oPUSH   :
+          tosConst = (int32_t)ispace[pc + 1] << 8 | ispace[pc + 2];
+          break;
+
+        default:
+          tosConst = NO_CONST;
+          break;
+        }
+
+      /* Successors */
+
+      switch (opcode)
+        {
+        case oEND :
+          continue;
+
+        case oRET :
+          if (depth != 0 && depth != DEPTH_UNKNOWN)
+            {
+              return eBADSP;
+            }
+
+          continue;
+
+        case oPCAL :
+          if (ispace[pc + 1] > state->level + 1)
+            {
+              return eNESTINGLEVEL;
+            }
+          break;
+
+        case oJMP :
+          ret = libexec_Merge(vfy, libexec_Target(ispace, pc), depth,
+                              state->level, tosConst);
+          if (ret != eNOERROR)
+            {
+              return ret;
+            }
+
+          continue;
+
+        default:
+          if (libexec_IsBranch(opcode))
+            {
+              ret = libexec_Merge(vfy, libexec_Target(ispace, pc), depth,
+                                  state->level, tosConst);
+              if (ret != eNOERROR)
+                {
+                  return ret;
+                }
+            }
+          break;
+        }
+
+      if (next >= vfy->maxpc)
+        {
+          return eBADPC;
+        }
+
+      ret = libexec_Merge(vfy, next, depth, state->level, tosConst);
+      if (ret != eNOERROR)
+        {
+          return ret;
+        }
+    }
+
+  return eNOERROR;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: libexec_Verify
+ *
+ * Description:
+ *   Verify the I-Space of a program image once, when it is loaded.  A
+ *   verified program can branch or call only to the start of an
+ *   instruction within I-Space and can execute only legal instructions.
+ *   Where they can be computed, the stack depths and nesting levels are
+ *   also checked.
+ *
+ *   The return address popped by oRET is the only program counter value
+ *   that is not verified, so a verified program may be executed without
+ *   checking the program counter of each instruction.
+ *
+ *   The result is recorded in the image.
+ *
+ * Returned Value:
+ *   eNOERROR if the program was verified, otherwise the reason that it was
+ *   not.  eNOMEMORY is returned if there is not enough memory to verify
+ *   the program.
+ *
+ ****************************************************************************/
+
+int libexec_Verify(struct libexec_image_s *image)
+{
+  struct libexec_verify_s vfy;
+  int ret;
+
+  vfy.ispace = image->ispace;
+  vfy.maxpc  = image->maxpc;
+  vfy.nwork  = 0;
+  vfy.errpc  = 0;
+  vfy.state  = (struct libexec_vstate_s *)
+    calloc(vfy.maxpc + 1, sizeof(struct libexec_vstate_s));
+  vfy.work   = (uint16_t *)malloc((vfy.maxpc + 1) * sizeof(uint16_t));
+
+  if (vfy.state == NULL || vfy.work == NULL)
+    {
+      ret = eNOMEMORY;
+    }
+  else
+    {
+      ret = libexec_CheckCode(&vfy);
+      if (ret == eNOERROR)
+        {
+          ret = libexec_CheckLabels(&vfy, image->entry);
+        }
+
+      if (ret == eNOERROR)
+        {
+          ret = libexec_CheckFlow(&vfy);
+        }
+    }
+
+  free(vfy.state);
+  free(vfy.work);
+
+  image->verified    = (ret == eNOERROR);
+  image->verifyError = ret;
+  image->verifyPC    = ret == eNOERROR ? 0 : vfy.errpc;
+  return ret;
+}
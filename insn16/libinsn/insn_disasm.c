@@ -43,6 +43,7 @@
 #include <inttypes.h>
 
 #include "pas_debug.h"
+#include "pas_machine.h"
 #include "pas_pcode.h"
 #include "insn16.h"
 #include "pas_fpops.h"
@@ -258,10 +259,13 @@ static const struct
 /* 0x73 */ { "OSOP",    MKFMT(osOP,   NOARG16) },
 /* 0x74 */ { "PUSHB",   MKFMT(SHORTINT, NOARG16) },
 /* 0x75 */ { "UPUSHB",  MKFMT(SHORTWORD, NOARG16) },
-/* 0x76 */ { invOp,     MKFMT(NOARG8, NOARG16) },
-/* 0x77 */ { invOp,     MKFMT(NOARG8, NOARG16) },
 
-/* 0x78 */ { invOp,     MKFMT(NOARG8, NOARG16) },
+/* Set bit operations:  arg8 = set size in bytes */
+
+/* 0x76 */ { "SETIN",   MKFMT(SHORTWORD, NOARG16) },
+/* 0x77 */ { "SETINCL", MKFMT(SHORTWORD, NOARG16) },
+
+/* 0x78 */ { "SETEXCL", MKFMT(SHORTWORD, NOARG16) },
 /* 0x79 */ { invOp,     MKFMT(NOARG8, NOARG16) },
 /* 0x7a */ { invOp,     MKFMT(NOARG8, NOARG16) },
 /* 0x7b */ { invOp,     MKFMT(NOARG8, NOARG16) },
@@ -480,7 +484,8 @@ static const char * const xName[MAX_XOP] =
 /* 0x1c */ "WRITEWORD", "WRITELONG",  "WRITEULONG", "WRITECHR",
 /* 0x20 */ "WRITESTR",  "WRITERL",    "FLUSH",      "CHDIR",
 /* 0x24 */ "GETDIR",    "MKDIR",      "RMDIR",      "OPENDIR",
-/* 0x28 */ "READDIR",   "FILEINFO",   "REWINDDIR",  "CLOSEDIR"
+/* 0x28 */ "READDIR",   "FILEINFO",   "REWINDDIR",  "CLOSEDIR",
+/* 0x2c */ "BLOCKREAD", "BLOCKWRITE"
 };
 
 static const char invSetOp[] = "Invalid SETOP";
@@ -508,7 +513,8 @@ static const char * const lbName[MAX_LBOP] =
 /* 0x0c */ "STRCATC",    "STRCMP",    "STRLEN",     "COPYSUBSTR",
 /* 0x10 */ "FINDSUBSTR", "INSERTSTR", "DELSUBSTR",  "FILLCHAR ",
 /* 0x14 */ "CHARAT",     "INTSTR",    "WORDSTR",    "LONGSTR",
-/* 0x18 */ "ULONGSTR ",  "REALSTR",   "VAL"
+/* 0x18 */ "ULONGSTR ",  "REALSTR",   "VAL",        "STRCATN",
+/* 0x1c */ "VALREAL"
 };
 
 static const char invFpOp[] = "Invalid FP Operation";
@@ -525,6 +531,13 @@ static const char * const fpName[MAX_FOP] =
 
 /***********************************************************************/
 
+const char *insn_GetOpCodeName(uint8_t opcode)
+{
+  return opTable[opcode].opName;
+}
+
+/***********************************************************************/
+
 void insn_DisassemblePCode(FILE* lfile, opType_t *pop)
 {
   uint8_t fmt8;
@@ -604,9 +617,16 @@ void insn_DisassemblePCode(FILE* lfile, opType_t *pop)
                 break;
 
               case setOP :       /* Show ARG8 as encoded SET operation */
-                if (pop->arg1 < MAX_SETOP)
+                if (SETOP_OPCODE(pop->arg1) < MAX_SETOP)
                   {
-                    fprintf(lfile, "%s", sName[pop->arg1]);
+                    fprintf(lfile, "%s", sName[SETOP_OPCODE(pop->arg1)]);
+
+                    /* Show the set size if it is not the smallest */
+
+                    if ((pop->arg1 & SETOP_SIZE_MASK) != 0)
+                      {
+                        fprintf(lfile, " (%d)", SETOP_SETSIZE(pop->arg1));
+                      }
                   }
                 else
                   {
@@ -119,6 +119,9 @@ static const uint16_t g_opCodeMap[NUM_OPCODES] =
   oFLOAT,   /* opFLOAT */
   oSETOP,   /* opSETOP */
   oOSOP,    /* opOSOP */
+  oSETIN,   /* opSETIN */
+  oSETINCL, /* opSETINCL */
+  oSETEXCL, /* opSETEXCL */
   oJEQUZ,   /* opJEQUZ */
   oJNEQZ,   /* opJNEQZ */
   oJMP,     /* opJMP */
@@ -275,6 +278,23 @@ void insn_GenerateSetOperation(uint8_t setOpcode)
   insn16_Generate(opSETOP, setOpcode, 0);
 }
 
+/***********************************************************************/
+/* Replace the sub-function of the SETOP instruction that begins at
+ * progOffset.  The listing file still shows the original sub-function.
+ */
+
+void insn_PatchSetOperation(uint32_t progOffset, uint8_t setOpcode)
+{
+  poffSetProgByte(g_poffHandle, progOffset + 1, setOpcode);
+}
+
+/***********************************************************************/
+
+void insn_GenerateSetBitOperation(enum pcode_e opcode, uint8_t setSize)
+{
+  insn16_Generate(opcode, setSize, 0);
+}
+
 /***********************************************************************/
 
 void insn_GenerateIoOperation(uint16_t ioOpcode)
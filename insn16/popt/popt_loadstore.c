@@ -44,6 +44,7 @@
 
 #include "pas_debug.h"
 #include "pas_machine.h"
+#include "pas_setops.h"
 #include "insn16.h"
 
 #include "paslib.h"
@@ -51,6 +52,71 @@
 #include "popt_peephole.h"
 #include "popt_local.h"
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************/
+/* Return the value pushed by the constant PUSH at this peephole index */
+
+static int16_t popt_GetPushValue(int16_t index)
+{
+  if (g_opPtr[index]->op == oPUSHB)
+    {
+      return signExtend8(g_opPtr[index]->arg1);
+    }
+  else if (g_opPtr[index]->op == oUPUSHB)
+    {
+      return g_opPtr[index]->arg1;
+    }
+  else /* if (g_opPtr[index]->op == oPUSH) */
+    {
+      return (int16_t)g_opPtr[index]->arg2;
+    }
+}
+
+/****************************************************************************/
+/* Check if the opcode at this peephole index is the SETOP sub-function
+ * 'setOpcode' on sets of 'setSize' bytes.
+ */
+
+static bool popt_CheckSetOperation(int16_t index, uint8_t setOpcode,
+                                   int16_t setSize)
+{
+  return (g_opPtr[index]->op == oSETOP &&
+          SETOP_OPCODE(g_opPtr[index]->arg1) == setOpcode &&
+          SETOP_SETSIZE(g_opPtr[index]->arg1) == setSize);
+}
+
+/****************************************************************************/
+/* Return the number of pcodes in the simple set member expression that
+ * begins at this peephole index, or zero if there is none.  The member is
+ * a single load, possibly followed by INC, DEC, or the ADD or SUB of a
+ * constant (the bias that makes the member zero-based).
+ */
+
+static int16_t popt_SetMemberLength(int16_t index)
+{
+  if (index >= g_nOpPtrs || !popt_CheckLoadOperation(index))
+    {
+      return 0;
+    }
+
+  if (index + 1 < g_nOpPtrs &&
+      (g_opPtr[index + 1]->op == oINC || g_opPtr[index + 1]->op == oDEC))
+    {
+      return 2;
+    }
+
+  if (index + 2 < g_nOpPtrs && popt_CheckPushConstant(index + 1) &&
+      (g_opPtr[index + 2]->op == oADD || g_opPtr[index + 2]->op == oSUB))
+    {
+      return 3;
+    }
+
+  return 1;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -421,3 +487,137 @@ int16_t popt_StoreOptimize (void)
 
   return nchanges;
 }
+
+/****************************************************************************/
+/* Replace set operations on a set variable that copy the whole set onto the
+ * stack with the set bit operations that address the variable in place.
+ */
+
+int16_t popt_SetOptimize(void)
+{
+  opTypeR_t setLoad;
+  opTypeR_t minPush;
+  int16_t   nchanges = 0;
+  int16_t   setSize;
+  int16_t   nMember;
+  uint8_t   addrOp;
+  uint8_t   storeOp;
+  register int16_t i;
+  int16_t   j;
+
+  /* At least four pcodes are needed to perform the following set
+   * optimizations.
+   */
+
+  i = 0;
+  while (i < g_nOpPtrs - 3)
+    {
+      /* Each pattern begins with the value of a global or local set
+       * variable pushed onto the stack:  [PUSH size] [LDM/LDSM]
+       */
+
+      if (!popt_CheckPushConstant(i) ||
+          (g_opPtr[i + 1]->op != oLDM && g_opPtr[i + 1]->op != oLDSM))
+        {
+          i++;
+          continue;
+        }
+
+      setSize = popt_GetPushValue(i);
+      setLoad = *g_opPtr[i + 1];
+
+      if (setLoad.op == oLDM)
+        {
+          addrOp  = oLA;
+          storeOp = oSTM;
+        }
+      else
+        {
+          addrOp  = oLAS;
+          storeOp = oSTSM;
+        }
+
+      /* Member test.  The member has already been pushed:
+       *
+       *   [PUSH size] [LDM s] [PUSH min] [SETOP MEMBER]
+       *
+       * becomes
+       *
+       *   [PUSH min] [SUB] [LA s] [SETIN size]
+       *
+       * or just [LA s] [SETIN size] if the minimum member value is zero.
+       */
+
+      if (popt_CheckPushConstant(i + 2) &&
+          popt_CheckSetOperation(i + 3, setMEMBER, setSize))
+        {
+          if (popt_GetPushValue(i + 2) == 0)
+            {
+              g_opPtr[i + 1]->op   = addrOp;
+              g_opPtr[i + 3]->op   = oSETIN;
+              g_opPtr[i + 3]->arg1 = setSize;
+              g_opPtr[i + 3]->arg2 = 0;
+              popt_DeletePCodePair(i, i + 2);
+            }
+          else
+            {
+              minPush = *g_opPtr[i + 2];
+
+              g_opPtr[i]->op       = minPush.op;
+              g_opPtr[i]->arg1     = minPush.arg1;
+              g_opPtr[i]->arg2     = minPush.arg2;
+              g_opPtr[i + 1]->op   = oSUB;
+              g_opPtr[i + 1]->arg1 = 0;
+              g_opPtr[i + 1]->arg2 = 0;
+              g_opPtr[i + 2]->op   = addrOp;
+              g_opPtr[i + 2]->arg1 = setLoad.arg1;
+              g_opPtr[i + 2]->arg2 = setLoad.arg2;
+              g_opPtr[i + 3]->op   = oSETIN;
+              g_opPtr[i + 3]->arg1 = setSize;
+              g_opPtr[i + 3]->arg2 = 0;
+            }
+
+          nchanges++;
+          i++;
+          continue;
+        }
+
+      /* Include or exclude a member, storing the result back into the same
+       * set variable:
+       *
+       *   [PUSH size] [LDM s] <member> [SETOP INCLUDE] [PUSH size] [STM s]
+       *
+       * becomes
+       *
+       *   [LA s] <member> [SETINCL size]
+       */
+
+      nMember = popt_SetMemberLength(i + 2);
+      j       = i + 2 + nMember;
+
+      if (nMember > 0 && j + 2 < g_nOpPtrs &&
+          (popt_CheckSetOperation(j, setINCLUDE, setSize) ||
+           popt_CheckSetOperation(j, setEXCLUDE, setSize)) &&
+          popt_CheckPushConstant(j + 1) &&
+          popt_GetPushValue(j + 1) == setSize &&
+          g_opPtr[j + 2]->op   == storeOp &&
+          g_opPtr[j + 2]->arg1 == setLoad.arg1 &&
+          g_opPtr[j + 2]->arg2 == setLoad.arg2)
+        {
+          g_opPtr[i + 1]->op = addrOp;
+          g_opPtr[j]->op     =
+            SETOP_OPCODE(g_opPtr[j]->arg1) == setINCLUDE ?
+            oSETINCL : oSETEXCL;
+          g_opPtr[j]->arg1   = setSize;
+          g_opPtr[j]->arg2   = 0;
+          popt_DeletePCodeTrio(i, j + 1, j + 2);
+          nchanges++;
+        }
+      else
+        {
+          i++;
+        }
+    }
+
+  return nchanges;
+}
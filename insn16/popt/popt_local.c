@@ -116,6 +116,7 @@ void popt_LocalOptimization(poffHandle_t poffHandle)
           nchanges += popt_StackOrderOptimize();
           nchanges += popt_LoadOptimize();
           nchanges += popt_StoreOptimize();
+          nchanges += popt_SetOptimize();
         }
       while (nchanges > 0);
 
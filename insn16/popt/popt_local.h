@@ -64,5 +64,6 @@ int16_t popt_BranchOptimize     (void);
 int16_t popt_StackOrderOptimize (void);
 int16_t popt_LoadOptimize       (void);
 int16_t popt_StoreOptimize      (void);
+int16_t popt_SetOptimize        (void);
 
 #endif /* __POPT_LOCAL_H */
@@ -39,9 +39,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
 
 #include "paslib.h"
+#include "pas_errcodes.h"
 #include "execlib.h"
 
 /****************************************************************************
@@ -53,6 +59,8 @@
 #define DEFAULT_STKSTR_SIZE     0
 #define DEFAULT_HPSTK_SIZE      0
 #define MAX_HEAP_SIZE       32768
+#define MAX_JOBS               64
+#define DEFAULT_SAMPLE_INTERVAL 1000
 
 /****************************************************************************
  * Private Types
@@ -61,16 +69,53 @@
 struct prunArgs_s
 {
   const char *poffFileName;  /* Input POFF file name */
+  char      **poffFileNames; /* Input POFF file names (--jobs only) */
+  int         nPoffFiles;    /* Number of names in poffFileNames[] */
+  int         jobs;          /* > 0:  Number of worker threads */
+  bool        stats;         /* true:  Show execution statistics */
+  bool        verify;        /* true:  Run only verified programs */
+  bool        mapFiles;      /* true:  Memory map typed files */
   int32_t     strStackSize;  /* String stack size to allocate */
   int32_t     pasStackSize;  /* Pascal run-time stack to allocate */
   int32_t     hpStackSize;   /* Heap memory to allocate */
 #ifdef CONFIG_PASCAL_DEBUGGER
   int         debugger;      /* > 0:  Run the debug monitor */
 #endif
+#ifdef CONFIG_PASCAL_PROFILER
+  const char *profileName;   /* != NULL:  Write an execution profile here */
+  const char *sampleName;    /* != NULL:  Write call stack samples here */
+  uint32_t    sampleInterval; /* Instructions between call stack samples */
+  const char *heapProfileName; /* != NULL:  Write a heap profile here */
+#endif
 };
 
 typedef struct prunArgs_s prunArgs_t;
 
+/* One program of a --jobs batch */
+
+struct prunJob_s
+{
+  char  fileName[FNAME_SIZE + 1];  /* Object file name */
+  EXEC_IMAGE_t image;              /* The loaded program */
+  FILE *output;                    /* Holds the output of the program */
+  bool  loaded;                    /* true:  The program was loaded */
+};
+
+typedef struct prunJob_s prunJob_t;
+
+/* State shared by the worker threads of a --jobs batch */
+
+struct prunPool_s
+{
+  pthread_mutex_t lock;      /* Protects next */
+  int             next;      /* Index of the next job to run */
+  int             njobs;     /* Number of jobs in the batch */
+  prunJob_t      *job;       /* The batch */
+  prunArgs_t     *args;      /* Memory sizes used by every job */
+};
+
+typedef struct prunPool_s prunPool_t;
+
 /****************************************************************************
  * Private Constant Data
  ****************************************************************************/
@@ -81,8 +126,18 @@ static const struct option long_options[] =
   {"stack",  1, NULL, 's'},
   {"string", 1, NULL, 't'},
   {"new",    1, NULL, 'n'},
+  {"jobs",   1, NULL, 'j'},
+  {"stats",  0, NULL, 'x'},
+  {"verify", 0, NULL, 'V'},
+  {"map-files", 0, NULL, 'm'},
 #ifdef CONFIG_PASCAL_DEBUGGER
   {"debug",  0, NULL, 'd'},
+#endif
+#ifdef CONFIG_PASCAL_PROFILER
+  {"profile", 1, NULL, 'p'},
+  {"sample", 1, NULL, 'S'},
+  {"interval", 1, NULL, 'i'},
+  {"heap-profile", 1, NULL, 'H'},
 #endif
   {"help",   0, NULL, 'h'},
   {NULL,     0, NULL, 0}
@@ -101,6 +156,8 @@ static void prun_showusage(const char *progname)
   fprintf(stderr, "USAGE:\n");
   fprintf(stderr, "  %s [OPTIONS] <program-filename>\n",
           progname);
+  fprintf(stderr, "  %s [OPTIONS] --jobs <n> <program-filename> ...\n",
+          progname);
   fprintf(stderr, "OPTIONS:\n");
   fprintf(stderr, "  -a <string-buffer-size>\n");
   fprintf(stderr, "  --alloc <string-buffer-size>\n");
@@ -122,10 +179,52 @@ static void prun_showusage(const char *progname)
   fprintf(stderr, "    heap use for new() and temporary strings (default is\n");
   fprintf(stderr, "    %d bytes, maximum is %d)\n",
           DEFAULT_HPSTK_SIZE, MAX_HEAP_SIZE);
+  fprintf(stderr, "  -j <n>\n");
+  fprintf(stderr, "  --jobs <n>\n");
+  fprintf(stderr, "    Run all of the programs on the command line using <n>\n");
+  fprintf(stderr, "    worker threads (maximum is %d).  Each program reads\n",
+          MAX_JOBS);
+  fprintf(stderr, "    an empty INPUT.  The output of each program is shown\n");
+  fprintf(stderr, "    when it completes, in command line order.\n");
+  fprintf(stderr, "  -x\n");
+  fprintf(stderr, "  --stats\n");
+  fprintf(stderr, "    When the program terminates, show the number of PCode\n");
+  fprintf(stderr, "    instructions executed, the run time, the instruction\n");
+  fprintf(stderr, "    rate, and the peak memory use on stderr\n");
+  fprintf(stderr, "  -V\n");
+  fprintf(stderr, "  --verify\n");
+  fprintf(stderr, "    Run the program only if it passed verification when\n");
+  fprintf(stderr, "    it was loaded.  Otherwise, show why it failed.\n");
+  fprintf(stderr, "  -m\n");
+  fprintf(stderr, "  --map-files\n");
+  fprintf(stderr, "    Memory map typed files (FILE OF) when they are opened\n");
+  fprintf(stderr, "    so that SEEK, READ and WRITE need no system calls\n");
 #ifdef CONFIG_PASCAL_DEBUGGER
   fprintf(stderr, "  -d\n");
   fprintf(stderr, "  --debug\n");
   fprintf(stderr, "    Enable PCode program debugger\n");
+#endif
+#ifdef CONFIG_PASCAL_PROFILER
+  fprintf(stderr, "  -p <report-file>\n");
+  fprintf(stderr, "  --profile <report-file>\n");
+  fprintf(stderr, "    Count the executions of each PCode instruction and\n");
+  fprintf(stderr, "    write a report by opcode, procedure, and source line\n");
+  fprintf(stderr, "    to <report-file> when the program terminates\n");
+  fprintf(stderr, "  -S <stack-file>\n");
+  fprintf(stderr, "  --sample <stack-file>\n");
+  fprintf(stderr, "    Sample the Pascal call stack periodically and write\n");
+  fprintf(stderr, "    the samples to <stack-file> in collapsed stack\n");
+  fprintf(stderr, "    format (for flame graphs) when the program terminates\n");
+  fprintf(stderr, "  -i <n>\n");
+  fprintf(stderr, "  --interval <n>\n");
+  fprintf(stderr, "    Take a call stack sample about every <n> PCode\n");
+  fprintf(stderr, "    instructions (default: %d)\n",
+          DEFAULT_SAMPLE_INTERVAL);
+  fprintf(stderr, "  -H <report-file>\n");
+  fprintf(stderr, "  --heap-profile <report-file>\n");
+  fprintf(stderr, "    Record heap allocations and write the peak heap use,\n");
+  fprintf(stderr, "    the allocations by source line, and the memory not\n");
+  fprintf(stderr, "    freed to <report-file> when the program terminates\n");
 #endif
   fprintf(stderr, "  -h\n");
   fprintf(stderr, "  --help\n");
@@ -145,13 +244,25 @@ static void prun_ParseArgs(int argc, char **argv, prunArgs_t *args)
 
   /* Set up default value */
 
-  args->poffFileName = NULL;
+  args->poffFileName  = NULL;
+  args->poffFileNames = NULL;
+  args->nPoffFiles    = 0;
+  args->jobs          = 0;
+  args->stats         = false;
+  args->verify        = false;
+  args->mapFiles      = false;
   args->strStackSize = DEFAULT_STKSTR_SIZE;
   args->pasStackSize = DEFAULT_STACK_SIZE;
   args->hpStackSize  = DEFAULT_HPSTK_SIZE;
 #ifdef CONFIG_PASCAL_DEBUGGER
   args->debugger     = 0;
 #endif
+#ifdef CONFIG_PASCAL_PROFILER
+  args->profileName  = NULL;
+  args->sampleName   = NULL;
+  args->sampleInterval = DEFAULT_SAMPLE_INTERVAL;
+  args->heapProfileName = NULL;
+#endif
 
   /* Check for existence of filename argument */
 
@@ -165,7 +276,7 @@ static void prun_ParseArgs(int argc, char **argv, prunArgs_t *args)
 
   do
     {
-      c = getopt_long(argc, argv, "a:t:s:n:dh",
+      c = getopt_long(argc, argv, "a:t:s:n:j:xVmdp:S:i:H:h",
                       long_options, &option_index);
       if (c != -1)
         {
@@ -204,10 +315,57 @@ static void prun_ParseArgs(int argc, char **argv, prunArgs_t *args)
               args->strStackSize = ((size + 3) & ~3);
               break;
 
+            case 'j' :
+              size = atoi(optarg);
+              if (size < 1 || size > MAX_JOBS)
+                {
+                  fprintf(stderr, "ERROR: Invalid number of jobs\n");
+                  prun_showusage(argv[0]);
+                }
+
+              args->jobs = size;
+              break;
+
+            case 'x' :
+              args->stats = true;
+              break;
+
+            case 'V' :
+              args->verify = true;
+              break;
+
+            case 'm' :
+              args->mapFiles = true;
+              break;
+
 #ifdef CONFIG_PASCAL_DEBUGGER
             case 'd' :
               args->debugger++;
               break;
+#endif
+#ifdef CONFIG_PASCAL_PROFILER
+            case 'p' :
+              args->profileName = optarg;
+              break;
+
+            case 'S' :
+              args->sampleName = optarg;
+              break;
+
+            case 'i' :
+              size = atoi(optarg);
+              if (size < 1)
+                {
+                  fprintf(stderr, "ERROR: Invalid sample interval\n");
+                  prun_showusage(argv[0]);
+                }
+
+              args->sampleInterval = size;
+              break;
+
+            case 'H' :
+              args->heapProfileName = optarg;
+              break;
 #endif
             case 'h' :
               prun_showusage(argv[0]);
@@ -223,6 +381,50 @@ static void prun_ParseArgs(int argc, char **argv, prunArgs_t *args)
     }
   while (c != -1);
 
+  if (args->jobs > 0)
+    {
+      if (optind >= argc)
+        {
+          fprintf(stderr, "ERROR: Filename required\n");
+          prun_showusage(argv[0]);
+        }
+
+#ifdef CONFIG_PASCAL_DEBUGGER
+      if (args->debugger)
+        {
+          fprintf(stderr, "ERROR: --debug cannot be used with --jobs\n");
+          prun_showusage(argv[0]);
+        }
+#endif
+
+#ifdef CONFIG_PASCAL_PROFILER
+      if (args->profileName != NULL)
+        {
+          fprintf(stderr, "ERROR: --profile cannot be used with --jobs\n");
+          prun_showusage(argv[0]);
+        }
+
+      if (args->sampleName != NULL)
+        {
+          fprintf(stderr, "ERROR: --sample cannot be used with --jobs\n");
+          prun_showusage(argv[0]);
+        }
+
+      if (args->heapProfileName != NULL)
+        {
+          fprintf(stderr,
+                  "ERROR: --heap-profile cannot be used with --jobs\n");
+          prun_showusage(argv[0]);
+        }
+#endif
+
+      /* Get the names of the p-code files from the remaining arguments */
+
+      args->poffFileNames = &argv[optind];
+      args->nPoffFiles    = argc - optind;
+      return;
+    }
+
   if (optind != argc-1)
     {
       fprintf(stderr, "ERROR: Only one filename permitted on command line\n");
@@ -234,6 +436,260 @@ static void prun_ParseArgs(int argc, char **argv, prunArgs_t *args)
   args->poffFileName = argv[argc - 1];
 }
 
+/****************************************************************************
+ * Name: prun_Verified
+ *
+ * Description:
+ *   Return true if the program was verified when it was loaded.  If not,
+ *   report the reason on 'stream'.
+ *
+ ****************************************************************************/
+
+static bool prun_Verified(EXEC_HANDLE_t handle, const char *fileName,
+                          FILE *stream)
+{
+  pasSize_t pc;
+  int errcode;
+
+  errcode = libexec_GetVerifyResult(handle, &pc);
+  if (errcode != eNOERROR)
+    {
+      fprintf(stream, "%s failed verification: error 0x%02x at PC 0x%04x\n",
+              fileName, errcode, pc);
+      return false;
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: prun_RunJob
+ *
+ * Description:
+ *   Run one program of a --jobs batch.  The program runs in its own
+ *   instance of the P-Machine with an empty INPUT; its OUTPUT is collected
+ *   in a temporary file.
+ *
+ ****************************************************************************/
+
+static void prun_RunJob(prunJob_t *job, prunArgs_t *args)
+{
+  EXEC_HANDLE_t handle;
+  FILE *input;
+
+  job->loaded = false;
+  job->output = tmpfile();
+  input       = tmpfile();
+
+  if (job->output == NULL || input == NULL)
+    {
+      goto errout;
+    }
+
+  if (job->image == NULL)
+    {
+      goto errout;
+    }
+
+  handle = libexec_Instantiate(job->image, args->strStackSize,
+                               args->pasStackSize, args->hpStackSize);
+  if (handle == NULL)
+    {
+      goto errout;
+    }
+
+  job->loaded = true;
+  fprintf(job->output, "%s Loaded\n", job->fileName);
+
+  if (!args->verify || prun_Verified(handle, job->fileName, job->output))
+    {
+      libexec_SetStdio(handle, input, job->output);
+      libexec_SetFileMapping(handle, args->mapFiles);
+      libexec_RunLoop(handle);
+    }
+
+  libexec_Release(handle);
+
+errout:
+  if (input != NULL)
+    {
+      fclose(input);
+    }
+}
+
+/****************************************************************************
+ * Name: prun_Worker
+ *
+ * Description:
+ *   Worker thread of a --jobs batch.  Takes jobs from the batch until none
+ *   are left.
+ *
+ ****************************************************************************/
+
+static void *prun_Worker(void *arg)
+{
+  prunPool_t *pool = (prunPool_t *)arg;
+  int index;
+
+  for (; ; )
+    {
+      pthread_mutex_lock(&pool->lock);
+      index = pool->next++;
+      pthread_mutex_unlock(&pool->lock);
+
+      if (index >= pool->njobs)
+        {
+          break;
+        }
+
+      prun_RunJob(&pool->job[index], pool->args);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: prun_RunJobs
+ *
+ * Description:
+ *   Run every program named on the command line on a pool of worker
+ *   threads, then show the output of each program in command line order.
+ *
+ * Returned Value:
+ *   The exit status of prun:  Zero if every program was loaded.
+ *
+ ****************************************************************************/
+
+static int prun_RunJobs(prunArgs_t *args)
+{
+  pthread_t thread[MAX_JOBS];
+  prunPool_t pool;
+  int nthreads;
+  int status = 0;
+  int i;
+
+  pool.job = (prunJob_t *)calloc(args->nPoffFiles, sizeof(prunJob_t));
+  if (pool.job == NULL)
+    {
+      fprintf(stderr, "ERROR: Out of memory\n");
+      return 1;
+    }
+
+  pthread_mutex_init(&pool.lock, NULL);
+  pool.next  = 0;
+  pool.njobs = args->nPoffFiles;
+  pool.args  = args;
+
+  /* Load the programs.  Use .o or command line extension, if supplied.
+   * Programs that appear more than once in the batch share one image.
+   */
+
+  for (i = 0; i < pool.njobs; i++)
+    {
+      (void)extension(args->poffFileNames[i], "o", pool.job[i].fileName,
+                      FNAME_SIZE + 1, 0);
+      pool.job[i].image = libexec_LoadImage(pool.job[i].fileName);
+    }
+
+  /* Start the workers.  There is no point in having more workers than
+   * programs.
+   */
+
+  nthreads = args->jobs < pool.njobs ? args->jobs : pool.njobs;
+  for (i = 0; i < nthreads; i++)
+    {
+      if (pthread_create(&thread[i], NULL, prun_Worker, &pool) != 0)
+        {
+          break;
+        }
+    }
+
+  /* Run the batch on this thread if no worker could be started */
+
+  nthreads = i;
+  if (nthreads == 0)
+    {
+      (void)prun_Worker(&pool);
+    }
+
+  for (i = 0; i < nthreads; i++)
+    {
+      pthread_join(thread[i], NULL);
+    }
+
+  /* Then show the results */
+
+  for (i = 0; i < pool.njobs; i++)
+    {
+      prunJob_t *job = &pool.job[i];
+      FILE *output = job->output;
+
+      if (output != NULL)
+        {
+          char buffer[512];
+          size_t nbytes;
+
+          fflush(output);
+          rewind(output);
+          while ((nbytes = fread(buffer, 1, sizeof(buffer), output)) > 0)
+            {
+              fwrite(buffer, 1, nbytes, stdout);
+            }
+
+          fclose(output);
+        }
+
+      if (!job->loaded)
+        {
+          fflush(stdout);
+          fprintf(stderr, "ERROR: Could not load %s\n", job->fileName);
+          status = 1;
+        }
+
+      if (job->image != NULL)
+        {
+          libexec_ReleaseImage(job->image);
+        }
+    }
+
+  pthread_mutex_destroy(&pool.lock);
+  free(pool.job);
+  return status;
+}
+
+/****************************************************************************
+ * Name: prun_ShowStats
+ *
+ * Description:
+ *   Show the execution statistics of a program on stderr in a form that is
+ *   easily parsed by scripts.
+ *
+ ****************************************************************************/
+
+static void prun_ShowStats(EXEC_HANDLE_t handle,
+                           const struct timespec *begin,
+                           const struct timespec *end)
+{
+  struct rusage usage;
+  uint64_t insnCount;
+  double seconds;
+
+  insnCount = libexec_GetInstructionCount(handle);
+  seconds   = (double)(end->tv_sec - begin->tv_sec) +
+              (double)(end->tv_nsec - begin->tv_nsec) / 1.0e9;
+
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+      usage.ru_maxrss = 0;
+    }
+
+  fprintf(stderr, "prun: instructions=%" PRIu64 " seconds=%.6f"
+          " ips=%.0f maxrss_kb=%ld\n",
+          insnCount, seconds,
+          seconds > 0.0 ? (double)insnCount / seconds : 0.0,
+          (long)usage.ru_maxrss);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -246,12 +702,21 @@ int main(int argc, char *argv[])
 {
   EXEC_HANDLE_t handle;
   char fileName[FNAME_SIZE + 1];  /* Object file name */
+  struct timespec begin;
+  struct timespec end;
   prunArgs_t args;
 
   /* Parse the command line arguments */
 
   prun_ParseArgs(argc, argv, &args);
 
+  /* Run a batch of programs in parallel if so requested */
+
+  if (args.jobs > 0)
+    {
+      return prun_RunJobs(&args);
+    }
+
   /* Load the POFF files specified on the command line */
   /* Use .o or command line extension, if supplied */
 
@@ -269,8 +734,50 @@ int main(int argc, char *argv[])
 
   printf("%s Loaded\n", fileName);
 
+  /* Refuse to run a program that failed verification if so requested */
+
+  if (args.verify && !prun_Verified(handle, fileName, stderr))
+    {
+      libexec_Release(handle);
+      exit(1);
+    }
+
+#ifdef CONFIG_PASCAL_PROFILER
+  /* Start counting instruction executions if so requested */
+
+  if (args.profileName != NULL && libexec_EnableProfile(handle) != 0)
+    {
+      fprintf(stderr, "ERROR: Could not enable the profiler\n");
+      exit(1);
+    }
+
+  /* Start sampling the call stack if so requested */
+
+  if (args.sampleName != NULL &&
+      libexec_EnableSampling(handle, args.sampleInterval) != 0)
+    {
+      fprintf(stderr, "ERROR: Could not enable the call stack sampler\n");
+      exit(1);
+    }
+
+  /* Start recording heap allocations if so requested */
+
+  if (args.heapProfileName != NULL &&
+      libexec_EnableHeapProfile(handle) != 0)
+    {
+      fprintf(stderr, "ERROR: Could not enable the heap profiler\n");
+      exit(1);
+    }
+#endif
+
+  /* Memory map typed files if so requested */
+
+  libexec_SetFileMapping(handle, args.mapFiles);
+
   /* And start program execution in the specified mode */
 
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+
 #ifdef CONFIG_PASCAL_DEBUGGER
   if (args.debugger)
     {
@@ -282,6 +789,63 @@ int main(int argc, char *argv[])
       libexec_RunLoop(handle);
     }
 
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  if (args.stats)
+    {
+      prun_ShowStats(handle, &begin, &end);
+    }
+
+#ifdef CONFIG_PASCAL_PROFILER
+  /* Write the execution profile */
+
+  if (args.profileName != NULL)
+    {
+      FILE *report = fopen(args.profileName, "w");
+      if (report == NULL)
+        {
+          fprintf(stderr, "ERROR: Could not open %s\n", args.profileName);
+        }
+      else
+        {
+          libexec_ProfileReport(handle, report);
+          fclose(report);
+        }
+    }
+
+  /* Write the call stack samples */
+
+  if (args.sampleName != NULL)
+    {
+      FILE *stacks = fopen(args.sampleName, "w");
+      if (stacks == NULL)
+        {
+          fprintf(stderr, "ERROR: Could not open %s\n", args.sampleName);
+        }
+      else
+        {
+          libexec_SampleReport(handle, stacks);
+          fclose(stacks);
+        }
+    }
+
+  /* Write the heap profile */
+
+  if (args.heapProfileName != NULL)
+    {
+      FILE *report = fopen(args.heapProfileName, "w");
+      if (report == NULL)
+        {
+          fprintf(stderr, "ERROR: Could not open %s\n",
+                  args.heapProfileName);
+        }
+      else
+        {
+          libexec_HeapProfileReport(handle, report);
+          fclose(report);
+        }
+    }
+#endif
+
   /* Clean up resources used by the interpreter */
 
   libexec_Release(handle);
@@ -0,0 +1,259 @@
+/**********************************************************************
+ * libpas/pstrtod.c
+ * Convert a decimal string to a real value
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************/
+
+/**********************************************************************
+ * Included Files
+ **********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "pas_debug.h"
+#include "pas_machine.h"
+#include "paslib.h"
+
+/**********************************************************************
+ * Pre-processor Definitions
+ **********************************************************************/
+
+/* The number of significant digits that fit in the 64-bit mantissa */
+
+#define MAX_DIGITS      19
+
+/* Integers up to 2**53 and powers of ten up to 10**22 are exactly
+ * representable as doubles.
+ */
+
+#define MAX_EXACT_INT   ((uint64_t)1 << 53)
+#define MAX_EXACT_POW10 22
+
+/* Exponents beyond this overflow or underflow any double */
+
+#define MAX_EXPONENT    100000
+
+/**********************************************************************
+ * Private Data
+ **********************************************************************/
+
+static const double g_pow10[MAX_EXACT_POW10 + 1] =
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/***********************************************************************/
+/* Convert the decimal real number at the beginning of str to a double.
+ * This is the single conversion used by the compiler's tokenizer and by
+ * the run-time READ and VAL.  The accepted form is:
+ *
+ *   [ sign ] [ digit-sequence ] [ '.' [ digit-sequence ] ]
+ *            [ ( 'e' | 'E' ) [ sign ] digit-sequence ]
+ *
+ * with at least one digit in the mantissa.  Leading white space is not
+ * skipped.  If endptr is not NULL, it receives the address of the first
+ * character after the number, or str if no number was found.
+ *
+ * The result is correctly rounded.  The mantissa is accumulated exactly
+ * in 64 bits.  If it is at most 2**53 and the decimal exponent is within
+ * the range of exactly representable powers of ten, then a single
+ * multiplication or division gives the correctly rounded result
+ * (Clinger's fast path).  That covers nearly all real data.  Other values
+ * fall back to the C library strtod().
+ */
+
+double pstrtod(const char *str, char **endptr)
+{
+  const char *ptr   = str;
+  uint64_t mantissa = 0;
+  int  ndigits      = 0;
+  int  exp10        = 0;
+  bool negative     = false;
+  bool truncated    = false;
+  bool anyDigits    = false;
+  double value;
+
+  /* Check for a sign */
+
+  if (*ptr == '+' || *ptr == '-')
+    {
+      negative = (*ptr == '-');
+      ptr++;
+    }
+
+  /* Accumulate the integer part.  Leading zeroes are not significant.
+   * Digits that do not fit in the mantissa only scale it.
+   */
+
+  for (; isdigit((unsigned char)*ptr); ptr++)
+    {
+      int digit = *ptr - '0';
+
+      anyDigits = true;
+      if (ndigits < MAX_DIGITS)
+        {
+          mantissa = 10 * mantissa + digit;
+          if (mantissa != 0)
+            {
+              ndigits++;
+            }
+        }
+      else
+        {
+          exp10++;
+          if (digit != 0)
+            {
+              truncated = true;
+            }
+        }
+    }
+
+  /* Then the fraction part */
+
+  if (*ptr == '.')
+    {
+      for (ptr++; isdigit((unsigned char)*ptr); ptr++)
+        {
+          int digit = *ptr - '0';
+
+          anyDigits = true;
+          if (ndigits < MAX_DIGITS)
+            {
+              mantissa = 10 * mantissa + digit;
+              if (mantissa != 0)
+                {
+                  ndigits++;
+                }
+
+              exp10--;
+            }
+          else if (digit != 0)
+            {
+              truncated = true;
+            }
+        }
+    }
+
+  if (!anyDigits)
+    {
+      if (endptr != NULL)
+        {
+          *endptr = (char *)str;
+        }
+
+      return 0.0;
+    }
+
+  /* Then the optional exponent.  If 'e' is not followed by a
+   * digit-sequence, then it is not part of the number.
+   */
+
+  if (*ptr == 'e' || *ptr == 'E')
+    {
+      const char *expPtr = ptr + 1;
+      bool expNegative   = false;
+      int  exponent      = 0;
+
+      if (*expPtr == '+' || *expPtr == '-')
+        {
+          expNegative = (*expPtr == '-');
+          expPtr++;
+        }
+
+      if (isdigit((unsigned char)*expPtr))
+        {
+          for (; isdigit((unsigned char)*expPtr); expPtr++)
+            {
+              if (exponent < MAX_EXPONENT)
+                {
+                  exponent = 10 * exponent + (*expPtr - '0');
+                }
+            }
+
+          exp10 += expNegative ? -exponent : exponent;
+          ptr    = expPtr;
+        }
+    }
+
+  if (endptr != NULL)
+    {
+      *endptr = (char *)ptr;
+    }
+
+  /* Zero is exact with any exponent */
+
+  if (mantissa == 0)
+    {
+      return negative ? -0.0 : 0.0;
+    }
+
+  /* A value like 123e25 can still use the fast path if some of the
+   * exponent can be moved into the mantissa without loss.
+   */
+
+  if (!truncated)
+    {
+      while (exp10 > MAX_EXACT_POW10 && mantissa <= MAX_EXACT_INT / 10)
+        {
+          mantissa *= 10;
+          exp10--;
+        }
+    }
+
+  if (!truncated && mantissa <= MAX_EXACT_INT &&
+      exp10 >= -MAX_EXACT_POW10 && exp10 <= MAX_EXACT_POW10)
+    {
+      value = (double)mantissa;
+      if (exp10 < 0)
+        {
+          value /= g_pow10[-exp10];
+        }
+      else
+        {
+          value *= g_pow10[exp10];
+        }
+
+      return negative ? -value : value;
+    }
+
+  /* Otherwise, the number needs more than double precision arithmetic to
+   * be rounded correctly.  strtod() accepts the same decimal form (and
+   * handles the sign).
+   */
+
+  return strtod(str, NULL);
+}
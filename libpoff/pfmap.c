@@ -0,0 +1,329 @@
+/**********************************************************************
+ * pfmap.c
+ * Map the loadable sections of a POFF file into memory
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ **********************************************************************/
+
+/**********************************************************************
+ * Included Files
+ **********************************************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "pas_debug.h"    /* Standard types */
+#include "pas_errcodes.h" /* Pascal error definitions */
+
+#include "pofflib.h"      /* POFF library interface */
+#include "pfprivate.h"    /* POFF private definitions */
+
+/***********************************************************************
+ * Private Types
+ ***********************************************************************/
+
+/* A POFF file mapped for execution.  Only the file header and the
+ * program and read-only data sections are examined.  The other sections
+ * (symbols, relocations, line numbers, debug information) are never
+ * read, so their pages are never faulted in.
+ */
+
+struct poffMapInfo_s
+{
+  uint8_t         *base;       /* Start of the file in memory */
+  size_t           size;       /* Size of the file */
+  bool             mapped;     /* true: mmap'ed; false: malloc'ed */
+  poffFileHeader_t fileHeader; /* File header in host byte order */
+  const uint8_t   *progData;   /* Program section data */
+  uint32_t         progSize;   /* Size of the program section */
+  const uint8_t   *roData;     /* Read-only data section data */
+  uint32_t         roSize;     /* Size of the read-only data section */
+};
+
+typedef struct poffMapInfo_s poffMapInfo_t;
+
+/***********************************************************************
+ * Private Functions
+ ***********************************************************************/
+
+/***********************************************************************/
+/* Bring the file into memory.  The file is mapped read-only if
+ * possible.  Otherwise (e.g., on a file system that does not support
+ * mmap()), the file is read into an allocated buffer.
+ */
+
+static uint16_t poffMapContent(poffMapInfo_t *mapInfo, int fd)
+{
+  struct stat statBuf;
+  size_t nread;
+  ssize_t nbytes;
+
+  if (fstat(fd, &statBuf) < 0 || statBuf.st_size <= 0)
+    {
+      return ePOFFREADERROR;
+    }
+
+  mapInfo->size = statBuf.st_size;
+  mapInfo->base = (uint8_t*)mmap(NULL, mapInfo->size, PROT_READ,
+                                 MAP_PRIVATE, fd, 0);
+  if (mapInfo->base != (uint8_t*)MAP_FAILED)
+    {
+      mapInfo->mapped = true;
+      return eNOERROR;
+    }
+
+  mapInfo->base = (uint8_t*)malloc(mapInfo->size);
+  if (mapInfo->base == NULL)
+    {
+      return eNOMEMORY;
+    }
+
+  for (nread = 0; nread < mapInfo->size; nread += nbytes)
+    {
+      nbytes = read(fd, mapInfo->base + nread, mapInfo->size - nread);
+      if (nbytes <= 0)
+        {
+          free(mapInfo->base);
+          mapInfo->base = NULL;
+          return ePOFFREADERROR;
+        }
+    }
+
+  mapInfo->mapped = false;
+  return eNOERROR;
+}
+
+/***********************************************************************/
+/* Verify the file header and locate the program and read-only data
+ * sections.
+ */
+
+static uint16_t poffMapSections(poffMapInfo_t *mapInfo)
+{
+  poffFileHeader_t *fileHeader = &mapInfo->fileHeader;
+  poffSectionHeader_t sectionHeader;
+  uint32_t offset;
+  int i;
+
+  /* Get the POFF file header.  It is retained in big-endian order. */
+
+  if (mapInfo->size < sizeof(poffFileHeader_t))
+    {
+      return ePOFFREADERROR;
+    }
+
+  memcpy(fileHeader, mapInfo->base, sizeof(poffFileHeader_t));
+  poffSwapFileHeader(fileHeader);
+
+  /* Verify that this is a valid POFF header */
+
+  if ((fileHeader->fh_ident[FHI_MAG0] != FHI_POFF_MAG0) ||
+      (fileHeader->fh_ident[FHI_MAG1] != FHI_POFF_MAG1) ||
+      (fileHeader->fh_ident[FHI_MAG2] != FHI_POFF_MAG2) ||
+      (fileHeader->fh_ident[FHI_MAG3] != FHI_POFF_MAG3) ||
+      (fileHeader->fh_version         != FHV_CURRENT))
+    {
+      return ePOFFBADFORMAT;
+    }
+
+  /* Find the program and read-only data sections */
+
+  offset = fileHeader->fh_shoff;
+
+  for (i = 0; i < fileHeader->fh_shnum; i++)
+    {
+      if (offset > mapInfo->size ||
+          mapInfo->size - offset < sizeof(poffSectionHeader_t))
+        {
+          return ePOFFREADERROR;
+        }
+
+      memcpy(&sectionHeader, mapInfo->base + offset,
+             sizeof(poffSectionHeader_t));
+      poffSwapSectionHeader(&sectionHeader);
+
+      if (sectionHeader.sh_type == SHT_PROGDATA)
+        {
+          if (sectionHeader.sh_offset > mapInfo->size ||
+              mapInfo->size - sectionHeader.sh_offset <
+              sectionHeader.sh_size)
+            {
+              return ePOFFREADERROR;
+            }
+
+          if ((sectionHeader.sh_flags & SHF_EXEC) != 0)
+            {
+              mapInfo->progData = mapInfo->base + sectionHeader.sh_offset;
+              mapInfo->progSize = sectionHeader.sh_size;
+            }
+          else
+            {
+              mapInfo->roData   = mapInfo->base + sectionHeader.sh_offset;
+              mapInfo->roSize   = sectionHeader.sh_size;
+            }
+        }
+
+      /* Get the offset to the next section */
+
+      offset += fileHeader->fh_shsize;
+    }
+
+  return eNOERROR;
+}
+
+/***********************************************************************
+ * Public Functions
+ ***********************************************************************/
+
+/***********************************************************************/
+/* Map a POFF file for execution.  The section data is used in place;
+ * nothing is copied and the sections that are not needed to run the
+ * program are not read.
+ */
+
+uint16_t poffMapFile(const char *fileName, poffMapHandle_t *handle)
+{
+  poffMapInfo_t *mapInfo;
+  uint16_t retval;
+  int fd;
+
+  *handle = NULL;
+
+  mapInfo = (poffMapInfo_t*)calloc(1, sizeof(poffMapInfo_t));
+  if (mapInfo == NULL)
+    {
+      return eNOMEMORY;
+    }
+
+  fd = open(fileName, O_RDONLY);
+  if (fd < 0)
+    {
+      free(mapInfo);
+      return eOPENFAILED;
+    }
+
+  /* The mapping remains valid after the file is closed */
+
+  retval = poffMapContent(mapInfo, fd);
+  (void)close(fd);
+
+  if (retval == eNOERROR)
+    {
+      retval = poffMapSections(mapInfo);
+      if (retval != eNOERROR)
+        {
+          poffUnmapFile(mapInfo);
+          return retval;
+        }
+
+      *handle = mapInfo;
+    }
+  else
+    {
+      free(mapInfo);
+    }
+
+  return retval;
+}
+
+/***********************************************************************/
+
+void poffUnmapFile(poffMapHandle_t handle)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+
+  if (mapInfo->mapped)
+    {
+      (void)munmap(mapInfo->base, mapInfo->size);
+    }
+  else
+    {
+      free(mapInfo->base);
+    }
+
+  free(mapInfo);
+}
+
+/***********************************************************************/
+
+uint8_t poffMapGetFileType(poffMapHandle_t handle)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+  return mapInfo->fileHeader.fh_type;
+}
+
+/***********************************************************************/
+
+uint8_t poffMapGetArchitecture(poffMapHandle_t handle)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+  return mapInfo->fileHeader.fh_arch;
+}
+
+/***********************************************************************/
+
+uint32_t poffMapGetEntryPoint(poffMapHandle_t handle)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+  return mapInfo->fileHeader.fh_entry;
+}
+
+/***********************************************************************/
+/* Return the program data (in place) and its size */
+
+uint32_t poffMapGetProgramData(poffMapHandle_t handle,
+                               const uint8_t **progData)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+
+  *progData = mapInfo->progData;
+  return mapInfo->progSize;
+}
+
+/***********************************************************************/
+/* Return the read-only data (in place) and its size */
+
+uint32_t poffMapGetRoData(poffMapHandle_t handle, const uint8_t **roData)
+{
+  poffMapInfo_t *mapInfo = (poffMapInfo_t*)handle;
+
+  *roData = mapInfo->roData;
+  return mapInfo->roSize;
+}
@@ -105,3 +105,19 @@ void poffAddProgByte(poffHandle_t handle, uint8_t progByte)
   poffInfo->progSection.sh_size++;
 }
 
+
+/***********************************************************************/
+/* Replace one byte of program data that was already added */
+
+void poffSetProgByte(poffHandle_t handle, uint32_t offset, uint8_t progByte)
+{
+  poffInfo_t *poffInfo = (poffInfo_t*)handle;
+
+  if (poffInfo->progSectionData == NULL ||
+      offset >= poffInfo->progSection.sh_size)
+    {
+      fatal(ePOFFCONFUSION);
+    }
+
+  poffInfo->progSectionData[offset] = progByte;
+}
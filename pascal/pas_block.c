@@ -1522,20 +1522,21 @@ static symbol_t *pas_NewComplexType(char *typeName)
           typeIdPtr = pas_DeclareSimpleType(NULL);
         }
 
-      /* Verify that the ordinal-type is either a scalar or a
-       * subrange type.  These are the only valid types for 'SET'
+      /* Verify that the ordinal-type is a scalar, a subrange, or CHAR.
+       * These are the only valid types for 'SET'
        */
 
       if ((typeIdPtr) &&
           ((typeIdPtr->sParm.t.tType == sSCALAR) ||
-           (typeIdPtr->sParm.t.tType == sSUBRANGE)))
+           (typeIdPtr->sParm.t.tType == sSUBRANGE) ||
+           (typeIdPtr->sParm.t.tType == sCHAR)))
         {
           /* Declare the SET type */
 
           typePtr = pas_AddTypeDefine(typeName, sSET, sSET_SIZE, typeIdPtr);
           if (typePtr != NULL)
             {
-              int16_t nObjects;
+              int32_t nObjects;
 
               /* Copy the scalar/subrange characteristics for convenience */
 
@@ -1555,7 +1556,12 @@ static symbol_t *pas_NewComplexType(char *typeName)
                   error(eSETRANGE);
                   typePtr->sParm.t.tMaxValue = typePtr->sParm.t.tMinValue +
                                                sSET_MAXELEM - 1;
+                  nObjects = sSET_MAXELEM;
                 }
+
+              /* The set needs only enough space for its members */
+
+              typePtr->sParm.t.tAllocSize = SET_ALLOCSIZE(nObjects);
             }
         }
       else
@@ -2694,10 +2700,8 @@ static void pas_AddVarInitializer(symbol_t *varPtr, symbol_t *typePtr)
           pas_ConstantExpression(exprSet, typePtr);
           if (g_constantToken == tSET_CONST)
             {
-              initializer.iValue.iSet[0] = g_constantSet[0];
-              initializer.iValue.iSet[1] = g_constantSet[1];
-              initializer.iValue.iSet[2] = g_constantSet[2];
-              initializer.iValue.iSet[3] = g_constantSet[3];
+              memcpy(initializer.iValue.iSet, g_constantSet,
+                     sizeof(g_constantSet));
             }
           else
             {
@@ -49,6 +49,7 @@
 #include "pas_tkndefs.h"   /* Token / symbol table definitions */
 #include "pas_pcode.h"     /* Logical opcode definitions */
 #include "pas_longops.h"   /* Logical long integer/word opcode definitions */
+#include "pas_setops.h"    /* Set operation codes */
 #include "pas_errcodes.h"  /* error code definitions */
 
 #include "pas_main.h"      /* Global variables */
@@ -190,11 +191,44 @@ void pas_GenerateFpOperation(uint8_t fpOpcode)
 }
 
 /****************************************************************************/
-/* Generate a pseudo call to a built-in, set operator/functionon */
+/* Generate a pseudo call to a built-in, set operator/functionon.  setSize
+ * is the size in bytes of the set operands.
+ */
+
+void pas_GenerateSetOperation(uint8_t setOpcode, uint16_t setSize)
+{
+  insn_GenerateSetOperation(SETOP_ENCODE(setOpcode, setSize));
+}
+
+/****************************************************************************/
+/* Change the set size of a set operation that was generated earlier.
+ * progOffset is the value that pas_GetProgOffset() returned just before
+ * the set operation was generated.
+ */
+
+void pas_PatchSetOperation(uint32_t progOffset, uint8_t setOpcode,
+                           uint16_t setSize)
+{
+  insn_PatchSetOperation(progOffset, SETOP_ENCODE(setOpcode, setSize));
+}
+
+/****************************************************************************/
+/* Return the offset where the next instruction will be generated */
+
+uint32_t pas_GetProgOffset(void)
+{
+  return poffGetProgSize(g_poffHandle);
+}
+
+/****************************************************************************/
+/* Generate an in-place test or update of one member of a set variable
+ * (opSETIN, opSETINCL, or opSETEXCL).  setSize is the size in bytes of the
+ * set.
+ */
 
-void pas_GenerateSetOperation(uint8_t setOpcode)
+void pas_GenerateSetBitOperation(enum pcode_e eOpCode, uint16_t setSize)
 {
-  insn_GenerateSetOperation(setOpcode);
+  insn_GenerateSetBitOperation(eOpCode, setSize);
 }
 
 /****************************************************************************/
@@ -53,7 +53,10 @@ void     pas_GenerateSimple(enum pcode_e eOpCode);
 void     pas_GenerateDataOperation(enum pcode_e eOpCode, int32_t dwData);
 void     pas_GenerateDataSize(int32_t dwDataSize);
 void     pas_GenerateFpOperation(uint8_t fpOpcode);
-void     pas_GenerateSetOperation(uint8_t setOpcode);
+void     pas_GenerateSetOperation(uint8_t setOpcode, uint16_t setSize);
+void     pas_PatchSetOperation(uint32_t progOffset, uint8_t setOpcode,
+                               uint16_t setSize);
+void     pas_GenerateSetBitOperation(enum pcode_e eOpCode, uint16_t setSize);
 void     pas_GenerateIoOperation(uint16_t ioOpcode);
 void     pas_StringLibraryCall(uint16_t libOpcode);
 void     pas_OsInterfaceCall(uint16_t libOpcode);
@@ -70,6 +73,7 @@ void     pas_GenerateDebugInfo(symbol_t *pProcPtr, uint32_t dwReturnSize);
 void     pas_GenerateProcExport(symbol_t *pProcPtr);
 void     pas_GenerateProcImport(symbol_t *pProcPtr);
 void     pas_GeneratePoffOutput(void);
+uint32_t pas_GetProgOffset(void);
 
 void     pas_GenerateSimpleLongOperation(enum longops_e longop);
 void     pas_GenerateDataLongOperation(enum longops_e longop, int32_t dwData);
@@ -92,82 +92,46 @@
    ((c) ? PASCAL_TRUE : PASCAL_FALSE)
 
 #define copySet(src, dest) \
-   do \
-     { \
-       (dest)[0] = (src)[0]; \
-       (dest)[1] = (src)[1]; \
-       (dest)[2] = (src)[2]; \
-       (dest)[3] = (src)[3]; \
-     } \
-   while (0)
+   memcpy((dest), (src), sSET_MAXSIZE)
 
 #define emptySet(dest) \
-   do \
-     { \
-       (dest)[0] = 0; \
-       (dest)[1] = 0; \
-       (dest)[2] = 0; \
-       (dest)[3] = 0; \
-     } \
-   while (0)
+   memset((dest), 0, sSET_MAXSIZE)
 
 #define equalSets(s1, s2) \
-   pascalBoolean((s1)[0] == (s2)[0] && \
-                 (s1)[1] == (s2)[1] && \
-                 (s1)[2] == (s2)[2] && \
-                 (s1)[3] == (s2)[3])
+   pascalBoolean(memcmp((s1), (s2), sSET_MAXSIZE) == 0)
 
 #define unEqualSets(s1, s2) \
-   pascalBoolean((s1)[0] != (s2)[0] || \
-                 (s1)[1] != (s2)[1] || \
-                 (s1)[2] != (s2)[2] || \
-                 (s1)[3] != (s2)[3])
+   pascalBoolean(memcmp((s1), (s2), sSET_MAXSIZE) != 0)
 
 #define containsSet(s1, s2) \
-   pascalBoolean(((s1)[0] & (s2)[0]) == (s2)[0] && \
-                 ((s1)[1] & (s2)[1]) == (s2)[1] && \
-                 ((s1)[2] & (s2)[2]) == (s2)[2] && \
-                 ((s1)[3] & (s2)[3]) == (s2)[3])
+   pascalBoolean(pas_ContainsSet((s1), (s2)))
 
-#define setUnion(src, dest) \
+/* Apply 'expr' to each word of the sets, using srcWord and destWord */
+
+#define setOperation(src, dest, expr) \
    do \
      { \
-       (dest)[0] |= (src)[0]; \
-       (dest)[1] |= (src)[1]; \
-       (dest)[2] |= (src)[2]; \
-       (dest)[3] |= (src)[3]; \
+       int i; \
+       for (i = 0; i < sSET_MAXWORDS; i++) \
+         { \
+           uint16_t srcWord  = (src)[i]; \
+           uint16_t destWord = (dest)[i]; \
+           (dest)[i] = (expr); \
+         } \
      } \
    while (0)
 
+#define setUnion(src, dest) \
+   setOperation(src, dest, destWord | srcWord)
+
 #define setDifference(src, dest) \
-   do \
-     { \
-       (dest)[0] &= ~(src)[0]; \
-       (dest)[1] &= ~(src)[1]; \
-       (dest)[2] &= ~(src)[2]; \
-       (dest)[3] &= ~(src)[3]; \
-     } \
-   while (0)
+   setOperation(src, dest, destWord & ~srcWord)
 
 #define setSymmetricDifference(src, dest) \
-   do \
-     { \
-       (dest)[0] ^= (src)[0]; \
-       (dest)[1] ^= (src)[1]; \
-       (dest)[2] ^= (src)[2]; \
-       (dest)[3] ^= (src)[3]; \
-     } \
-   while (0)
+   setOperation(src, dest, destWord ^ srcWord)
 
 #define setIntersection(src, dest) \
-   do \
-     { \
-       (dest)[0] &= (src)[0]; \
-       (dest)[1] &= (src)[1]; \
-       (dest)[2] &= (src)[2]; \
-       (dest)[3] &= (src)[3]; \
-     } \
-   while (0)
+   setOperation(src, dest, destWord & srcWord)
 
 /****************************************************************************
  * Private Function Prototypes
@@ -178,6 +142,7 @@ static void pas_ConstantSimpleExpression(exprType_t findExprType,
 static void pas_ConstantTerm(exprType_t findExprType, symbol_t *typePtr);
 static void pas_ConstantFactor(exprType_t findExprType, symbol_t *typePtr);
 
+static bool pas_ContainsSet(const uint16_t *set1, const uint16_t *set2);
 static void pas_GetConstantSubSet(uint16_t minElement, uint16_t maxElement);
 static void pas_AddBitSetElements(uint16_t firstElement,
                                   uint16_t lastElement, uint16_t minElement,
@@ -193,7 +158,7 @@ double   g_constantReal;
 char    *g_constantStart;
 uint32_t g_constantStrOffset;
 int      g_constantStrLen;
-uint16_t g_constantSet[sSET_WORDS];
+uint16_t g_constantSet[sSET_MAXWORDS];
 
 /****************************************************************************
  * Private Functions
@@ -209,7 +174,7 @@ static void pas_ConstantSimpleExpression(exprType_t findExprType,
   int      term;
   int32_t  termInt;
   double   termReal;
-  uint16_t termSet[sSET_WORDS];
+  uint16_t termSet[sSET_MAXWORDS];
 
   /* FORM: [+|-] <term> [{+|-} <term> [{+|-} <term> [...]]]
    * get +/- unary operation
@@ -388,7 +353,7 @@ void pas_ConstantTerm(exprType_t findExprType, symbol_t *typePtr)
   int      factor;
   int32_t  factorInt;
   double   factorReal;
-  uint16_t factorSet[sSET_WORDS];
+  uint16_t factorSet[sSET_MAXWORDS];
 
   /* FORM:  <factor> [<operator> <factor>[<operator><factor>[...]]] */
 
@@ -788,76 +753,54 @@ static void pas_GetConstantSubSet(uint16_t minElement, uint16_t maxElement)
         {
           /* Add a single element to the set */
 
-          uint16_t bitNumber = firstElement - minElement;
-          int wordIndex      = bitNumber >> 4;
-          int bitIndex       = bitNumber & 0x0f;
-
-          g_constantSet[wordIndex] |= (1 << bitIndex);
+          pas_AddBitSetElements(firstElement, firstElement, minElement,
+                                maxElement);
         }
     }
 }
 
 /****************************************************************************/
  
+static bool pas_ContainsSet(const uint16_t *set1, const uint16_t *set2)
+{
+  int i;
+
+  for (i = 0; i < sSET_MAXWORDS; i++)
+    {
+      if ((set1[i] & set2[i]) != set2[i])
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************/
+
 static void pas_AddBitSetElements(uint16_t firstElement,
                                   uint16_t lastElement, uint16_t minElement,
                                   uint16_t maxElement)
 {
-  uint16_t firstBitNo;
-  uint16_t lastBitNo;
-  uint16_t leadMask;
-  uint16_t tailMask;
-  int      wordIndex;
-
-  /* Set all bits from firstElement through lastElement. */
-
-  firstBitNo = firstElement - minElement;
-  lastBitNo  = lastElement  - minElement;
-  leadMask   = (0xffff << (firstBitNo & 0x0f));
-  tailMask   = (0xffff >> ((BITS_IN_INTEGER - 1) - (lastBitNo & 0x0f)));
+  uint16_t bitNumber;
 
-  /* Special case:  The entire sub-range fits in one word */
+  /* The elements must lie within the set */
 
-  wordIndex = firstBitNo >> 4;
-  if (wordIndex == (lastBitNo >> 4))
+  if (firstElement < minElement || lastElement > maxElement ||
+      firstElement > lastElement ||
+      lastElement - minElement >= sSET_MAXELEM)
     {
-      g_constantSet[wordIndex] = (leadMask & tailMask);
+      error(eSETRANGE);
+      return;
     }
 
-  /* No, the last bit lies in a different word than the first */
+  /* Set all bits from firstElement through lastElement. */
 
-  else
+  for (bitNumber = firstElement - minElement;
+       bitNumber <= lastElement - minElement;
+       bitNumber++)
     {
-      uint16_t bitMask;
-      int      nBits;
-      int      leadBits;
-      int      tailBits;
-      int      bitsInWord;
-
-      nBits    = lastElement  - firstElement + 1;
-      leadBits = BITS_IN_INTEGER - firstBitNo;
-      tailBits = (lastBitNo & 0x0f) + 1;
-
-      /* Loop for each word */
-
-      for (bitMask = leadMask, bitsInWord = leadBits;
-           nBits > 0;
-           wordIndex++)
-        {
-          g_constantSet[wordIndex] = bitMask;
-          nBits                   -= bitsInWord;
-
-          if (nBits >= BITS_IN_INTEGER)
-            {
-              bitsInWord = BITS_IN_INTEGER;
-              bitMask    = 0xffff;
-            }
-          else if (nBits > 0)
-            {
-              nBits   = tailBits;
-              bitMask = tailMask;
-            }
-        }
+      g_constantSet[bitNumber >> 4] |= (1 << (bitNumber & 0x0f));
     }
 }
 
@@ -879,7 +822,7 @@ void pas_ConstantExpression(exprType_t findExprType, symbol_t *typePtr)
   if ((isRelationalOperator(g_token) && isRelationalType(g_constantToken)) ||
       (isRelationalSetOperator(g_token) && g_constantToken == tSET_CONST))
     {
-      uint16_t simple1Set[sSET_WORDS];
+      uint16_t simple1Set[sSET_MAXWORDS];
 
       int simple1        = g_constantToken;
       int32_t simple1Int = g_constantInt;
@@ -63,6 +63,15 @@
 #include "pas_insn.h"
 #include "pas_error.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Special values of an empty set program offset (see pas_TakeEmptySet()) */
+
+#define NO_EMPTY_SET   0xffffffff /* Not an empty set of unknown size */
+#define LOST_EMPTY_SET 0xfffffffe /* Empty set that can no longer be resized */
+
 /****************************************************************************
  * Private Type Definitions
  ****************************************************************************/
@@ -114,6 +123,8 @@ typedef struct exprOpcodes_s exprOpCodes_t;
  ****************************************************************************/
 
 static exprType_t pas_SimpleExpression(exprType_t findExprType);
+static exprType_t pas_StringConcatenation(exprType_t term1Type,
+                    exprType_t findExprType);
 static exprType_t pas_Term(exprType_t findExprType);
 static exprType_t pas_Factor(exprType_t findExprType);
 static exprType_t pas_ComplexFactor(void);
@@ -134,6 +145,8 @@ static exprType_t pas_FactorExprType(exprType_t baseExprType,
 static void       pas_SetAbstractType(symbol_t *sType);
 static exprType_t pas_GetSetFactor(void);
 static bool       pas_GetSubSet(symbol_t *setTypePtr, bool first);
+static uint32_t   pas_TakeEmptySet(exprType_t exprType);
+static void       pas_ResizeEmptySet(uint32_t progOffset);
 static exprType_t pas_TypeCast(symbol_t *typePtr);
 static bool       pas_IsOrdinalExpression(exprType_t testExprType);
 
@@ -148,6 +161,16 @@ static bool       pas_IsOrdinalExpression(exprType_t testExprType);
 
 symbol_t *g_abstractTypePtr;
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Program offset of the most recent empty set that was generated before the
+ * size of the set it is used with was known.
+ */
+
+static uint32_t g_emptySetOffset = NO_EMPTY_SET;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -159,6 +182,7 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
 {
   int16_t    operation = '+';
   uint16_t   arg8FpBits;
+  uint32_t   emptySetOffset;
   exprType_t term1Type;
   exprType_t term2Type;
 
@@ -230,41 +254,23 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
         }
 
       /* Special case for string types.  So far, we have parsed
-       * '<string> +'  At this point, it is safe to assume we
-       * going to modify a string.  So, if the string has not
-       * been copied to the string stack, we will have to do that
-       * now.
+       * '<string> +' or '<char> +'.  The whole chain of '+' terms is
+       * gathered and concatenated into a new string at once.
        */
 
-      if (operation == '+')
+      if (operation == '+' &&
+          (term1Type == exprString || term1Type == exprChar))
         {
-          if (term1Type == exprString)
-            {
-              /* Duplicate the sting on the string stack. */
-
-              pas_StringLibraryCall(lbSTRDUP);
-            }
-
-          /* If we are going to add something to a char, then the result
-           * must be a string.  We will similarly have to convert the
-           * character to a string.
-           */
-
-          else if (term1Type == exprChar)
-            {
-              /* Expand the character to a string on the string stack.  And
-               * change the expression type to reflect this.
-               */
-
-              pas_StringLibraryCall(lbMKSTKC);
-              term1Type = exprString;
-            }
+          term1Type = pas_StringConcatenation(term1Type, findExprType);
+          continue;
         }
 
       /* Get the 2nd term */
 
+      emptySetOffset = pas_TakeEmptySet(term1Type);
       getToken();
       term2Type = pas_Term(findExprType);
+      pas_ResizeEmptySet(emptySetOffset);
 
       /* Before generating the operation, verify that the types match.
        * Perform automatic type conversion from INTEGER to REAL as
@@ -323,6 +329,14 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
                   term2Type = term1Type;
                 }
 
+              /* The empty set may be combined with any set */
+
+              else if ((term1Type == exprSet || term1Type == exprEmptySet) &&
+                       (term2Type == exprSet || term2Type == exprEmptySet))
+                {
+                  term1Type = exprSet;
+                }
+
                /* Otherwise, the two terms must agree in type */
 
               else
@@ -372,33 +386,8 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
 
             case exprSet :
             case exprEmptySet :
-              pas_GenerateSetOperation(setUNION);
-              break;
-
-              /* Handle the special cases where '+' indicates that we are
-               * concatenating a string or a character to the end of a
-               * string.  Note that these operations can only be performed
-               * on stack copies of the strings.  Logic above should have
-               * made the conversion for the case of exprString.
-               */
-
-            case exprString :
-              if (term2Type == exprString)
-                {
-                  /* We are concatenating one string with another.*/
-
-                  pas_StringLibraryCall(lbSTRCAT);
-                }
-              else if (term2Type == exprChar)
-                {
-                  /* We are concatenating a character to the end of a string */
-
-                  pas_StringLibraryCall(lbSTRCATC);
-                }
-              else
-                {
-                  error(eTERMTYPE);
-                }
+              pas_GenerateSetOperation(setUNION,
+                                       pas_SetSize(g_abstractTypePtr));
               break;
 
               /* Otherwise, the '+' operation is not permitted */
@@ -434,7 +423,8 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
           else if (term1Type == exprSet ||
                    term1Type == exprEmptySet)
             {
-              pas_GenerateSetOperation(setDIFFERENCE);
+              pas_GenerateSetOperation(setDIFFERENCE,
+                                       pas_SetSize(g_abstractTypePtr));
             }
 
           /* Otherwise, the '-' operation is not permitted */
@@ -495,7 +485,8 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
 
           if (term1Type == exprSet || term1Type == exprEmptySet)
             {
-              pas_GenerateSetOperation(setSYMMETRICDIFF);
+              pas_GenerateSetOperation(setSYMMETRICDIFF,
+                                       pas_SetSize(g_abstractTypePtr));
             }
 
           /* Otherwise, the 'OR' operation is not permitted */
@@ -515,6 +506,65 @@ static exprType_t pas_SimpleExpression(exprType_t findExprType)
   return term1Type;
 }
 
+/****************************************************************************/
+/* Process a chain of string and character concatenations.  The first term
+ * is already on the stack and the current token is the first '+'.  The
+ * terms are left on the stack as they are parsed, then a single lbSTRCATN
+ * builds the result.  No copy of the first string is needed.
+ */
+
+static exprType_t pas_StringConcatenation(exprType_t term1Type,
+                                          exprType_t findExprType)
+{
+  exprType_t termType;
+  uint16_t   charMask;
+  uint16_t   nTerms;
+
+  /* FORM: <term> + <term> [+ <term> [...]] */
+
+  charMask = (term1Type == exprChar) ? 1 : 0;
+  nTerms   = 1;
+
+  while (g_token == '+')
+    {
+      /* Get the next term.  It must be a string or a character */
+
+      getToken();
+      termType = pas_Term(findExprType);
+
+      if (termType == exprChar)
+        {
+          charMask |= (1 << nTerms);
+        }
+      else if (termType != exprString)
+        {
+          error(eTERMTYPE);
+        }
+
+      nTerms++;
+
+      /* If the library call cannot take any more operands, concatenate
+       * what we have so far.  The result is the first operand of the next
+       * group.
+       */
+
+      if (nTerms >= MAX_STRCATN && g_token == '+')
+        {
+          pas_GenerateDataOperation(opPUSH, charMask);
+          pas_GenerateDataOperation(opPUSH, nTerms);
+          pas_StringLibraryCall(lbSTRCATN);
+
+          charMask = 0;
+          nTerms   = 1;
+        }
+    }
+
+  pas_GenerateDataOperation(opPUSH, charMask);
+  pas_GenerateDataOperation(opPUSH, nTerms);
+  pas_StringLibraryCall(lbSTRCATN);
+  return exprString;
+}
+
 /****************************************************************************/
 /* Evaluate a TERM */
 
@@ -522,6 +572,7 @@ static exprType_t pas_Term(exprType_t findExprType)
 {
   uint8_t    operation;
   uint16_t   arg8FpBits;
+  uint32_t   emptySetOffset;
   exprType_t factor1Type;
   exprType_t factor2Type;
 
@@ -551,6 +602,7 @@ static exprType_t pas_Term(exprType_t findExprType)
        * ordinal type regardless of what is being shifted.
        */
 
+      emptySetOffset = pas_TakeEmptySet(factor1Type);
       getToken();
 
       if (operation == tSHL || operation == tSHR)
@@ -577,6 +629,8 @@ static exprType_t pas_Term(exprType_t findExprType)
           factor2Type = pas_Factor(findExprType);
         }
 
+      pas_ResizeEmptySet(emptySetOffset);
+
       /* Before generating the operation, verify that the types match.
        * Perform automatic type conversion from INTEGER to REAL as
        * necessary.
@@ -692,7 +746,8 @@ static exprType_t pas_Term(exprType_t findExprType)
           else if (factor1Type == exprSet ||
                    factor1Type == exprEmptySet)
             {
-              pas_GenerateSetOperation(setINTERSECTION);
+              pas_GenerateSetOperation(setINTERSECTION,
+                                       pas_SetSize(g_abstractTypePtr));
             }
           else
             {
@@ -3131,10 +3186,17 @@ static exprType_t pas_GetSetFactor(void)
   if (g_token == ']')
     {
       /* Generate the empty set.  An empty set differs from other sets in
-       * that there is no abstract base type for the empty set.
+       * that there is no abstract base type for the empty set.  Its size is
+       * that of the set it will be used with, if that is known.  Otherwise,
+       * remember where it is so that it can be resized later.
        */
 
-      pas_GenerateSetOperation(setEMPTY);
+      if (g_abstractTypePtr == NULL)
+        {
+          g_emptySetOffset = pas_GetProgOffset();
+        }
+
+      pas_GenerateSetOperation(setEMPTY, pas_SetSize(g_abstractTypePtr));
       return exprEmptySet;
     }
 
@@ -3238,7 +3300,7 @@ static bool pas_GetSubSet(symbol_t *setTypePtr, bool first)
       /* Yes, then expand the pushed value into a singleton set */
 
       pas_GenerateDataOperation(opPUSH, setTypePtr->sParm.t.tMinValue);
-      pas_GenerateSetOperation(setSINGLETON);
+      pas_GenerateSetOperation(setSINGLETON, pas_SetSize(setTypePtr));
     }
   else
     {
@@ -3260,7 +3322,7 @@ static bool pas_GetSubSet(symbol_t *setTypePtr, bool first)
         */
 
       pas_GenerateDataOperation(opPUSH, setTypePtr->sParm.t.tMinValue);
-      pas_GenerateSetOperation(setSUBRANGE);
+      pas_GenerateSetOperation(setSUBRANGE, pas_SetSize(setTypePtr));
     }
 
   /* If this was not the first set-subset, then push an operation to OR it
@@ -3269,12 +3331,65 @@ static bool pas_GetSubSet(symbol_t *setTypePtr, bool first)
 
   if (!first)
     {
-      pas_GenerateSetOperation(setUNION);
+      pas_GenerateSetOperation(setUNION, pas_SetSize(setTypePtr));
     }
 
   return false;
 }
 
+/****************************************************************************/
+/* An empty set that is the first operand of a set operation is generated
+ * before the size of the second set is known.  pas_TakeEmptySet() is called
+ * with the type of the first operand before the second is parsed.  It
+ * returns the program offset of that empty set, or NO_EMPTY_SET if the first
+ * operand is not an empty set of unknown size.
+ */
+
+static uint32_t pas_TakeEmptySet(exprType_t exprType)
+{
+  uint32_t progOffset = NO_EMPTY_SET;
+
+  if (exprType == exprEmptySet && g_abstractTypePtr == NULL)
+    {
+      /* The offset is lost if the empty set was the result of an operation
+       * on two empty sets, as in ([] + []).
+       */
+
+      progOffset = g_emptySetOffset;
+      if (progOffset == NO_EMPTY_SET)
+        {
+          progOffset = LOST_EMPTY_SET;
+        }
+    }
+
+  g_emptySetOffset = NO_EMPTY_SET;
+  return progOffset;
+}
+
+/****************************************************************************/
+/* Called after the second operand has been parsed.  The empty set returned
+ * by pas_TakeEmptySet() is given the size of the second set.
+ */
+
+static void pas_ResizeEmptySet(uint32_t progOffset)
+{
+  uint16_t setSize = pas_SetSize(g_abstractTypePtr);
+
+  if (progOffset == LOST_EMPTY_SET)
+    {
+      if (setSize != sSET_SIZE)
+        {
+          error(eSET);
+        }
+    }
+  else if (progOffset != NO_EMPTY_SET)
+    {
+      pas_PatchSetOperation(progOffset, setEMPTY, setSize);
+    }
+
+  g_emptySetOffset = NO_EMPTY_SET;
+}
+
 /****************************************************************************/
 /* A type name may be part of a valid factor if it is a type case */
 
@@ -3674,19 +3789,31 @@ exprType_t pas_Expression(exprType_t findExprType, symbol_t *typePtr)
     {
       symbol_t *abstract1Type = g_abstractTypePtr;
       symbol_t *abstract2Type = NULL;
+      uint32_t  emptySetOffset;
+      uint16_t  setSize;
 
       /* The top of the stack may hold either (1) the first set in a binary
        * operation or (2) an integer-size, subrange member as the first part of
        * the set-member.  g_abstractTypePtr will be NULL in that latter case.
+       * In the first case, the type of the first set is also the type of the
+       * second.
        *
        * Get the second simple expression which should be a SET in all cases
        * and should have a non-NULL g_abstractTypePtr.
        */
 
+      emptySetOffset    = pas_TakeEmptySet(simple1Type);
       g_abstractTypePtr = NULL;
+      if (exprOpCodes.setOpCode != setMEMBER)
+        {
+          g_abstractTypePtr = abstract1Type;
+        }
+
       simple2Type       = pas_SimpleExpression(exprSet);
       haveSimple2       = true;
       abstract2Type     = g_abstractTypePtr;
+      setSize           = pas_SetSize(abstract2Type);
+      pas_ResizeEmptySet(emptySetOffset);
 
       /* In all cases, the second expression must always be a SET */
 
@@ -3712,7 +3839,7 @@ exprType_t pas_Expression(exprType_t findExprType, symbol_t *typePtr)
                   }
                 else
                   {
-                    pas_GenerateSetOperation(exprOpCodes.setOpCode);
+                    pas_GenerateSetOperation(exprOpCodes.setOpCode, setSize);
                     simple1Type = exprBoolean;
                     handled     = true;
                   }
@@ -3744,7 +3871,8 @@ exprType_t pas_Expression(exprType_t findExprType, symbol_t *typePtr)
                          */
 
                          pas_GenerateSimple(opDUP);
-                         pas_GenerateSetOperation(exprOpCodes.setOpCode);
+                         pas_GenerateSetOperation(exprOpCodes.setOpCode,
+                                                  setSize);
                          simple1Type = exprBoolean;
                          handled     = true;
                       }
@@ -3759,13 +3887,19 @@ exprType_t pas_Expression(exprType_t findExprType, symbol_t *typePtr)
                         subRangePtr = subRangePtr->sParm.t.tParent;
                       }
 
-                    if (subRangePtr->sParm.t.tType != sSUBRANGE)
+                    if (subRangePtr->sParm.t.tType != sSUBRANGE &&
+                        subRangePtr->sParm.t.tType != sCHAR)
                       {
                         error(eHUH);
                       }
                     else
                       {
-                        uint16_t baseType = subRangePtr->sParm.t.tSubType;
+                        uint16_t baseType = subRangePtr->sParm.t.tType;
+
+                        if (baseType == sSUBRANGE)
+                          {
+                            baseType = subRangePtr->sParm.t.tSubType;
+                          }
 
                         if (simple1Type != pas_MapVariable2ExprType(baseType, true))
                           {
@@ -3782,7 +3916,8 @@ exprType_t pas_Expression(exprType_t findExprType, symbol_t *typePtr)
 
                             /* Then generate the set operation */
 
-                            pas_GenerateSetOperation(exprOpCodes.setOpCode);
+                            pas_GenerateSetOperation(exprOpCodes.setOpCode,
+                                                     setSize);
                             simple1Type = exprBoolean;
                             handled     = true;
                           }
@@ -4597,3 +4732,37 @@ symbol_t *pas_GetBaseTypePointer(symbol_t *typePtr)
 
   return baseTypePtr;
 }
+
+/****************************************************************************/
+/* The size in bytes of a SET.  typePtr may be the SET type, an array of
+ * SETs, or the ordinal type that the SET is a set of.  The empty set has no
+ * type; it has the size of the smallest SET.
+ */
+
+uint16_t pas_SetSize(symbol_t *typePtr)
+{
+  int32_t nObjects;
+
+  if (typePtr == NULL)
+    {
+      return sSET_SIZE;
+    }
+
+  if (typePtr->sParm.t.tType == sARRAY)
+    {
+      typePtr = typePtr->sParm.t.tParent;
+    }
+
+  if (typePtr->sParm.t.tType == sSET)
+    {
+      return typePtr->sParm.t.tAllocSize;
+    }
+
+  nObjects = typePtr->sParm.t.tMaxValue - typePtr->sParm.t.tMinValue + 1;
+  if (nObjects < 1 || nObjects > sSET_MAXELEM)
+    {
+      nObjects = sSET_MAXELEM;
+    }
+
+  return SET_ALLOCSIZE(nObjects);
+}
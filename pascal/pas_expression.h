@@ -167,7 +167,7 @@ extern double   g_constantReal;
 extern char    *g_constantStart;
 extern uint32_t g_constantStrOffset;
 extern int      g_constantStrLen;
-extern uint16_t g_constantSet[sSET_WORDS];
+extern uint16_t g_constantSet[sSET_MAXWORDS];
 
 /* The abstract types - SETs, RECORDS, etc - require an exact
  * match in type.  This variable points to the symbol table
@@ -190,6 +190,7 @@ exprType_t pas_GetExpressionType(symbol_t *sType);
 exprType_t pas_MapVariable2ExprType(uint16_t varType, bool ordinal);
 exprType_t pas_MapVariable2ExprPtrType(uint16_t varType, bool ordinal);
 symbol_t  *pas_GetBaseTypePointer(symbol_t *typePtr);
+uint16_t   pas_SetSize(symbol_t *typePtr);
 void       pas_ConstantExpression(exprType_t findExprType, symbol_t *typePtr);
 
 #endif /* __PAS_EXPRESSION_H */
@@ -406,12 +406,18 @@ static void pas_SetInitialValues(void)
                 break;
 
               case sSET :
-                pas_GenerateDataOperation(opPUSH, initializer->v.value.iSet[0]);
-                pas_GenerateDataOperation(opPUSH, initializer->v.value.iSet[1]);
-                pas_GenerateDataOperation(opPUSH, initializer->v.value.iSet[2]);
-                pas_GenerateDataOperation(opPUSH, initializer->v.value.iSet[3]);
-                pas_GenerateDataOperation(opPUSH, sSET_SIZE);
-                pas_GenerateStackReference(opSTSM, varPtr);
+                {
+                  int i;
+
+                  for (i = 0; i < varPtr->sParm.v.vSize / sINT_SIZE; i++)
+                    {
+                      pas_GenerateDataOperation(opPUSH,
+                                                initializer->v.value.iSet[i]);
+                    }
+
+                  pas_GenerateDataOperation(opPUSH, varPtr->sParm.v.vSize);
+                  pas_GenerateStackReference(opSTSM, varPtr);
+                }
                 break;
 
               case sPOINTER :
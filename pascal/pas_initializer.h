@@ -50,7 +50,7 @@ union varInitValue_u
   uint32_t iRoOffset;        /* Offset to read-only string */
   uint16_t iPointer;         /* Pointer value (NIL) */
   uint32_t iLongInt;         /* Long integer */
-  uint16_t iSet[sSET_WORDS]; /* Set value */
+  uint16_t iSet[sSET_MAXWORDS]; /* Set value */
   uint16_t iAltAccess[4];    /* Alternative access to large values */
 };
 
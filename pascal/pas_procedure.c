@@ -110,6 +110,7 @@ static void     pas_OpenFileProc(uint16_t opcode1,  /* Open file */
                   uint16_t opcode2);
 static void     pas_FileProc(uint16_t opcode);      /* File procedure with 1 arg */
 static void     pas_SeekProc(void);                 /* Change position in file */
+static void     pas_BlockIoProc(uint16_t opcode);   /* BLOCKREAD/BLOCKWRITE */
 static void     pas_AssignFileProc(void);           /* ASSIGNFILE procedure */
 static void     pas_WriteProc(void);                /* WRITE procedure */
 static void     pas_WritelnProc(void);              /* WRITELN procedure */
@@ -121,6 +122,7 @@ static void     pas_WriteBinary(uint16_t fileSize); /* WRITE binary file */
 static void     pas_DirectoryProc(uint16_t opCode); /* Change|Create working directory */
 static void     pas_NewProc(void);                  /* Memory allocator */
 static void     pas_DisposeProc(void);              /* Free memory */
+static void     pas_SetProc(enum pcode_e opcode);   /* INCLUDE/EXCLUDE in place */
 
 static uint16_t pas_GenVarFileNumber(symbol_t *varPtr,
                   uint16_t *pFileSize,
@@ -924,6 +926,105 @@ static void pas_SeekProc(void)
 
 /****************************************************************************/
 
+static void pas_BlockIoProc(uint16_t opcode)
+{
+  symbol_t *parent;
+  uint16_t fileType;
+  uint16_t fileSize   = 0;
+  uint16_t bufferSize = 0;
+
+  /* FORM: procedure BlockRead(var f : file of t; var buf; count : integer
+   *                           [; var result : integer]);
+   * FORM: procedure BlockWrite(var f : file of t; var buf; count : integer
+   *                            [; var result : integer]);
+   *
+   * Transfers up to 'count' records between the typed file and the
+   * variable 'buf' in one run-time call.  'buf' is normally an ARRAY OF t.
+   * The optional 'result' receives the number of records transferred.
+   */
+
+  getToken();                          /* Skip over BLOCKREAD/BLOCKWRITE */
+  if (g_token != '(') error(eLPAREN);  /* Skip over '(' */
+  else getToken();
+
+  /* TOS(4) = File number.  Block I/O requires a typed file. */
+
+  fileType = pas_GenerateFileNumber(&fileSize, NULL);
+  if (fileType != sFILE || fileSize == 0) error(eINVFILE);
+
+  if (g_token != ',') error(eCOMMA);
+  else getToken();
+
+  /* TOS(3) = Record size */
+
+  pas_GenerateDataOperation(opPUSH, fileSize);
+
+  /* TOS(2) = Buffer address and TOS(1) = Buffer size */
+
+  switch (g_token)
+    {
+      case sARRAY :
+      case sRECORD :
+        bufferSize = g_tknPtr->sParm.v.vSize;
+        pas_GenerateStackReference(opLAS, g_tknPtr);
+        break;
+
+      /* VAR parameter.  The variable holds the address of the buffer. */
+
+      case sVAR_PARM :
+        parent     = g_tknPtr->sParm.v.vParent;
+        bufferSize = parent->sParm.t.tAllocSize;
+        pas_GenerateStackReference(opLDS, g_tknPtr);
+        break;
+
+      default :
+        error(eINVARG);
+        break;
+    }
+
+  pas_GenerateDataOperation(opPUSH, bufferSize);
+  getToken();                          /* Skip over the buffer */
+
+  if (g_token != ',') error(eCOMMA);
+  else getToken();
+
+  /* TOS(0) = Number of records to transfer */
+
+  pas_Expression(exprInteger, NULL);
+
+  /* Generate the I/O operation.  It leaves the number of records
+   * transferred on the stack.
+   */
+
+  pas_GenerateIoOperation(opcode);
+
+  /* Save the count in the optional result variable or discard it */
+
+  if (g_token == ',')
+    {
+      getToken();
+      if (g_token == sINT || g_token == sWORD)
+        {
+          pas_GenerateStackReference(opSTS, g_tknPtr);
+        }
+      else
+        {
+          error(eINVARG);
+        }
+
+      getToken();
+    }
+  else
+    {
+      pas_GenerateDataOperation(opINDS, -sINT_SIZE);
+    }
+
+  if (g_token != ')') error(eRPAREN);
+  else getToken();
+}
+
+/****************************************************************************/
+
 static void pas_AssignFileProc(void)  /* ASSIGNFILE procedure */
 {
   exprType_t exprType;
@@ -1660,6 +1761,82 @@ static void pas_DisposeProc(void)
   else getToken();
 }
 
+/****************************************************************************/
+
+static void pas_SetProc(enum pcode_e opcode)
+{
+  exprType_t memberExprType;
+  symbol_t  *setTypePtr;
+  symbol_t  *baseTypePtr;
+  uint16_t   baseType;
+
+  /* FORM: 'include' | 'exclude' '(' set-variable ',' set-member ')'
+   *
+   * Used as a procedure, INCLUDE and EXCLUDE modify the set variable in
+   * place.  The function forms (see pas_SetFunc()) operate on a copy of the
+   * set value on the stack.
+   */
+
+  getToken();
+  if (g_token != '(') error(eLPAREN);  /* Skip over '(' */
+  else getToken();
+
+  /* Get the address of the SET variable.  This has the side-effect of
+   * setting g_abstractTypePtr to the type of the SET.
+   */
+
+  pas_VarParameter(exprSetPtr, NULL);
+  setTypePtr = g_abstractTypePtr;
+  if (setTypePtr == NULL)
+    {
+      error(eSET);
+      return;
+    }
+
+  /* Verify the presence of the comma separating the parameters */
+
+  if (g_token != ',') error(eCOMMA);
+  else getToken();
+
+  /* The base type is probably a SET.  So we will need the child subrange
+   * which will tell us the "Subrange of what?"
+   */
+
+  baseTypePtr = pas_GetBaseTypePointer(setTypePtr);
+  baseType    = baseTypePtr->sParm.t.tType;
+
+  if (baseType == sSET)
+    {
+      baseTypePtr = baseTypePtr->sParm.t.tParent;
+      baseType    = baseTypePtr->sParm.t.tType;
+    }
+
+  if (baseType == sSUBRANGE)
+    {
+      baseType  = baseTypePtr->sParm.t.tSubType;
+    }
+
+  /* The set-member argument should then be a value of that type */
+
+  memberExprType = pas_MapVariable2ExprType(baseType, true);
+  pas_Expression(memberExprType, setTypePtr);
+
+  /* Make the set-member value zero base */
+
+  if (baseTypePtr->sParm.t.tMinValue != 0)
+    {
+      pas_GenerateDataOperation(opPUSH, baseTypePtr->sParm.t.tMinValue);
+      pas_GenerateSimple(opSUB);
+    }
+
+  /* Then set or clear the member's bit in the set variable */
+
+  pas_GenerateSetBitOperation(opcode, pas_SetSize(setTypePtr));
+
+  if (g_token != ')') error(eRPAREN);  /* Skip over ')' */
+  else getToken();
+}
+
 /****************************************************************************/
 /* The VAR file parameter is more complex than the "normal" file variable
  * because the transfer unit size is more difficult to find.
@@ -2039,6 +2216,7 @@ static void pas_FillCharProc(void)
 static void pas_ValProc(void)  /* VAL procedure */
 {
   exprType_t exprType;
+  uint16_t   valOpcode = lbVAL;
 
   /* Declaration:
    *   procedure val(const S : string; var V; var Code : word);
@@ -2082,14 +2260,19 @@ static void pas_ValProc(void)  /* VAL procedure */
    * variable.
    */
 
-  if (g_token == sLONGINT || g_token == sSHORTINT || g_token == sREAL)
+  if (g_token == sLONGINT || g_token == sSHORTINT)
     {
-      /* Long/ShortInteger and Real not yet supported. */
+      /* Long/ShortInteger not yet supported. */
 
       error(eNOTYET);
     }
-  else if (g_token == sINT)
+  else if (g_token == sINT || g_token == sREAL)
     {
+      if (g_token == sREAL)
+        {
+          valOpcode = lbVALREAL;
+        }
+
       pas_GenerateStackReference(opLAS, g_tknPtr);
     }
   else
@@ -2123,7 +2306,7 @@ static void pas_ValProc(void)  /* VAL procedure */
    * having to generate the INDS here.
    */
 
-  pas_StringLibraryCall(lbVAL);
+  pas_StringLibraryCall(valOpcode);
 }
 
 /****************************************************************************/
@@ -2400,6 +2583,14 @@ void pas_StandardProcedure(void)
           pas_SeekProc();
           break;
 
+        case txBLOCKREAD :
+          pas_BlockIoProc(xBLOCKREAD);
+          break;
+
+        case txBLOCKWRITE :
+          pas_BlockIoProc(xBLOCKWRITE);
+          break;
+
            /* Memory alloctor */
 
         case txNEW :
@@ -2505,6 +2696,28 @@ void pas_StandardProcedure(void)
           break;
         }
     }
+
+  /* INCLUDE and EXCLUDE are standard functions, but may also be called as
+   * procedures to modify a set variable in place.
+   */
+
+  else if (g_token == tSTDFUNC)
+    {
+      switch (g_tknSubType)
+        {
+        case txINCLUDE :
+          pas_SetProc(opSETINCL);
+          break;
+
+        case txEXCLUDE :
+          pas_SetProc(opSETEXCL);
+          break;
+
+        default :
+          error(eINVALIDPROC);
+          break;
+        }
+    }
 }
 
 /***********************************************************************/
@@ -2575,7 +2788,7 @@ int pas_ActualParameterSize(symbol_t *procPtr, int parmNo)
       return INT_ALIGNUP(sREAL_SIZE);
 
     case sSET :
-      return INT_ALIGNUP(sSET_SIZE);
+      return INT_ALIGNUP(baseTypePtr->sParm.t.tAllocSize);
 
     case sSTRING :
       return INT_ALIGNUP(sSTRING_SIZE);
@@ -2754,7 +2967,7 @@ int pas_ActualParameterList(symbol_t *procPtr)
 
             case sSET :
               pas_Expression(exprSet, typePtr);
-              size += INT_ALIGNUP(sSET_SIZE);
+              size += INT_ALIGNUP(pas_SetSize(typePtr));
               break;
 
             case sARRAY :
@@ -409,9 +409,8 @@ static void pas_FilePosFunc(uint16_t opCode)
 
   /* Push the file number argument on the stack */
 
-  getToken();
   fileType = pas_GenerateFileNumber(NULL, NULL);
-  if (fileType == sFILE)
+  if (fileType != sFILE)
     {
       /* These should not be used with TEXTFILE types */
 
@@ -435,6 +434,7 @@ static void pas_SetFunc(uint16_t setOpcode)
   exprType_t memberExprType;
   symbol_t  *baseTypePtr;
   uint16_t   baseType;
+  uint16_t   setSize;
 
   /* FORM: 'include' | 'exclude' '(' set-expression, set-member ')' */
 
@@ -445,6 +445,7 @@ static void pas_SetFunc(uint16_t setOpcode)
   /* Get the SET expression */
 
   pas_Expression(exprSet, NULL);
+  setSize = pas_SetSize(g_abstractTypePtr);
 
   /* Verify the presence of the comma separating the parameters */
 
@@ -489,7 +490,7 @@ static void pas_SetFunc(uint16_t setOpcode)
 
   /* Now we can generate the set operation */
 
-  pas_GenerateSetOperation(setOpcode);
+  pas_GenerateSetOperation(setOpcode, setSize);
 
   /* Assure that the parameter list terminates with a right parenthesis. */
 
@@ -512,7 +513,7 @@ static void pas_CardFunc(void)
 
   /* Now we can generate the set operation */
 
-  pas_GenerateSetOperation(setCARD);
+  pas_GenerateSetOperation(setCARD, pas_SetSize(g_abstractTypePtr));
 
   /* Assure that the parameter list terminates with a right parenthesis. */
 
@@ -655,7 +656,7 @@ static void pas_PosFunc(void)
 static void pas_ConcatFunc(void)
 {
   exprType_t exprType;
-  uint16_t opCode;
+  uint16_t nStrings;
 
   /* FORM: 'concat' '(' string-list')'
    *       string-list = string-expression [',' string-list ]
@@ -665,28 +666,23 @@ static void pas_ConcatFunc(void)
 
   pas_CheckLParen();
 
-  /* Create an empty standard string to catch the result of the concatenation */
+  /* Leave each string on the stack, then concatenate them all with a
+   * single library call.
+   */
 
-  pas_StringLibraryCall(lbSTRTMP);
+  nStrings = 0;
 
   for (; ; )
     {
       /* Get the next string expression */
 
       exprType = pas_Expression(exprString, NULL);
-
-      /* Concatenate this string to the temporary stack string */
-
-      if (exprType == exprString)
-        {
-          opCode = lbSTRCAT;
-        }
-      else
+      if (exprType != exprString)
         {
           error(eEXPRTYPE);
         }
 
-      pas_StringLibraryCall(opCode);
+      nStrings++;
 
       /* A comma following the string means that there is another string to
        * be concatenated.  Continue looping.
@@ -694,8 +690,24 @@ static void pas_ConcatFunc(void)
 
       if (g_token != ',') break;
       else getToken();
+
+      /* If the library call cannot take any more strings, concatenate what
+       * we have so far.  The result is the first string of the next group.
+       */
+
+      if (nStrings >= MAX_STRCATN)
+        {
+          pas_GenerateDataOperation(opPUSH, 0);
+          pas_GenerateDataOperation(opPUSH, nStrings);
+          pas_StringLibraryCall(lbSTRCATN);
+          nStrings = 1;
+        }
     }
 
+  pas_GenerateDataOperation(opPUSH, 0);
+  pas_GenerateDataOperation(opPUSH, nStrings);
+  pas_StringLibraryCall(lbSTRCATN);
+
   /* Assure that the parameter list terminates with a right parenthesis. */
 
   pas_CheckRParen();
@@ -112,6 +112,8 @@ static const reservedWord_t g_rsw[] =                /* Reserved word list */
   {"ARRAY",          tARRAY,          txNONE},       /* (1) */
   {"ASSIGNFILE",     tSTDPROC,        txASSIGNFILE}, /* (3) */
   {"BEGIN",          tBEGIN,          txNONE},       /* (1) */
+  {"BLOCKREAD",      tSTDPROC,        txBLOCKREAD},  /* (8) */
+  {"BLOCKWRITE",     tSTDPROC,        txBLOCKWRITE}, /* (8) */
   {"BREAK",          tSTDPROC,        txBREAK},      /* (3) */
   {"CARD",           tSTDFUNC,        txCARD},       /* (2) */
   {"CASE",           tCASE,           txNONE},       /* (1) */
@@ -279,4 +279,9 @@
 #define txINSERT         0xb4
 #define txDELETE         0xb5
 
+/* Block file I/O */
+
+#define txBLOCKREAD      0xb6
+#define txBLOCKWRITE     0xb7
+
 #endif /* __PAS_TKNDEFS_H */
@@ -47,6 +47,7 @@
 #include "pas_defns.h"
 #include "pas_tkndefs.h"
 #include "pas_errcodes.h"
+#include "paslib.h"
 
 #include "pas_main.h"
 #include "pas_token.h"
@@ -494,12 +495,11 @@ static void pas_UnsignedRealNumber(void)
   else
     {
       /* There is no exponent...
-       * Terminate the real number string  and convert it to binay
-       * using sscanf.
+       * Terminate the real number string  and convert it to binary.
        */
 
       *g_stringSP++ = '\0';
-      (void) sscanf(g_tokenString, "%lf", &g_tknReal);
+      g_tknReal = pstrtod(g_tokenString, NULL);
     }
 
   /* Remove the number string from the character identifer stack */
@@ -575,12 +575,10 @@ static void pas_UnsignedExponent(void)
         }
       while (isdigit(g_inChar));
 
-      /* Terminate the real number string  and convert it to binay
-       * using sscanf.
-       */
+      /* Terminate the real number string  and convert it to binary. */
 
       *g_stringSP++ = '\0';
-      (void) sscanf(g_tokenString, "%lf", &g_tknReal);
+      g_tknReal = pstrtod(g_tokenString, NULL);
     }
 
   /* Remove the number string from the character identifer stack */
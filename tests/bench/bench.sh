@@ -0,0 +1,293 @@
+#!/bin/bash
+############################################################################
+# bench.sh
+#
+#   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+#   Author: Gregory Nutt <gnutt@nuttx.org>
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from
+#    this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+# Build and run the benchmark programs, measuring each tool of the
+# toolchain.  The results are written as CSV with one row per benchmark
+# and tool:
+#
+#   benchmark,tool,wall_s,user_s,maxrss_kb,instructions,ips,checksum,status
+#
+# wall_s and user_s are the least of the repeated runs and maxrss_kb is the
+# greatest.  instructions, ips (P-Code instructions per second of
+# execution) and checksum (the cksum of the program output) are reported
+# only for prun.  status is "ok" or the reason for a failure.
+
+BENCHDIR=$(cd $(dirname ${0}) && pwd)
+PBINDIR=${BENCHDIR}/../../bin16
+PUNITDIR=${BENCHDIR}/../../papps/punits
+
+PASCAL=${PBINDIR}/pascal
+POPT=${PBINDIR}/popt
+PLINK=${PBINDIR}/plink
+PRUN=${PBINDIR}/prun
+BENCHTIME=${BENCHDIR}/benchtime
+
+# Number of procedures in the generated program 'large'.  This is about the
+# most that will fit in the 64KiB I-Space.
+
+LARGE_NPROCS=200
+
+# Tell them how they are supposed to use this script
+
+function show_usage ()
+{
+    echo "USAGE:"
+    echo "  ${0} [OPTIONS] [<benchmark> ...]"
+    echo "OPTIONS:"
+    echo "  -r <n>:        Run each tool <n> times (default: 3)"
+    echo "  -o <csv-file>: Write the results to <csv-file> (default: stdout)"
+    echo "  -c <csv-file>: Compare the results with an earlier <csv-file>"
+    echo "  -h:            Show this text"
+    echo "The default is to run all benchmarks:"
+    echo "  ${ALLBENCH}"
+    exit 1
+}
+
+# Run one tool, appending one line of measurements to ${TIMEFILE}
+
+function measure ()
+{
+  ${BENCHTIME} -o ${TIMEFILE} "$@"
+}
+
+# Summarize the measurements in ${TIMEFILE}: least wall and user time,
+# greatest memory use, and the status of the last run that failed.
+
+function summarize ()
+{
+  sed -e 's/[a-z_]*=//g' ${TIMEFILE} | awk '
+    NR == 1 || $1 < wall { wall = $1 }
+    NR == 1 || $2 < user { user = $2 }
+    $4 > rss             { rss = $4 }
+    $5 != 0              { status = $5 }
+    END { printf "%.6f,%.6f,%d,%s", wall, user, rss, status }'
+}
+
+# Report the results of one tool
+
+function report ()
+{
+  local tool=${1}
+  local insns=${2}
+  local ips=${3}
+  local status=${4}
+  local checksum=${5}
+  local summary=$(summarize)
+  local exitcode=${summary##*,}
+
+  if [ -z "${status}" ]; then
+    if [ -n "${exitcode}" ]; then
+      status="exit ${exitcode}"
+    else
+      status=ok
+    fi
+  fi
+
+  echo "${BENCH},${tool},${summary%,*},${insns},${ips},${checksum},${status}" >>${CSVFILE}
+  rm -f ${TIMEFILE}
+}
+
+# Build and run one benchmark
+
+function run_bench ()
+{
+  local PRUNOPTS=""
+  local stats
+  local insns
+  local ips
+  local line
+  local status
+  local checksum
+  local n
+
+  echo "  ${BENCH}" 1>&2
+
+  # The program 'large' is generated
+
+  if [ "${BENCH}" == "large" ]; then
+    ${BENCHDIR}/gensource.sh ${LARGE_NPROCS} large >large.pas
+  fi
+
+  if [ ! -f ${BENCH}.pas ]; then
+    echo "${BENCH},pascal,,,,,,,no source" >>${CSVFILE}
+    return
+  fi
+
+  # Compile, optimize, and link
+
+  for n in $(seq ${REPEAT}); do
+    rm -f ${BENCH}.o1 ${BENCH}.err
+    measure ${PASCAL} -I. -I${PUNITDIR} ${BENCH}.pas >/dev/null 2>&1
+  done
+
+  if [ -f ${BENCH}.o1 ]; then report pascal; else report pascal "" "" failed; return; fi
+
+  for n in $(seq ${REPEAT}); do
+    rm -f ${BENCH}.o
+    measure ${POPT} ${BENCH}.o1 >/dev/null 2>&1
+  done
+
+  if [ -f ${BENCH}.o ]; then report popt; else report popt "" "" failed; return; fi
+
+  for n in $(seq ${REPEAT}); do
+    rm -f ${BENCH}.pex
+    measure ${PLINK} ${BENCH}.o ${BENCH}.pex >/dev/null 2>&1
+  done
+
+  if [ -f ${BENCH}.pex ]; then report plink; else report plink "" "" failed; return; fi
+
+  # See if this benchmark requires special options
+
+  if [ -f ${BENCH}.opt ]; then
+    line=$(grep "^T " ${BENCH}.opt)
+    if [ -n "${line}" ]; then PRUNOPTS="${PRUNOPTS} -t ${line#T }"; fi
+    line=$(grep "^N " ${BENCH}.opt)
+    if [ -n "${line}" ]; then PRUNOPTS="${PRUNOPTS} -n ${line#N }"; fi
+    line=$(grep "^S " ${BENCH}.opt)
+    if [ -n "${line}" ]; then PRUNOPTS="${PRUNOPTS} -s ${line#S }"; fi
+  fi
+
+  # Execute.  prun reports the instruction count and the rate on stderr.
+
+  ips=0
+  for n in $(seq ${REPEAT}); do
+    measure ${PRUN} -x ${PRUNOPTS} ${BENCH}.pex >${BENCH}.out 2>${BENCH}.stats
+    stats=$(grep "^prun:" ${BENCH}.stats)
+    insns=$(echo "${stats}" | sed -n -e 's/.*instructions=\([0-9]*\).*/\1/p')
+    line=$(echo "${stats}" | sed -n -e 's/.*ips=\([0-9]*\).*/\1/p')
+    if [ -n "${line}" ] && [ "${line}" -gt "${ips}" ]; then ips=${line}; fi
+  done
+
+  rm -f ${BENCH}.stats
+  status=$(grep "^Runtime error" ${BENCH}.out)
+  checksum=$(cksum <${BENCH}.out | cut -d' ' -f1)
+  report prun "${insns}" "${ips}" "${status}" "${checksum}"
+}
+
+# Compare the results with a baseline.  A program whose output differs
+# from the baseline is flagged and makes the comparison fail.
+
+function compare ()
+{
+  echo "" 1>&2
+  echo "Wall time compared with ${BASEFILE}:" 1>&2
+  awk -F, '
+    FNR == 1 { next }
+    NR == FNR { base[$1 "," $2] = $3; sum[$1 "," $2] = $8; next }
+    ($1 "," $2) in base && base[$1 "," $2] > 0 && $3 > 0 {
+      flag = ""
+      if (sum[$1 "," $2] != $8) { flag = "  OUTPUT DIFFERS"; bad = 1 }
+      printf "  %-12s %-7s %10.6f %10.6f %7.2fx%s\n",
+             $1, $2, base[$1 "," $2], $3, base[$1 "," $2] / $3, flag
+    }
+    END { exit bad }' ${BASEFILE} ${CSVFILE} 1>&2
+}
+
+# Parse command line
+
+ALLBENCH="intloop recursion realmath longint sets strings heap textio fileio large"
+REPEAT=3
+OUTFILE=
+BASEFILE=
+BENCHLIST=
+
+while [ -n "${1}" ]; do
+    case "${1}" in
+    -r )
+        REPEAT=${2}
+        shift
+        ;;
+    -o )
+        OUTFILE=${2}
+        shift
+        ;;
+    -c )
+        BASEFILE=${2}
+        shift
+        ;;
+    -h )
+        show_usage
+        ;;
+    -* )
+        echo "ERROR: Unrecognized option: ${1}"
+        show_usage
+        ;;
+    * )
+        BENCHLIST="${BENCHLIST} ${1}"
+        ;;
+    esac
+    shift
+done
+
+if [ -z "${BENCHLIST}" ]; then
+  BENCHLIST=${ALLBENCH}
+fi
+
+if [ ! -x ${PRUN} ]; then
+  echo "ERROR: ${PRUN} does not exist.  Build the toolchain first."
+  exit 1
+fi
+
+if [ ! -x ${BENCHTIME} ]; then
+  make -C ${BENCHDIR} benchtime || exit 1
+fi
+
+# Run the benchmarks in this directory
+
+cd ${BENCHDIR} || exit 1
+
+TIMEFILE=$(mktemp)
+CSVFILE=$(mktemp)
+rm -f ${TIMEFILE}
+
+echo "benchmark,tool,wall_s,user_s,maxrss_kb,instructions,ips,checksum,status" >${CSVFILE}
+echo "Running benchmarks:" 1>&2
+
+for BENCH in ${BENCHLIST}; do
+  run_bench
+done
+
+RESULT=0
+if [ -n "${BASEFILE}" ]; then
+  compare || RESULT=1
+fi
+
+if [ -n "${OUTFILE}" ]; then
+  cp ${CSVFILE} ${OUTFILE}
+else
+  cat ${CSVFILE}
+fi
+
+rm -f ${CSVFILE} ${TIMEFILE}
+exit ${RESULT}
@@ -0,0 +1,167 @@
+/****************************************************************************
+ * benchtime.c
+ * Run a command and report its wall time, CPU time, and peak memory use
+ *
+ *   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: benchtime_ShowUsage
+ ****************************************************************************/
+
+static void benchtime_ShowUsage(const char *progname)
+{
+  fprintf(stderr, "USAGE:\n");
+  fprintf(stderr, "  %s [-o <file>] <command> [<argument> ...]\n", progname);
+  fprintf(stderr, "Run <command> and then append one line to <file> (or\n");
+  fprintf(stderr, "write it to stderr):\n");
+  fprintf(stderr, "  wall=<s> user=<s> sys=<s> maxrss_kb=<n> status=<n>\n");
+  fprintf(stderr, "The status is the exit code of the command, or 128 plus\n");
+  fprintf(stderr, "the signal number if it was killed by a signal.\n");
+  exit(1);
+}
+
+/****************************************************************************
+ * Name: benchtime_Seconds
+ ****************************************************************************/
+
+static double benchtime_Seconds(const struct timeval *tv)
+{
+  return (double)tv->tv_sec + (double)tv->tv_usec / 1.0e6;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  struct timespec begin;
+  struct timespec end;
+  struct rusage usage;
+  const char *outName = NULL;
+  FILE *out;
+  double wall;
+  pid_t pid;
+  int status;
+  int argn = 1;
+
+  if (argn + 1 < argc && strcmp(argv[argn], "-o") == 0)
+    {
+      outName = argv[argn + 1];
+      argn   += 2;
+    }
+
+  if (argn >= argc || argv[argn][0] == '-')
+    {
+      benchtime_ShowUsage(argv[0]);
+    }
+
+  /* Run the command */
+
+  clock_gettime(CLOCK_MONOTONIC, &begin);
+
+  pid = fork();
+  if (pid < 0)
+    {
+      perror("ERROR: fork failed");
+      return 1;
+    }
+  else if (pid == 0)
+    {
+      execvp(argv[argn], &argv[argn]);
+      fprintf(stderr, "ERROR: Failed to execute %s\n", argv[argn]);
+      _exit(127);
+    }
+
+  if (wait4(pid, &status, 0, &usage) < 0)
+    {
+      perror("ERROR: wait4 failed");
+      return 1;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  wall = (double)(end.tv_sec - begin.tv_sec) +
+         (double)(end.tv_nsec - begin.tv_nsec) / 1.0e9;
+
+  if (WIFEXITED(status))
+    {
+      status = WEXITSTATUS(status);
+    }
+  else if (WIFSIGNALED(status))
+    {
+      status = 128 + WTERMSIG(status);
+    }
+
+  /* Report the measurements */
+
+  out = stderr;
+  if (outName != NULL)
+    {
+      out = fopen(outName, "a");
+      if (out == NULL)
+        {
+          fprintf(stderr, "ERROR: Could not open %s\n", outName);
+          return 1;
+        }
+    }
+
+  fprintf(out, "wall=%.6f user=%.6f sys=%.6f maxrss_kb=%ld status=%d\n",
+          wall, benchtime_Seconds(&usage.ru_utime),
+          benchtime_Seconds(&usage.ru_stime), (long)usage.ru_maxrss, status);
+
+  if (out != stderr)
+    {
+      fclose(out);
+    }
+
+  return status;
+}
@@ -0,0 +1,44 @@
+{ Binary file I/O:  Write records to a typed file and read them back. }
+
+PROGRAM FileIO;
+
+TYPE
+  rec = RECORD
+          id    : INTEGER;
+          value : INTEGER;
+          name  : PACKED ARRAY[1..16] OF CHAR
+        END;
+
+VAR
+  f        : FILE OF rec;
+  r        : rec;
+  i, j     : INTEGER;
+  sum      : INTEGER;
+
+BEGIN
+  sum    := 0;
+  r.name := 'Benchmark record';
+  ASSIGN(f, 'fileio.dat');
+
+  FOR j := 1 TO 200 DO
+  BEGIN
+    REWRITE(f);
+    FOR i := 1 TO 500 DO
+    BEGIN
+      r.id    := i;
+      r.value := (i * 7 + j) MOD 1000;
+      WRITE(f, r)
+    END;
+    CLOSE(f);
+
+    RESET(f);
+    WHILE NOT EOF(f) DO
+    BEGIN
+      READ(f, r);
+      sum := (sum + r.value) MOD 10000
+    END;
+    CLOSE(f)
+  END;
+
+  WRITELN('Sum: ', sum)
+END.
@@ -0,0 +1,101 @@
+#!/bin/bash
+############################################################################
+# gensource.sh
+#
+#   Copyright (C) 2026 Gregory Nutt. All rights reserved.
+#   Author: Gregory Nutt <gnutt@nuttx.org>
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+#    contributors may be used to endorse or promote products derived from
+#    this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+#
+# Generate a large Pascal program to measure the throughput of the
+# compiler, optimizer, and linker.  The program has <nprocs> procedures,
+# each with a few local variables, a loop, a CASE statement, and some
+# expressions.
+#
+#   USAGE:  gensource.sh <nprocs> <program-name>
+#
+# The program is written to stdout.
+
+if [ $# -ne 2 ]; then
+  echo "USAGE: ${0} <nprocs> <program-name>" 1>&2
+  exit 1
+fi
+
+NPROCS=${1}
+PROGNAME=${2}
+
+echo "{ Generated by gensource.sh with ${NPROCS} procedures }"
+echo ""
+echo "PROGRAM ${PROGNAME};"
+echo ""
+echo "VAR"
+echo "  total : INTEGER;"
+echo "  table : ARRAY[0..15] OF INTEGER;"
+
+n=1
+while [ ${n} -le ${NPROCS} ]; do
+  cat <<EOP
+
+PROCEDURE Proc${n}(arg : INTEGER);
+VAR
+  i, a, b : INTEGER;
+BEGIN
+  a := arg * ${n} + 3;
+  b := (a MOD 17) + ${n};
+  FOR i := 0 TO 15 DO
+  BEGIN
+    table[i] := table[i] + (a + i) DIV (b + 1);
+    IF table[i] > 1000 THEN
+      table[i] := table[i] - 1000
+  END;
+  CASE a MOD 4 OF
+    0 : total := total + a;
+    1 : total := total - b;
+    2 : total := total + a * 2 - b;
+    3 : total := total + 1
+  END;
+  WHILE b > 0 DO
+    b := b - 7;
+  total := total MOD 10000
+END;
+EOP
+  n=$((n + 1))
+done
+
+echo ""
+echo "BEGIN"
+echo "  total := 0;"
+n=1
+while [ ${n} -le ${NPROCS} ]; do
+  echo "  Proc${n}(${n});"
+  n=$((n + 1))
+done
+echo "  WRITELN('Total: ', total)"
+echo "END."
@@ -0,0 +1,113 @@
+{ Heap churn:  Linked lists and binary search trees built with NEW and
+  released with DISPOSE. }
+
+PROGRAM HeapChurn;
+
+TYPE
+  nodeptr = ^node;
+  node    = RECORD
+              left  : nodeptr;
+              right : nodeptr;
+              key   : INTEGER
+            END;
+
+VAR
+  root, list, p : nodeptr;
+  i, j, count   : INTEGER;
+
+PROCEDURE AddKey(key : INTEGER);
+VAR
+  p, parent : nodeptr;
+BEGIN
+  NEW(p);
+  p^.left  := NIL;
+  p^.right := NIL;
+  p^.key   := key;
+
+  IF root = NIL THEN
+    root := p
+  ELSE
+  BEGIN
+    parent := root;
+    WHILE parent <> NIL DO
+      IF key < parent^.key THEN
+      BEGIN
+        IF parent^.left = NIL THEN
+        BEGIN
+          parent^.left := p;
+          parent := NIL
+        END
+        ELSE
+          parent := parent^.left
+      END
+      ELSE
+      BEGIN
+        IF parent^.right = NIL THEN
+        BEGIN
+          parent^.right := p;
+          parent := NIL
+        END
+        ELSE
+          parent := parent^.right
+      END
+  END
+END;
+
+PROCEDURE FreeTree;
+VAR
+  p : nodeptr;
+BEGIN
+  { Rotate left children up so that the tree can be freed as a list }
+
+  WHILE root <> NIL DO
+    IF root^.left = NIL THEN
+    BEGIN
+      p    := root;
+      root := root^.right;
+      count := (count + p^.key) MOD 10000;
+      DISPOSE(p)
+    END
+    ELSE
+    BEGIN
+      p           := root^.left;
+      root^.left  := p^.right;
+      p^.right    := root;
+      root        := p
+    END
+END;
+
+BEGIN
+  count := 0;
+
+  FOR j := 1 TO 1000 DO
+  BEGIN
+    { Build and release a list }
+
+    list := NIL;
+    FOR i := 1 TO 100 DO
+    BEGIN
+      NEW(p);
+      p^.left := list;
+      p^.key  := i;
+      list    := p
+    END;
+
+    WHILE list <> NIL DO
+    BEGIN
+      p    := list;
+      list := list^.left;
+      count := (count + p^.key) MOD 10000;
+      DISPOSE(p)
+    END;
+
+    { Build and release a tree }
+
+    root := NIL;
+    FOR i := 1 TO 100 DO
+      AddKey((i * 37 + j) MOD 101);
+
+    FreeTree
+  END;
+
+  WRITELN('Nodes: ', count)
+END.
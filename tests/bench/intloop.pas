@@ -0,0 +1,47 @@
+{ Integer loops:  Array indexing, arithmetic, and comparisons in tight
+  FOR and WHILE loops, including a sieve of Eratosthenes. }
+
+PROGRAM IntLoop;
+
+CONST
+  size = 1000;
+
+VAR
+  flags : ARRAY[0..size] OF BOOLEAN;
+  a     : ARRAY[0..99] OF INTEGER;
+  i, k, iter, count, prime, sum : INTEGER;
+
+BEGIN
+  { Sieve of Eratosthenes }
+
+  FOR iter := 1 TO 1000 DO
+  BEGIN
+    count := 0;
+    FOR i := 0 TO size DO flags[i] := TRUE;
+    FOR i := 0 TO size DO
+      IF flags[i] THEN
+      BEGIN
+        prime := i + i + 3;
+        k := i + prime;
+        WHILE k <= size DO
+        BEGIN
+          flags[k] := FALSE;
+          k := k + prime
+        END;
+        count := count + 1
+      END
+  END;
+
+  WRITELN('Primes: ', count);
+
+  { Array arithmetic }
+
+  sum := 0;
+  FOR iter := 1 TO 10000 DO
+  BEGIN
+    FOR i := 0 TO 99 DO a[i] := i * 3 + iter;
+    FOR i := 0 TO 99 DO sum := (sum + a[i] MOD 7) MOD 10000
+  END;
+
+  WRITELN('Sum: ', sum)
+END.
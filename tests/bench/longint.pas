@@ -0,0 +1,35 @@
+{ LONGINTEGER arithmetic:  A linear congruential generator and 32-bit
+  multiplication, division, and remainder. }
+
+PROGRAM LongArith;
+
+VAR
+  seed, sum, x           : LONGINTEGER;
+  mult, incr, modulus    : LONGINTEGER;
+  seven, thousand, prime : LONGINTEGER;
+  i, j                   : INTEGER;
+
+BEGIN
+  { The constants are kept in variables.  popt does not accept a
+    LONGINTEGER() constant within an expression. }
+
+  mult     := LONGINTEGER(1103);
+  incr     := LONGINTEGER(12345);
+  modulus  := LONGINTEGER(2147483647);
+  seven    := LONGINTEGER(7);
+  thousand := LONGINTEGER(1000);
+  prime    := LONGINTEGER(1000000007);
+
+  seed := incr;
+  sum  := LONGINTEGER(0);
+
+  FOR j := 1 TO 40 DO
+    FOR i := 1 TO 5000 DO
+    BEGIN
+      seed := (seed * mult + incr) MOD modulus;
+      x    := seed DIV seven + seed MOD thousand;
+      sum  := (sum + x) MOD prime
+    END;
+
+  WRITELN('Seed: ', seed, ' Sum: ', sum)
+END.
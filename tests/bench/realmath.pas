@@ -0,0 +1,36 @@
+{ REAL arithmetic:  Series summation, square roots, and transcendental
+  functions. }
+
+PROGRAM RealMath;
+
+VAR
+  i, j     : INTEGER;
+  x, sum   : REAL;
+  pi4, sgn : REAL;
+
+BEGIN
+  { Leibniz series for pi }
+
+  pi4 := 0.0;
+  sgn := 1.0;
+  FOR j := 0 TO 29 DO
+    FOR i := 0 TO 9999 DO
+    BEGIN
+      pi4 := pi4 + sgn / (2.0 * (j * 10000.0 + i) + 1.0);
+      sgn := -sgn
+    END;
+
+  WRITELN('Pi: ', 4.0 * pi4:12:8);
+
+  { Square roots and transcendentals }
+
+  sum := 0.0;
+  FOR j := 1 TO 20 DO
+    FOR i := 1 TO 2000 DO
+    BEGIN
+      x   := i / 100.0;
+      sum := sum + SQRT(x) + SIN(x) * COS(x) + LN(x) + EXP(-x) + ARCTAN(x)
+    END;
+
+  WRITELN('Sum: ', sum:16:6)
+END.
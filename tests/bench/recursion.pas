@@ -0,0 +1,73 @@
+{ Recursion with nested procedures:  Recursive functions and procedures
+  that access the variables of enclosing scopes. }
+
+PROGRAM Recursion;
+
+VAR
+  sum, i, f : INTEGER;
+
+PROCEDURE Fib(n : INTEGER; VAR result : INTEGER);
+VAR
+  f1, f2 : INTEGER;
+BEGIN
+  IF n < 2 THEN
+    result := n
+  ELSE
+  BEGIN
+    Fib(n - 1, f1);
+    Fib(n - 2, f2);
+    result := f1 + f2
+  END
+END;
+
+PROCEDURE Towers(disks : INTEGER);
+VAR
+  moves : INTEGER;
+
+  PROCEDURE Move(n, src, dest, spare : INTEGER);
+  BEGIN
+    IF n > 0 THEN
+    BEGIN
+      Move(n - 1, src, spare, dest);
+      moves := (moves + 1) MOD 10000;
+      Move(n - 1, spare, dest, src)
+    END
+  END;
+
+BEGIN
+  moves := 0;
+  Move(disks, 1, 3, 2);
+  WRITELN('Towers(', disks, '): ', moves, ' moves')
+END;
+
+PROCEDURE Outer(depth : INTEGER);
+VAR
+  total : INTEGER;
+
+  PROCEDURE Middle(n : INTEGER);
+
+    PROCEDURE Inner(k : INTEGER);
+    BEGIN
+      total := (total + k) MOD 10000;
+      IF k > 1 THEN Inner(k - 1)
+    END;
+
+  BEGIN
+    Inner(n);
+    IF n > 1 THEN Middle(n - 1)
+  END;
+
+BEGIN
+  total := 0;
+  Middle(depth);
+  sum := (sum + total) MOD 10000
+END;
+
+BEGIN
+  Fib(23, f);
+  WRITELN('Fib(23) = ', f);
+  Towers(18);
+  sum := 0;
+  FOR i := 1 TO 300 DO Outer(60);
+  WRITELN('Outer(60): ', sum)
+END.
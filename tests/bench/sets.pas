@@ -0,0 +1,39 @@
+{ Set operations:  Membership tests, union, intersection, difference, and
+  INCLUDE/EXCLUDE on sets of characters. }
+
+PROGRAM SetOps;
+
+TYPE
+  letters   = 'A' .. 'Z';
+  letterset = SET OF letters;
+
+VAR
+  vowels, seen, both, rest : letterset;
+  ch                        : letters;
+  i, j, count               : INTEGER;
+
+BEGIN
+  vowels := ['A', 'E', 'I', 'O', 'U'];
+  count  := 0;
+
+  FOR j := 1 TO 6000 DO
+  BEGIN
+    seen := [];
+    FOR i := 0 TO 99 DO
+    BEGIN
+      ch := CHR(ORD('A') + (i * 7 + j) MOD 26);
+      IF NOT (ch IN seen) THEN
+        seen := INCLUDE(seen, ch);
+      IF ch IN vowels THEN
+        count := count + 1
+    END;
+
+    both := seen * vowels;
+    rest := seen - vowels;
+    IF both + rest = seen THEN
+      count := count + CARD(both);
+    seen := EXCLUDE(seen, 'A')
+  END;
+
+  WRITELN('Count: ', count)
+END.
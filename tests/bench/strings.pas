@@ -0,0 +1,38 @@
+{ String operations:  Concatenation, search, substring extraction, and
+  comparison. }
+
+PROGRAM Strings;
+
+VAR
+  s, t, word : STRING;
+  i, j, found, total : INTEGER;
+
+BEGIN
+  total := 0;
+
+  FOR j := 1 TO 4000 DO
+  BEGIN
+    { Build a string by concatenation }
+
+    s := '';
+    FOR i := 1 TO 20 DO
+      s := s + 'ab' + CHR(ORD('a') + i MOD 26);
+
+    { Search and extract }
+
+    found := 0;
+    FOR i := 1 TO 20 DO
+    BEGIN
+      word := COPY(s, i * 3 - 2, 3);
+      IF POS(word, s) > 0 THEN
+        found := found + 1;
+      t := CONCAT(word, s);
+      IF t > s THEN
+        found := found + 1
+    END;
+
+    total := (total + found + LENGTH(s)) MOD 10000
+  END;
+
+  WRITELN('Total: ', total)
+END.
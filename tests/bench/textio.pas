@@ -0,0 +1,39 @@
+{ Text file I/O:  Write lines of strings and numbers to a text file and
+  read them back. }
+
+PROGRAM TextIO;
+
+VAR
+  f          : TEXT;
+  line       : STRING;
+  i, j, n, v : INTEGER;
+  sum        : INTEGER;
+
+BEGIN
+  sum := 0;
+  ASSIGN(f, 'textio.dat');
+
+  FOR j := 1 TO 100 DO
+  BEGIN
+    REWRITE(f);
+    FOR i := 1 TO 500 DO
+    BEGIN
+      WRITELN(f, 'Line number ', i);
+      WRITELN(f, i * 3, ' ', i MOD 17)
+    END;
+    CLOSE(f);
+
+    RESET(f);
+    n := 0;
+    WHILE NOT EOF(f) DO
+    BEGIN
+      READLN(f, line);
+      READLN(f, v);
+      n   := n + LENGTH(line);
+      sum := (sum + v) MOD 10000
+    END;
+    CLOSE(f)
+  END;
+
+  WRITELN('Chars: ', n, ' Sum: ', sum)
+END.
@@ -0,0 +1,68 @@
+PROGRAM Nesting;
+
+{ Access to variables in outer scopes from nested, recursive, and sibling
+  procedures }
+
+VAR
+  total : Integer;
+
+  PROCEDURE Outer(depth : Integer);
+  VAR
+    outerVar : Integer;
+
+    PROCEDURE AddOuter(n : Integer);
+    BEGIN
+      outerVar := outerVar + n;
+      total    := total + n
+    END;
+
+    PROCEDURE Middle(n : Integer);
+    VAR
+      middleVar : Integer;
+
+      PROCEDURE Inner(k : Integer);
+      BEGIN
+        middleVar := middleVar + k;
+
+        { Call a procedure declared two levels out }
+
+        AddOuter(k);
+
+        { Recurse at the innermost level }
+
+        IF k > 1 THEN
+          Inner(k - 1)
+      END;
+
+    BEGIN
+      middleVar := 0;
+      Inner(n);
+      WRITELN('Middle(', n, '): middleVar = ', middleVar);
+
+      { Recurse at the middle level }
+
+      IF n > 1 THEN
+        Middle(n - 1);
+
+      WRITELN('Middle(', n, ') after recursion: middleVar = ', middleVar)
+    END;
+
+  BEGIN
+    outerVar := 0;
+    Middle(3);
+    WRITELN('Outer(', depth, '): outerVar = ', outerVar);
+
+    { Recurse at the outer level.  The nested procedures must see the
+      variables of the newest activation. }
+
+    IF depth > 1 THEN
+      Outer(depth - 1);
+
+    WRITELN('Outer(', depth, ') after recursion: outerVar = ', outerVar)
+  END;
+
+BEGIN
+  total := 0;
+  Outer(2);
+  WRITELN('total = ', total)
+END.
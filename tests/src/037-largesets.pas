@@ -0,0 +1,62 @@
+PROGRAM largesets;
+TYPE
+  byteval  = 0 .. 255;
+  byteset  = SET OF byteval;
+  charset  = SET OF CHAR;
+  mid      = 0 .. 99;
+  midset   = SET OF mid;
+VAR
+  a, b, c : byteset;
+  letters, digits : charset;
+  m : midset;
+  ch : CHAR;
+  i, n : INTEGER;
+  t : byteset = [1, 3, 200..203];
+
+PROCEDURE show(s : byteset);
+VAR i : INTEGER;
+BEGIN
+  FOR i := 0 TO 255 DO
+    IF i IN s THEN WRITE(i, ' ');
+  WRITELN('card=', CARD(s))
+END;
+
+BEGIN
+  a := [0..9, 100, 250..255];
+  b := [5..130];
+  show(a);
+  show(a * b);
+  show(a - b);
+  WRITELN(CARD(a + b), ' ', CARD(a >< b));
+  show(t);
+  c := [];
+  IF c = [] THEN WRITELN('empty');
+  c := INCLUDE(c, 255);
+  c := INCLUDE(c, 0);
+  show(c);
+  c := EXCLUDE(c, 255);
+  show(c);
+  IF c <= a THEN WRITELN('subset');
+  IF a <> b THEN WRITELN('differ');
+  IF [] <> a THEN WRITELN('[] <> a');
+  IF [] <= a THEN WRITELN('[] <= a');
+  c := [] + b;
+  IF c = b THEN WRITELN('[] + b = b');
+  c := [] - a;
+  IF [] = c THEN WRITELN('[] - a = []');
+  show([] * a + [255]);
+  letters := ['a'..'z', 'A'..'Z', '_'];
+  digits  := ['0'..'9'];
+  n := 0;
+  FOR i := 0 TO 255 DO
+  BEGIN
+    ch := CHR(i);
+    IF ch IN letters THEN n := n + 1;
+    IF ch IN digits THEN n := n + 100
+  END;
+  WRITELN('n=', n, ' ', CARD(letters + digits));
+  m := [17, 63, 64, 99];
+  IF 64 IN m THEN WRITE('64 ');
+  IF 65 IN m THEN WRITE('65 ');
+  WRITELN('m=', CARD(m))
+END.
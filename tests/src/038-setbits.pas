@@ -0,0 +1,89 @@
+PROGRAM setbits;
+TYPE
+  small   = SET OF 0 .. 63;
+  teen    = 10 .. 40;
+  teenset = SET OF teen;
+  letters = SET OF 'a' .. 'z';
+VAR
+  s, v : small;
+  t : teenset;
+  l : letters;
+  c : SET OF CHAR;
+  ch : CHAR;
+  i, n : INTEGER;
+
+PROCEDURE mark(VAR m : small; j : INTEGER);
+BEGIN
+  INCLUDE(m, j);
+  INCLUDE(m, j + 1)
+END;
+
+PROCEDURE nested;
+VAR
+  u : teenset;
+  k : INTEGER;
+BEGIN
+  u := [];
+  FOR k := 10 TO 40 DO
+    IF k MOD 5 = 0 THEN INCLUDE(u, k);
+  EXCLUDE(u, 20);
+  u := EXCLUDE(u, 25);
+  FOR k := 10 TO 40 DO
+    IF k IN u THEN WRITE(k, ' ');
+  WRITELN
+END;
+
+BEGIN
+  s := [];
+  FOR i := 0 TO 63 DO
+    IF i MOD 3 = 0 THEN INCLUDE(s, i);
+  n := 0;
+  FOR i := 0 TO 63 DO
+    IF i IN s THEN n := n + 1;
+  WRITELN('multiples of 3: ', n, ' ', CARD(s));
+
+  EXCLUDE(s, 0);
+  s := INCLUDE(s, 1);
+  s := EXCLUDE(s, 3);
+  FOR i := 0 TO 10 DO
+    IF i IN s THEN WRITE(i, ' ');
+  WRITELN;
+
+  t := [11, 40];
+  INCLUDE(t, 10);
+  t := INCLUDE(t, 39);
+  FOR i := 10 TO 40 DO
+    IF i IN t THEN WRITE(i, ' ');
+  WRITELN;
+
+  l := [];
+  INCLUDE(l, 'q');
+  INCLUDE(l, 'a');
+  l := INCLUDE(l, 'z');
+  FOR i := ORD('a') TO ORD('z') DO
+    BEGIN
+      ch := CHR(i);
+      IF ch IN l THEN WRITE(ch)
+    END;
+  WRITELN;
+
+  c := [];
+  INCLUDE(c, 'A');
+  INCLUDE(c, CHR(255));
+  INCLUDE(c, CHR(0));
+  EXCLUDE(c, 'A');
+  n := 0;
+  FOR i := 0 TO 255 DO
+    IF CHR(i) IN c THEN n := n + 1;
+  WRITELN('chars: ', n, ' ', CARD(c));
+
+  v := [];
+  mark(v, 7);
+  mark(s, 62);
+  FOR i := 0 TO 63 DO
+    IF i IN v THEN WRITE(i, ' ');
+  WRITELN;
+  IF 63 IN s THEN WRITELN('63 in s');
+
+  nested
+END.
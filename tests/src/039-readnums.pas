@@ -0,0 +1,53 @@
+PROGRAM readnums(input, output);
+VAR
+  a, b, c, sum, count : INTEGER;
+  x, y : REAL;
+  s : STRING;
+BEGIN
+  { Several values on one line }
+
+  READ(a, b, c);
+  WRITE(a, ' ', b, ' ', c);
+  IF EOLN THEN WRITELN(' eoln') ELSE WRITELN(' more');
+  READLN;
+
+  { Values spread across lines, rest of the line left for READLN }
+
+  READ(a);
+  READ(b);
+  WRITE(a + b);
+  IF EOLN THEN WRITELN(' eoln') ELSE WRITELN(' more');
+  READLN(s);
+  WRITELN('rest:', s);
+
+  { Reals and integers mixed on one line }
+
+  READ(x, a, y);
+  WRITE(x:6:2, ' ', a, ' ', y:6:2);
+  IF EOLN THEN WRITELN(' eoln') ELSE WRITELN(' more');
+  READLN;
+
+  { Out of range values saturate }
+
+  READ(a, b, c);
+  WRITELN(a, ' ', b, ' ', c);
+  READLN;
+
+  { Values that are not numbers are skipped and read as zero }
+
+  READ(a, x, y, b);
+  WRITELN(a, ' ', x:4:1, ' ', y:4:1, ' ', b);
+  READLN;
+
+  { Sum until end of input }
+
+  sum := 0;
+  count := 0;
+  WHILE NOT EOF DO
+  BEGIN
+    READ(a);
+    sum := sum + a;
+    count := count + 1
+  END;
+  WRITELN(count, ' ', sum)
+END.
@@ -0,0 +1,54 @@
+PROGRAM writefmt;
+VAR
+  i : INTEGER;
+  w : WORD;
+  l : LONGINTEGER;
+  x : REAL;
+  s : STRING;
+  c : CHAR;
+BEGIN
+  { Integers with and without field widths }
+
+  i := -32767;
+  WRITELN('[', i, '] [', i:8, '] [', i:2, ']');
+  i := 0;
+  WRITELN('[', i, '] [', i:3, ']');
+  w := WORD(65535);
+  WRITELN('[', w, '] [', w:7, ']');
+  l := 123456789;
+  WRITELN('[', l, '] [', l:12, ']');
+  l := -l;
+  WRITELN('[', l, '] [', l:12, ']');
+
+  { Characters and strings are padded the same way }
+
+  c := 'z';
+  s := 'abc';
+  WRITELN('[', c:3, '] [', s:5, ']');
+
+  { Reals: default precision, explicit precision, rounding }
+
+  x := 3.14159265;
+  WRITELN('[', x, '] [', x:10, '] [', x:8:2, '] [', x:1:4, ']');
+  x := -0.125;
+  WRITELN('[', x:6:2, '] [', x:6:1, ']');
+  x := 2.5;
+  WRITELN('[', x:4:0, ']');
+  x := 0.0000005;
+  WRITELN('[', x:12:6, ']');
+  x := 123456789.0 * 1000000000.0;
+  WRITELN('[', x:25:2, ']');
+
+  { The same formatting in STR }
+
+  s := '';
+  STR(-1234:7, s);
+  WRITELN('[', s, ']');
+  s := '';
+  STR(x:25:3, s);
+  WRITELN('[', s, ']');
+  x := 1.0 / 3.0;
+  s := '';
+  STR(x:9:5, s);
+  WRITELN('[', s, ']')
+END.
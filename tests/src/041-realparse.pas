@@ -0,0 +1,35 @@
+PROGRAM realparse(input, output);
+CONST
+  big   = 6.02214076e23;
+  small = 1.602176634E-19;
+  third = 0.333333333333333333333333;
+VAR
+  x, y, z : REAL;
+  code : INTEGER;
+  s : STRING;
+BEGIN
+  { Constants from the tokenizer }
+
+  WRITE(big / 1e20:12:4, ' ', small * 1e19:10:8);
+  IF third * 3.0 = 1.0 THEN WRITELN(' exact') ELSE WRITELN(' inexact');
+
+  { READ with exponents and long mantissas }
+
+  READ(x, y, z);
+  WRITELN(x:10:1, ' ', y:14:2, ' ', z:12:9);
+  READLN;
+  READ(x);
+  WRITELN(x * 1e-10:12:6);
+  READ(x);
+  IF x = 0.1 THEN WRITE('0.1 ') ELSE WRITE('not 0.1 ');
+  IF x + 0.2 = 0.30000000000000004 THEN WRITELN('rounded') ELSE WRITELN('not rounded');
+
+  { VAL of reals }
+
+  s := '  2.5e2';
+  VAL(s, x, code);
+  WRITELN(x:8:2, ' ', code);
+  s := '1.25x';
+  VAL(s, x, code);
+  WRITELN(x:8:2, ' ', code)
+END.
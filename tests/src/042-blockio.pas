@@ -0,0 +1,91 @@
+PROGRAM BlockIo;
+TYPE
+  IntArray = ARRAY[1..100] OF INTEGER;
+  IntFile  = FILE OF INTEGER;
+
+VAR
+  f, f1, f2, f3, f4, f5, f6, f7, f8, f9 : IntFile;
+  a, b  : IntArray;
+  i, n  : INTEGER;
+  sum   : INTEGER;
+  total : INTEGER;
+
+PROCEDURE ReadAll(VAR buf : IntArray);
+VAR
+  got : INTEGER;
+BEGIN
+  RESET(f);
+  BLOCKREAD(f, buf, 100, got);
+  WRITELN('ReadAll got ', got);
+  CLOSE(f)
+END;
+
+PROCEDURE OpenOne(VAR g : IntFile; skip : INTEGER);
+VAR
+  skipped : IntArray;
+BEGIN
+  ASSIGN(g, 'blockio.dat');
+  RESET(g);
+  BLOCKREAD(g, skipped, skip)
+END;
+
+BEGIN
+  FOR i := 1 TO 100 DO
+    a[i] := i * 3;
+
+  { A file name longer than the old 40 character limit }
+
+  ASSIGN(f, './././././././././././././././././././././blockio.dat');
+  REWRITE(f);
+  BLOCKWRITE(f, a, 100, n);
+  WRITELN('Wrote ', n);
+  CLOSE(f);
+
+  { Read the file back in two pieces.  The second read comes up short. }
+
+  RESET(f);
+  BLOCKREAD(f, b, 60, n);
+  WRITELN('First read ', n);
+  sum := 0;
+  FOR i := 1 TO n DO
+    sum := sum + b[i];
+  BLOCKREAD(f, b, 60, n);
+  WRITELN('Second read ', n);
+  FOR i := 1 TO n DO
+    sum := sum + b[i];
+  WRITELN('Sum ', sum);
+  BLOCKREAD(f, b, 10);
+  CLOSE(f);
+
+  { Read through a VAR parameter }
+
+  FOR i := 1 TO 100 DO
+    b[i] := 0;
+  ReadAll(b);
+  IF b[100] = 300 THEN WRITELN('Last ', b[100]);
+
+  { More files open at once than the initial file table holds }
+
+  OpenOne(f1, 1);
+  OpenOne(f2, 2);
+  OpenOne(f3, 3);
+  OpenOne(f4, 4);
+  OpenOne(f5, 5);
+  OpenOne(f6, 6);
+  OpenOne(f7, 7);
+  OpenOne(f8, 8);
+  OpenOne(f9, 9);
+  total := 0;
+  READ(f1, n); total := total + n;
+  READ(f2, n); total := total + n;
+  READ(f3, n); total := total + n;
+  READ(f4, n); total := total + n;
+  READ(f5, n); total := total + n;
+  READ(f6, n); total := total + n;
+  READ(f7, n); total := total + n;
+  READ(f8, n); total := total + n;
+  READ(f9, n); total := total + n;
+  WRITELN('Total ', total);
+  CLOSE(f1); CLOSE(f2); CLOSE(f3); CLOSE(f4); CLOSE(f5);
+  CLOSE(f6); CLOSE(f7); CLOSE(f8); CLOSE(f9)
+END.
@@ -0,0 +1,84 @@
+PROGRAM MapFile;
+TYPE
+  Entry = RECORD
+    key   : INTEGER;
+    value : INTEGER
+  END;
+  EntryFile  = FILE OF Entry;
+  EntryArray = ARRAY[1..10] OF Entry;
+
+VAR
+  f     : EntryFile;
+  e     : Entry;
+  block : EntryArray;
+  i, n  : INTEGER;
+  where : LONGINTEGER;
+  size  : LONGINTEGER;
+
+BEGIN
+  { Write a table of 50 entries }
+
+  ASSIGN(f, 'mapfile.dat');
+  REWRITE(f);
+  FOR i := 0 TO 49 DO
+  BEGIN
+    e.key   := i;
+    e.value := i * 7;
+    WRITE(f, e)
+  END;
+  size := FILESIZE(f);
+  WRITELN('Size after writing ', size);
+
+  { Overwrite entry 2 in place }
+
+  SEEK(f, LONGINTEGER(8));
+  e.key   := 2;
+  e.value := 999;
+  WRITE(f, e);
+  where := FILEPOS(f);
+  WRITELN('Position after rewrite ', where);
+  CLOSE(f);
+
+  { Random lookups }
+
+  RESET(f);
+  size := FILESIZE(f);
+  WRITELN('Size on disk ', size);
+  SEEK(f, LONGINTEGER(37 * 4));
+  READ(f, e);
+  WRITELN('Entry ', e.key, ' = ', e.value);
+  SEEK(f, LONGINTEGER(2 * 4));
+  READ(f, e);
+  WRITELN('Entry ', e.key, ' = ', e.value);
+  SEEK(f, LONGINTEGER(11 * 4));
+  READ(f, e);
+  WRITELN('Entry ', e.key, ' = ', e.value);
+
+  { Block read of the last entries }
+
+  SEEK(f, LONGINTEGER(45 * 4));
+  BLOCKREAD(f, block, 10, n);
+  WRITELN('Block read ', n, ' entries ending with ', block[n].key);
+  IF EOF(f) THEN WRITELN('At EOF');
+  CLOSE(f);
+
+  { Append two more entries }
+
+  APPEND(f);
+  FOR i := 50 TO 51 DO
+  BEGIN
+    e.key   := i;
+    e.value := i * 7;
+    WRITE(f, e)
+  END;
+  CLOSE(f);
+
+  RESET(f);
+  size := FILESIZE(f);
+  WRITELN('Size after append ', size);
+  SEEK(f, LONGINTEGER(51 * 4));
+  READ(f, e);
+  WRITELN('Entry ', e.key, ' = ', e.value);
+  IF EOF(f) THEN WRITELN('At EOF');
+  CLOSE(f)
+END.
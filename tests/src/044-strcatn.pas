@@ -0,0 +1,42 @@
+PROGRAM strcatn;
+VAR
+  s, t : STRING;
+  c, d : CHAR;
+
+BEGIN
+  s := 'ab';
+  c := 'x';
+  d := 'y';
+
+  { Chains that start with a character }
+
+  t := c + s;
+  WRITELN(t);
+  t := c + d + s + c;
+  WRITELN(t);
+  t := 'z' + s + d;
+  WRITELN(t);
+
+  { Exactly 16 terms, then 17 and 20 terms.  The terms past the 16th are
+    concatenated in a second group, whose characters must also be found.
+  }
+
+  t := s + c + s + d + s + c + s + d + s + c + s + d + s + c + s + d;
+  WRITELN(t, ' ', LENGTH(t));
+  t := s + c + s + d + s + c + s + d + s + c + s + d + s + c + s + d + c;
+  WRITELN(t, ' ', LENGTH(t));
+  t := c + '1' + '2' + '3' + '4' + '5' + '6' + '7' + '8' + '9' + '0' +
+       s + d + s + c + s + d + '-' + s + c;
+  WRITELN(t, ' ', LENGTH(t));
+
+  { CONCAT with up to and beyond 16 arguments }
+
+  t := CONCAT(s, 'c');
+  WRITELN(t);
+  t := CONCAT(s, s, s, s, s, s, s, s, s, s, s, s, s, s, s, s);
+  WRITELN(t, ' ', LENGTH(t));
+  t := CONCAT('a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l',
+              'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x',
+              'y', 'z', s, '!');
+  WRITELN(t, ' ', LENGTH(t))
+END.
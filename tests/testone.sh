@@ -126,6 +126,15 @@ function test_program ()
   fi
 
   PRUNOPTS="-t ${STRSTKSZ} -n ${HEAPSIZE}"
+
+  # Any other prun options
+
+  if [ -f ${OPTFILENAME} ]; then
+    LINE=`grep "^P " ${OPTFILENAME}`
+    if [ ! -z "${LINE}" ]; then
+      PRUNOPTS="${PRUNOPTS} `echo ${LINE} | cut -d' ' -f2-`"
+    fi
+  fi
   echo "Using options:  ${PRUNOPTS}"
 
   if [ ! -f src/${PASBASENAME}.pex ]; then